@@ -0,0 +1,74 @@
+"""Compares two JSON result files of the benchmarks.
+
+Prints the ratio new / old of every metric for cases present in both files
+and exits with status 1 if any of them regressed beyond the threshold:
+
+    python benchmarks/compare.py baseline.json results.json
+"""
+
+import argparse
+import json
+import sys
+
+
+# metric: name of the threshold option it is checked against
+METRICS = {
+    "seconds": "time_threshold",
+    "bytes_per_element": "size_threshold",
+    "peak_rss_growth": "memory_threshold",
+    "p50_ns": "time_threshold",
+    "p99_ns": "time_threshold",
+}
+
+KEY_FIELDS = ("benchmark", "family", "class", "dataset", "operation",
+              "threads", "n")
+
+
+def keyed(document):
+    benchmark = document.get("benchmark")
+    result = {}
+    for record in document["results"]:
+        record = dict(record, benchmark=benchmark)
+        result[tuple(record.get(f) for f in KEY_FIELDS)] = record
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("old", type=argparse.FileType())
+    parser.add_argument("new", type=argparse.FileType())
+    parser.add_argument("--time-threshold", type=float, default=0.25,
+                        help="allowed relative slowdown (default 0.25)")
+    parser.add_argument("--size-threshold", type=float, default=0.01,
+                        help="allowed relative growth of size (default 0.01)")
+    parser.add_argument("--memory-threshold", type=float, default=0.10,
+                        help="allowed relative growth of peak memory "
+                             "(default 0.10)")
+    args = parser.parse_args()
+
+    old = keyed(json.load(args.old))
+    new = keyed(json.load(args.new))
+
+    regressions = 0
+    for key in sorted(set(old) & set(new), key=str):
+        name = " ".join(str(field) for field in key if field is not None)
+        for metric, threshold in METRICS.items():
+            before = old[key].get(metric)
+            after = new[key].get(metric)
+            if not before or after is None:
+                continue
+            ratio = after / before
+            regressed = ratio > 1 + getattr(args, threshold)
+            regressions += regressed
+            print("{:<70} {:<18} {:8.3f}{}".format(
+                name, metric, ratio, "  REGRESSION" if regressed else ""))
+
+    for key in sorted(set(old) ^ set(new), key=str):
+        print("only in {}: {}".format("old" if key in old else "new",
+                                      " ".join(str(f) for f in key if f)))
+
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
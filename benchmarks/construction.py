@@ -0,0 +1,160 @@
+"""Construction benchmark for every registered pysdsl class.
+
+For every class of a family and every synthetic dataset measures the
+construction time, the size in bytes per element, the growth of the peak
+RSS of the process and the peak of memory allocated by sdsl (through
+pysdsl.memory_monitor). Conversion of the dataset into the input vector is
+not measured. Results are written as JSON:
+
+    python benchmarks/construction.py --size 1000000 --out results.json
+    python benchmarks/compare.py baseline.json results.json
+"""
+
+import argparse
+import json
+import re
+import sys
+import traceback
+
+import numpy as np
+import pysdsl
+from pysdsl.bench import datagen, environment
+
+import measure
+
+
+FAMILIES = ("bitvectors", "encoded", "wavelet", "csa")
+
+
+def int_vector(values):
+    """Bit-compressed IntVector with the given values"""
+    raw = pysdsl.Int64Vector(len(values))
+    np.asarray(raw)[:] = values
+    v = pysdsl.IntVector(raw)
+    v.bit_compress()
+    return v
+
+
+def bit_vector(values):
+    raw = pysdsl.Int64Vector(len(values))
+    np.asarray(raw)[:] = values
+    return pysdsl.BitVector(raw)
+
+
+def byte_wavelet_trees():
+    """Wavelet tree classes over a byte alphabet"""
+    return set(cls for registry in (pysdsl.wavelet_tree_huffman,
+                                    pysdsl.wavelet_tree_hu_tucker,
+                                    pysdsl.wavelet_tree_balanced)
+               for cls in registry.values())
+
+
+def as_text(values):
+    """Byte values without zeros, as required for text inputs"""
+    return (values % 255 + 1).astype(np.uint8)
+
+
+def cases(family, dataset, n, seed):
+    """Yields (class, build) for every class of `family` where `build()`
+    constructs it from an input prepared for `dataset`"""
+    if family == "bitvectors":
+        bv = bit_vector(datagen.bits(dataset, n, seed=seed))
+        for cls in pysdsl.all_immutable_bitvectors:
+            yield cls, lambda cls=cls: cls(bv)
+        return
+
+    values = datagen.DATASETS[dataset](n, seed=seed)
+    if dataset in datagen.TEXT_DATASETS:
+        text = values.astype(np.uint8).tobytes()
+    else:
+        text = as_text(values).tobytes()
+
+    if family == "encoded":
+        iv = int_vector(values)
+        for cls in pysdsl.all_compressed_integer_vectors:
+            yield cls, lambda cls=cls: cls(iv)
+    elif family == "wavelet":
+        iv = int_vector(values)
+        byte_trees = byte_wavelet_trees()
+        for cls in pysdsl.all_wavelet_trees:
+            if cls in byte_trees:
+                yield cls, lambda cls=cls: cls.from_bytes(text)
+            else:
+                yield cls, lambda cls=cls: cls(iv)
+    elif family == "csa":
+        iv = int_vector(values + 1)
+        for name, cls in sorted(pysdsl.suffix_array.items()):
+            if name.endswith("Int"):
+                yield cls, lambda cls=cls: cls(iv)
+            else:
+                yield cls, lambda cls=cls: cls(text)
+    else:
+        raise ValueError("unknown family: " + family)
+
+
+def run(families, datasets, n, seed, repeat, class_filter):
+    results = []
+    for family in families:
+        for dataset in datasets:
+            for cls, build in cases(family, dataset, n, seed):
+                if class_filter and not class_filter.search(cls.__name__):
+                    continue
+                record = {"family": family, "class": cls.__name__,
+                          "dataset": dataset, "n": n}
+                try:
+                    runs = []
+                    for _ in range(repeat):
+                        result, stats = measure.measure(build)
+                        runs.append(stats)
+                        size = result.size_in_bytes
+                        del result
+                    best = min(runs, key=lambda stats: stats["seconds"])
+                    record.update(best)
+                    record["elements_per_second"] = n / best["seconds"]
+                    record["size_in_bytes"] = size
+                    record["bytes_per_element"] = size / n
+                except Exception as e:
+                    record["error"] = "".join(
+                        traceback.format_exception_only(type(e), e)).strip()
+                print("{family:<10} {class:<45} {dataset:<8} ".format(
+                    **record) + (
+                        "{seconds:8.3f} s {bytes_per_element:8.3f} B/elem "
+                        "{peak_rss_growth:>12} B peak".format(**record)
+                        if "error" not in record else record["error"]),
+                    file=sys.stderr)
+                results.append(record)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--size", type=int, default=10 ** 6,
+                        help="number of elements of every dataset")
+    parser.add_argument("--families", nargs="+", choices=FAMILIES,
+                        default=list(FAMILIES))
+    parser.add_argument("--datasets", nargs="+",
+                        choices=sorted(datagen.DATASETS),
+                        default=list(datagen.DATASETS))
+    parser.add_argument("--classes", type=re.compile, default=None,
+                        help="regular expression for class names to run")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="constructions per case, the fastest is kept")
+    parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--out", type=argparse.FileType("w"),
+                        default=sys.stdout, help="JSON output file")
+    args = parser.parse_args()
+
+    pysdsl.load_all()
+    results = run(args.families, args.datasets, args.size, args.seed,
+                  args.repeat, args.classes)
+    json.dump({"benchmark": "construction",
+               "environment": environment(),
+               "parameters": {"size": args.size, "seed": args.seed,
+                              "repeat": args.repeat},
+               "results": results},
+              args.out, indent=2)
+    args.out.write("\n")
+
+
+if __name__ == "__main__":
+    main()
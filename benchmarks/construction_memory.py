@@ -0,0 +1,98 @@
+"""Peak memory of building integer wavelet trees and CSAs from an IntVector.
+
+Compares the default constructors, which build straight from memory (CSAs:
+the text is written into the construction cache directly), with
+``Type.construct_im``, which goes through sdsl's RAM file system. The input is
+stored to a file once and every case loads it in a fresh interpreter, so
+``ru_maxrss`` only covers the input and that one construction.
+
+    python benchmarks/construction_memory.py --size 50000000 --width 16
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+from measure import peak_rss
+
+
+TYPES = ["WaveletTreeInt", "WaveletMatrixInt", "SuffixArraySadakaneInt",
+         "SuffixArrayWaveletTreeInt"]
+PATHS = ["direct", "construct_im"]
+
+
+def make_input(file_name, size, width):
+    """Stores `size` random nonzero `width`-bit values (CSA texts can not
+    hold 0) as a bit-compressed IntVector"""
+    import numpy as np
+    import pysdsl
+
+    rng = np.random.default_rng(42)
+    raw = pysdsl.Int64Vector(size)
+    np.asarray(raw)[:] = rng.integers(1, 1 << width, size=size,
+                                      dtype=np.int64)
+    v = pysdsl.IntVector(raw)
+    v.bit_compress()
+    v.store_to_file(file_name)
+
+
+def run_case(type_name, path, file_name):
+    import pysdsl
+
+    v = pysdsl.IntVector.load_from_file(file_name)
+
+    Type = getattr(pysdsl, type_name)
+    before = peak_rss()
+    if path == "direct":
+        wt = Type(v)
+    else:
+        wt = Type.construct_im(v)
+    after = peak_rss()
+
+    return {"type": type_name, "path": path, "size": len(v),
+            "width": v.width, "input_bytes": v.size_in_bytes,
+            "result_bytes": wt.size_in_bytes,
+            "peak_before": before, "peak_after": after,
+            "overhead_ratio": (after - before) / v.size_in_bytes}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--size", type=int, default=10 ** 7)
+    parser.add_argument("--width", type=int, default=16)
+    parser.add_argument("--json", action="store_true",
+                        help="print one JSON object per case")
+    parser.add_argument("--case", nargs=3,
+                        metavar=("TYPE", "PATH", "FILE"),
+                        help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.case:
+        print(json.dumps(run_case(*args.case)))
+        return
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        file_name = os.path.join(tmp_dir, "input.sdsl")
+        make_input(file_name, args.size, args.width)
+
+        for type_name in TYPES:
+            for path in PATHS:
+                out = subprocess.run(
+                    [sys.executable, __file__,
+                     "--case", type_name, path, file_name],
+                    check=True, stdout=subprocess.PIPE,
+                    universal_newlines=True)
+                result = json.loads(out.stdout)
+                if args.json:
+                    print(json.dumps(result))
+                else:
+                    print("{type:<26} {path:<13} input {input_bytes:>12} B  "
+                          "peak growth {overhead_ratio:5.2f}x input".format(
+                              **result))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+"""Timing and memory measurement shared by the benchmarks."""
+
+import resource
+import sys
+import time
+
+from pysdsl.memory_monitor import MemoryMonitor
+
+
+def _status_bytes(field):
+    """Value of a `kB` field of /proc/self/status in bytes, None if absent"""
+    try:
+        with open("/proc/self/status") as status:
+            for line in status:
+                if line.startswith(field + ":"):
+                    return int(line.split()[1]) * 1024
+    except OSError:
+        pass
+    return None
+
+
+def reset_peak_rss():
+    """Resets the peak RSS of this process where the OS allows it (Linux).
+    Returns False if the peak can not be reset and only grows."""
+    try:
+        with open("/proc/self/clear_refs", "w") as clear_refs:
+            clear_refs.write("5")
+        return True
+    except OSError:
+        return False
+
+
+def current_rss():
+    rss = _status_bytes("VmRSS")
+    return rss if rss is not None else peak_rss()
+
+
+def peak_rss():
+    """Peak resident set size of this process in bytes"""
+    hwm = _status_bytes("VmHWM")
+    if hwm is not None:
+        return hwm
+    usage = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return usage if sys.platform == "darwin" else usage * 1024
+
+
+def sdsl_peak(report):
+    """Largest memory usage recorded in a parsed sdsl memory log"""
+    if isinstance(report, dict):
+        usage = report.get("usage", [])
+        peak = max((point[1] for point in usage), default=0)
+        return max([peak] + [sdsl_peak(v) for k, v in report.items()
+                             if k != "usage"])
+    if isinstance(report, list):
+        return max((sdsl_peak(item) for item in report), default=0)
+    return 0
+
+
+def measure(build):
+    """Calls `build()` and returns (result, stats) where stats has the wall
+    time, the growth of peak RSS over RSS before the call and the peak of
+    memory allocated by sdsl during the call"""
+    exact_peak = reset_peak_rss()
+    rss_before = current_rss()
+    peak_before = peak_rss()
+
+    with MemoryMonitor() as monitor:
+        start = time.perf_counter()
+        result = build()
+        seconds = time.perf_counter() - start
+
+    peak_after = peak_rss()
+    if exact_peak:
+        growth = peak_after - rss_before
+    else:
+        growth = max(0, peak_after - peak_before)
+    return result, {
+        "seconds": seconds,
+        "peak_rss_growth": growth,
+        "peak_rss_exact": exact_peak,
+        "sdsl_peak_bytes": sdsl_peak(monitor.report),
+    }
@@ -0,0 +1,379 @@
+// Native counterpart of `python -m pysdsl.bench`: the same operations
+// (operations/queries.hpp) on the same kinds of data, without Python.
+//
+// Every benchmark takes the query distribution as argument (0: uniform,
+// 1: Zipf-skewed with exponent 1.2 and hot positions scattered over the
+// whole range) and runs on 1..N threads.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <sdsl/bit_vectors.hpp>
+#include <sdsl/suffix_arrays.hpp>
+#include <sdsl/vectors.hpp>
+#include <sdsl/wavelet_trees.hpp>
+
+#include "operations/queries.hpp"
+#include "util/bits_kernels.hpp"
+
+
+namespace
+{
+    constexpr uint64_t size = 1 << 20;
+    constexpr uint64_t query_count = 1 << 16;
+    constexpr uint64_t window = 1024;
+    constexpr uint64_t pattern_length = 8;
+    constexpr uint64_t extract_length = 64;
+
+
+    std::vector<uint64_t> positions(uint64_t limit, int64_t distribution,
+                                    uint64_t seed,
+                                    uint64_t count = query_count)
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> result(count);
+        if (distribution == 0) {
+            std::uniform_int_distribution<uint64_t> uniform(0, limit - 1);
+            for (auto& p: result) p = uniform(rng);
+            return result;
+        }
+
+        std::vector<double> weights(std::min<uint64_t>(limit, 1 << 20));
+        for (size_t k = 0; k < weights.size(); k++) {
+            weights[k] = std::pow(k + 1.0, -1.2); }
+        std::discrete_distribution<uint64_t> zipf(weights.begin(),
+                                                  weights.end());
+        for (auto& p: result) {
+            p = ((zipf(rng) + 1) * 0x9E3779B97F4A7C15ull) % limit; }
+        return result;
+    }
+
+
+    std::vector<uint64_t> uniform_values(uint64_t sigma)
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<uint64_t> uniform(0, sigma - 1);
+        std::vector<uint64_t> values(size);
+        for (auto& v: values) v = uniform(rng);
+        return values;
+    }
+
+
+    const sdsl::int_vector<>& int_vector()
+    {
+        static const sdsl::int_vector<> result = [] {
+            const auto values = uniform_values(1 << 16);
+            sdsl::int_vector<> v(values.size());
+            std::copy(values.begin(), values.end(), v.begin());
+            sdsl::util::bit_compress(v);
+            return v; }();
+        return result;
+    }
+
+
+    const sdsl::bit_vector& bit_vector()
+    {
+        static const sdsl::bit_vector result = [] {
+            const auto values = uniform_values(2);
+            sdsl::bit_vector v(values.size());
+            std::copy(values.begin(), values.end(), v.begin());
+            return v; }();
+        return result;
+    }
+
+
+    // Skewed symbols as in pysdsl.bench: Zipf over an alphabet of 256
+    const sdsl::int_vector<>& symbols()
+    {
+        static const sdsl::int_vector<> result = [] {
+            const auto values = positions(256, 1, 7, size);
+            sdsl::int_vector<> v(size, 0, 8);
+            std::copy(values.begin(), values.end(), v.begin());
+            return v; }();
+        return result;
+    }
+
+
+    const std::string& text()
+    {
+        static const std::string result = [] {
+            static const char* words[] = {
+                "the", "of", "and", "to", "a", "in", "is", "you", "that",
+                "it", "he", "was", "for", "on", "are", "as", "with", "his",
+                "they", "at", "be", "this", "have", "from", "or", "one"};
+            const auto ranks = positions(sizeof(words) / sizeof(*words),
+                                         1, 11, size / 2);
+            std::string t;
+            for (uint64_t i = 0; t.size() < size; i++) {
+                t += words[ranks[i]];
+                t += ' '; }
+            t.resize(size);
+            return t; }();
+        return result;
+    }
+
+
+    template <class T>
+    const T& built()
+    {
+        static const T result = [] {
+            T t(int_vector());
+            return t; }();
+        return result;
+    }
+
+
+    template <class T>
+    const T& wavelet()
+    {
+        static const T result = [] {
+            T wt;
+            sdsl::construct_im(wt, symbols());
+            return wt; }();
+        return result;
+    }
+
+
+    template <class T>
+    const T& csa()
+    {
+        static const T result = [] {
+            T t;
+            sdsl::construct_im(t, text(), 1);
+            return t; }();
+        return result;
+    }
+
+
+    template <class T, class Op, class... Queries>
+    void run(benchmark::State& state, const T& obj, Op op,
+             const Queries&... queries)
+    {
+        uint64_t checksum = 0;
+        size_t i = state.thread_index() * 7919;
+        for (auto _ : state) {
+            i = (i + 1) & (query_count - 1);
+            checksum += op(obj, queries[i]...);
+        }
+        benchmark::DoNotOptimize(checksum);
+        state.SetItemsProcessed(state.iterations());
+    }
+}  // namespace
+
+
+// Queries are generated once per distribution (benchmark argument) and
+// shared by all threads
+template <class F>
+auto per_distribution(F make) -> std::vector<decltype(make(0))>
+{
+    return {make(0), make(1)};
+}
+
+
+template <class T>
+void BM_access(benchmark::State& state)
+{
+    static const auto idx = per_distribution([] (int64_t d) {
+        return positions(size, d, 1); });
+    run(state, built<T>(), queries::access(), idx[state.range(0)]);
+}
+
+
+template <class S>
+void BM_bit_vector_support(benchmark::State& state)
+{
+    static const S support(&bit_vector());
+    static const auto idx = per_distribution([] (int64_t d) {
+        return positions(size, d, 2); });
+    run(state, support, queries::support_call(), idx[state.range(0)]);
+}
+
+
+void BM_bit_vector_select(benchmark::State& state)
+{
+    static const sdsl::select_support_mcl<1, 1> support(&bit_vector());
+    static const auto ks = per_distribution([] (int64_t d) {
+        const auto ones = sdsl::rank_support_v5<1, 1>(&bit_vector())(size);
+        auto result = positions(ones, d, 3);
+        for (auto& k: result) k++;
+        return result; });
+    run(state, support, queries::support_call(), ks[state.range(0)]);
+}
+
+
+// Select on the compressed bit vectors, through their select_1_type
+template <class T>
+void BM_compressed_select(benchmark::State& state)
+{
+    static const T v(bit_vector());
+    static const typename T::select_1_type support(&v);
+    static const auto ks = per_distribution([] (int64_t d) {
+        const auto ones = sdsl::rank_support_v5<1, 1>(&bit_vector())(size);
+        auto result = positions(ones, d, 3);
+        for (auto& k: result) k++;
+        return result; });
+    run(state, support, queries::support_call(), ks[state.range(0)]);
+}
+
+
+// In-word select of sdsl and of the kernel pysdsl dispatches to
+// (argument 0: sdsl::bits::sel, 1: bits_kernels::select)
+void BM_word_select(benchmark::State& state)
+{
+    static const auto words = [] {
+        auto result = uniform_values(uint64_t(-1));
+        for (auto& w: result) w |= 1;
+        return result; }();
+    static const auto ks = [] {
+        auto result = positions(64, 0, 10);
+        for (size_t i = 0; i < query_count; i++) {
+            result[i] = 1 + result[i] % sdsl::bits::cnt(words[i]); }
+        return result; }();
+    const bool dispatched = state.range(0);
+    uint64_t checksum = 0;
+    size_t i = state.thread_index() * 7919;
+    for (auto _ : state) {
+        i = (i + 1) & (query_count - 1);
+        checksum += dispatched ? bits_kernels::select(words[i], ks[i]) :
+                                 sdsl::bits::sel(words[i], ks[i]);
+    }
+    benchmark::DoNotOptimize(checksum);
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(dispatched ? bits_kernels::sel_word().name : "sdsl");
+}
+
+
+template <class T>
+void BM_wavelet_access(benchmark::State& state)
+{
+    static const auto idx = per_distribution([] (int64_t d) {
+        return positions(size, d, 4); });
+    run(state, wavelet<T>(), queries::access(), idx[state.range(0)]);
+}
+
+
+// Symbols of random positions, so every queried symbol occurs
+std::vector<uint64_t> occurring_symbols(int64_t distribution)
+{
+    std::vector<uint64_t> result;
+    for (auto p: positions(size, distribution, 5)) {
+        result.push_back(symbols()[p]); }
+    return result;
+}
+
+
+template <class T>
+void BM_wavelet_rank(benchmark::State& state)
+{
+    static const auto idx = per_distribution([] (int64_t d) {
+        return positions(size, d, 4); });
+    static const auto cs = per_distribution(occurring_symbols);
+    run(state, wavelet<T>(), queries::wt_rank(), idx[state.range(0)],
+        cs[state.range(0)]);
+}
+
+
+template <class T>
+void BM_wavelet_select(benchmark::State& state)
+{
+    // k-th occurrence of the symbol at a random position p, k = rank(p + 1)
+    static const auto ks = per_distribution([] (int64_t d) {
+        const T& wt = wavelet<T>();
+        std::vector<uint64_t> result;
+        for (auto p: positions(size, d, 5)) {
+            result.push_back(wt.rank(p + 1, symbols()[p])); }
+        return result; });
+    static const auto cs = per_distribution(occurring_symbols);
+    run(state, wavelet<T>(), queries::wt_select(), ks[state.range(0)],
+        cs[state.range(0)]);
+}
+
+
+void BM_quantile_freq(benchmark::State& state)
+{
+    static const auto lbs = per_distribution([] (int64_t d) {
+        return positions(size - window + 1, d, 6); });
+    static const auto rbs = per_distribution([] (int64_t d) {
+        auto result = lbs[d];
+        for (auto& r: result) r += window - 1;
+        return result; });
+    static const auto qs = positions(window, 0, 7);
+    run(state, wavelet<sdsl::wt_int<>>(), queries::quantile_freq(),
+        lbs[state.range(0)], rbs[state.range(0)], qs);
+}
+
+
+std::vector<std::string> patterns(int64_t distribution)
+{
+    std::vector<std::string> result;
+    for (auto s: positions(size - pattern_length, distribution, 8)) {
+        result.push_back(text().substr(s, pattern_length)); }
+    return result;
+}
+
+
+template <class T>
+void BM_csa_count(benchmark::State& state)
+{
+    static const auto ps = per_distribution(patterns);
+    run(state, csa<T>(), queries::csa_count(), ps[state.range(0)]);
+}
+
+
+template <class T>
+void BM_csa_locate(benchmark::State& state)
+{
+    static const auto ps = per_distribution(patterns);
+    run(state, csa<T>(), queries::csa_locate(), ps[state.range(0)]);
+}
+
+
+template <class T>
+void BM_csa_extract(benchmark::State& state)
+{
+    static const auto begins = per_distribution([] (int64_t d) {
+        return positions(size - extract_length - 1, d, 9); });
+    static const auto ends = per_distribution([] (int64_t d) {
+        auto result = begins[d];
+        for (auto& e: result) e += extract_length;
+        return result; });
+    run(state, csa<T>(), queries::csa_extract(), begins[state.range(0)],
+        ends[state.range(0)]);
+}
+
+
+#define QUERY_BENCHMARK(...) \
+    BENCHMARK(__VA_ARGS__)->Arg(0)->Arg(1) \
+        ->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))
+
+QUERY_BENCHMARK(BM_access<sdsl::int_vector<>>);
+QUERY_BENCHMARK(BM_access<sdsl::enc_vector<>>);
+QUERY_BENCHMARK(BM_access<sdsl::dac_vector<>>);
+QUERY_BENCHMARK(BM_bit_vector_support<sdsl::rank_support_v<1, 1>>);
+QUERY_BENCHMARK(BM_bit_vector_support<sdsl::rank_support_v5<1, 1>>);
+QUERY_BENCHMARK(BM_bit_vector_select);
+QUERY_BENCHMARK(BM_compressed_select<sdsl::rrr_vector<63>>);
+QUERY_BENCHMARK(BM_compressed_select<sdsl::sd_vector<>>);
+QUERY_BENCHMARK(BM_word_select);
+QUERY_BENCHMARK(BM_wavelet_access<sdsl::wt_int<>>);
+QUERY_BENCHMARK(BM_wavelet_access<sdsl::wm_int<>>);
+QUERY_BENCHMARK(BM_wavelet_rank<sdsl::wt_int<>>);
+QUERY_BENCHMARK(BM_wavelet_rank<sdsl::wm_int<>>);
+QUERY_BENCHMARK(BM_wavelet_select<sdsl::wt_int<>>);
+QUERY_BENCHMARK(BM_wavelet_select<sdsl::wm_int<>>);
+QUERY_BENCHMARK(BM_quantile_freq);
+QUERY_BENCHMARK(BM_csa_count<sdsl::csa_wt<>>);
+QUERY_BENCHMARK(BM_csa_count<sdsl::csa_sada<>>);
+QUERY_BENCHMARK(BM_csa_locate<sdsl::csa_wt<>>);
+QUERY_BENCHMARK(BM_csa_locate<sdsl::csa_sada<>>);
+QUERY_BENCHMARK(BM_csa_extract<sdsl::csa_wt<>>);
+QUERY_BENCHMARK(BM_csa_extract<sdsl::csa_sada<>>);
+
+BENCHMARK_MAIN();
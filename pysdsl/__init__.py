@@ -1 +1,109 @@
-from pysdsl import *
+"""sdsl-lite bindings for python
+
+The bindings are split into one extension module per family of structures.
+A family is imported on first access to any of its names, e.g.
+``pysdsl.WaveletTreeInt`` loads ``pysdsl._wavelet`` (and the families it
+builds on) while ``pysdsl.IntVector`` only loads ``pysdsl._vectors``.
+``from pysdsl import *`` loads every family.
+"""
+
+import importlib
+import importlib.util
+import re
+import sys
+import types
+
+
+# Checked in order: a name belongs to the first family whose pattern is
+# found in it, names matching none of them belong to _vectors
+_FAMILY_PATTERNS = (
+    ("_archive", re.compile(r"ArchivedIntVector|store_to_archive")),
+    ("_csa", re.compile(r"SuffixArray|suffix_array")),
+    ("_wavelet", re.compile(r"Wavelet|wavelet_")),
+    ("_trees", re.compile(r"BPTree|LoudsTree|K2Tree|succinct_trees|k2_trees")),
+    ("_encoded", re.compile(
+        r"EncVector|enc_vector|VariableLengthCodes|variable_length_codes|"
+        r"DirectAccessibleCodes|direct_accessible_codes|DACVector|"
+        r"all_compressed_integer_vectors")),
+    ("_bitvectors", re.compile(
+        r"BitVectorInterLeaved|bit_vector_interleaved|RamanRamanRao|"
+        r"raman_raman_rao|SDVector|sparse_bit_vectors|HybVector|"
+        r"hybrid_bit_vectors|all_immutable_bitvectors|DynamicBitVector")),
+)
+
+FAMILIES = ("_vectors",) + tuple(family for family, _ in _FAMILY_PATTERNS)
+
+# Families built only when their libraries are found (zstd and lz4)
+OPTIONAL_FAMILIES = ("_archive",)
+
+
+def family_of(name):
+    """Name of the extension module which defines `name`"""
+    for family, pattern in _FAMILY_PATTERNS:
+        if pattern.search(name):
+            return family
+    return "_vectors"
+
+
+def load(family):
+    """Imports the extension module of `family` (one of FAMILIES)"""
+    return importlib.import_module("." + family, __name__)
+
+
+def load_all():
+    """Imports every family and binds all of their names in this module,
+    skipping optional families which were not built"""
+    for family in FAMILIES:
+        try:
+            module = load(family)
+        except ImportError:
+            if family in OPTIONAL_FAMILIES:
+                continue
+            raise
+        for name, value in vars(module).items():
+            if not name.startswith("__"):
+                globals().setdefault(name, value)
+
+
+def _public_names():
+    """Names exported by `from pysdsl import *`, once every family is
+    loaded"""
+    load_all()
+    return sorted(name for name, value in globals().items()
+                  if not name.startswith("_")
+                  and not isinstance(value, types.ModuleType))
+
+
+def __getattr__(name):
+    if name == "__all__":
+        globals()[name] = _public_names()
+        return globals()[name]
+    if name.startswith("__"):
+        raise AttributeError(name)
+    # submodules such as pysdsl.stats, without loading any family
+    if importlib.util.find_spec(__name__ + "." + name) is not None:
+        return importlib.import_module("." + name, __name__)
+    try:
+        value = getattr(load(family_of(name)), name)
+    except AttributeError:
+        raise AttributeError("module {!r} has no attribute {!r}".format(
+            __name__, name)) from None
+    globals()[name] = value
+    return value
+
+
+def __dir__():
+    names = set(globals())
+    for family in FAMILIES:
+        module = sys.modules.get(__name__ + "." + family)
+        if module is not None:
+            names.update(n for n in vars(module) if not n.startswith("__"))
+    return sorted(names)
+
+
+from .bundle import load_bundle, store_bundle  # noqa: E402
+
+
+# Module level __getattr__ needs Python 3.7
+if sys.version_info < (3, 7):
+    load_all()
@@ -0,0 +1,32 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <sdsl/vectors.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "operations/creation.hpp"
+#include "types/archive.hpp"
+#include "types/intvector.hpp"
+#include "util/locking.hpp"
+#include "util/registered.hpp"
+
+namespace py = pybind11;
+
+
+PYBIND11_MODULE(_archive, m)
+{
+    m.doc() = "sdsl-lite bindings for python: block-compressed int vector "
+              "archives (zstd, lz4)";
+    locking::gil_not_used(m);
+
+    py::module::import("pysdsl._vectors");
+    auto iv_classes = registered_classes<int_vector_classes>();
+
+    add_archived_int_vector(m);
+    for_each_in_tuple(iv_classes, add_store_to_archive_functor(m));
+}
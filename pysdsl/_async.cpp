@@ -0,0 +1,252 @@
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include <pybind11/pybind11.h>
+
+#include "util/aio.hpp"
+#include "util/locking.hpp"
+#include "util/parallel.hpp"
+
+namespace py = pybind11;
+
+
+namespace
+{
+    // A submitted job and the asyncio future it resolves
+    struct entry
+    {
+        std::shared_ptr<aio::job> job;
+        py::object future;
+    };
+
+
+    // Finished jobs of one event loop. Workers append to it and signal its
+    // file descriptor only when it was empty, so a burst of completions
+    // wakes the loop up once and is drained in one callback.
+    class completion_queue
+    {
+    private:
+        std::mutex m_mutex;
+        std::vector<entry> m_done;
+        bool m_closed = false;
+        int m_read_fd = -1;
+        int m_write_fd = -1;
+
+        static void check(int result)
+        {
+            if (result < 0) {
+                throw std::system_error(errno, std::generic_category()); }
+        }
+
+        void signal()
+        {
+#ifdef __linux__
+            const uint64_t one = 1;
+#else
+            const char one = 1;
+#endif
+            // a full pipe or counter already wakes the loop up
+            (void) !::write(m_write_fd, &one, sizeof(one));
+        }
+
+        void clear_signal()
+        {
+            uint64_t buffer[64];
+            while (::read(m_read_fd, buffer, sizeof(buffer)) > 0) {}
+        }
+    public:
+        completion_queue()
+        {
+#ifdef __linux__
+            check(m_read_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+            m_write_fd = m_read_fd;
+#else
+            int fds[2];
+            check(::pipe(fds));
+            m_read_fd = fds[0];
+            m_write_fd = fds[1];
+            for (int fd: fds) {
+                check(::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK));
+                check(::fcntl(fd, F_SETFD, FD_CLOEXEC)); }
+#endif
+        }
+
+        ~completion_queue()
+        {
+            ::close(m_read_fd);
+            if (m_write_fd != m_read_fd) ::close(m_write_fd);
+        }
+
+        int fileno() const { return m_read_fd; }
+
+        // On a worker, without the GIL
+        void complete(entry&& done)
+        {
+            bool was_empty;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_closed) {
+                    // leaked: releasing its Python objects needs the GIL
+                    new entry(std::move(done));
+                    return; }
+                was_empty = m_done.empty();
+                m_done.push_back(std::move(done));
+            }
+            if (was_empty) signal();
+        }
+
+        // On the event loop thread. The signal is cleared before taking
+        // the entries, so an entry added meanwhile signals again.
+        std::vector<entry> drain()
+        {
+            clear_signal();
+            std::vector<entry> result;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            result.swap(m_done);
+            return result;
+        }
+
+        // With the GIL held: drops finished jobs, later ones are leaked
+        void close()
+        {
+            std::vector<entry> done;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            done.swap(m_done);
+        }
+    };
+
+
+    struct task
+    {
+        entry work;
+        std::shared_ptr<completion_queue> queue;
+    };
+
+
+    // Fixed pool of one worker per hardware thread, started on first use
+    // and never stopped
+    class worker_pool
+    {
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        std::deque<task> m_tasks;
+        const size_t m_workers = detail::resolve_threads(0);
+        bool m_started = false;
+
+        void work()
+        {
+            for (;;) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_ready.wait(lock, [this] { return !m_tasks.empty(); });
+                task t = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                lock.unlock();
+
+                t.work.job->execute();
+                t.queue->complete(std::move(t.work));
+            }
+        }
+    public:
+        size_t workers() const { return m_workers; }
+
+        void submit(task&& t)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_started) {
+                    m_started = true;
+                    for (size_t i = 0; i < m_workers; i++) {
+                        std::thread([this] { work(); }).detach(); } }
+                m_tasks.push_back(std::move(t));
+            }
+            m_ready.notify_one();
+        }
+    };
+
+    worker_pool& pool()
+    {
+        // never destroyed: workers outlive the interpreter
+        static worker_pool* instance = new worker_pool();
+        return *instance;
+    }
+
+
+    std::shared_ptr<aio::job> job_of(const py::capsule& capsule)
+    {
+        return *static_cast<std::shared_ptr<aio::job>*>(capsule);
+    }
+
+
+    // Python side of a completion_queue, which workers may outlive
+    class loop_queue
+    {
+    private:
+        std::shared_ptr<completion_queue> m_queue;
+    public:
+        loop_queue(): m_queue(std::make_shared<completion_queue>()) {}
+        ~loop_queue() { m_queue->close(); }
+
+        int fileno() const { return m_queue->fileno(); }
+
+        void submit(const py::capsule& job, py::object future)
+        {
+            task t{{job_of(job), std::move(future)}, m_queue};
+            py::gil_scoped_release release;
+            pool().submit(std::move(t));
+        }
+
+        py::list drain()
+        {
+            std::vector<entry> done;
+            {
+                py::gil_scoped_release release;
+                done = m_queue->drain();
+            }
+            py::list result;
+            for (auto& e: done) {
+                auto* holder = new std::shared_ptr<aio::job>(std::move(e.job));
+                result.append(py::make_tuple(
+                    std::move(e.future),
+                    py::capsule(holder, +[] (void* p) {
+                        delete static_cast<std::shared_ptr<aio::job>*>(p);
+                    })));
+            }
+            return result;
+        }
+    };
+}  // namespace
+
+
+PYBIND11_MODULE(_async, m)
+{
+    m.doc() = "Internals of pysdsl.aio";
+    locking::gil_not_used(m);
+
+    py::class_<loop_queue>(m, "CompletionQueue")
+        .def(py::init<>())
+        .def("fileno", &loop_queue::fileno)
+        .def("submit", &loop_queue::submit, py::arg("job"), py::arg("future"))
+        .def("drain", &loop_queue::drain,
+             "Takes the finished jobs as a list of (future, job)");
+
+    m.def("result", [] (const py::capsule& job) {
+        return job_of(job)->finish(); });
+    m.def("workers", [] () { return pool().workers(); });
+}
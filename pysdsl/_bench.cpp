@@ -0,0 +1,151 @@
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <sdsl/bit_vectors.hpp>
+#include <sdsl/suffix_arrays.hpp>
+#include <sdsl/vectors.hpp>
+#include <sdsl/wavelet_trees.hpp>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "operations/batch.hpp"
+#include "operations/queries.hpp"
+#include "supports.hpp"
+#include "util/locking.hpp"
+
+namespace py = pybind11;
+
+
+namespace
+{
+    auto to_pair(const queries::loop_result& result) {
+        return std::make_pair(result.nanoseconds, result.checksum); }
+
+    template <class... Arrays>
+    size_t common_length(const Arrays&... arrays)
+    {
+        const size_t lengths[] = {(detail::check_1d(arrays, "queries"),
+                                   static_cast<size_t>(arrays.shape(0)))...};
+        for (size_t length: lengths) {
+            if (length != lengths[0]) {
+                throw std::invalid_argument(
+                    "query arrays should have equal length"); }
+        }
+        return lengths[0];
+    }
+
+    // Binds `name(obj, *query_arrays)` for every T in Ts
+    template <class Op, size_t Arity, class... Ts>
+    struct native_loop;
+
+    template <class Op, class... Ts>
+    struct native_loop<Op, 1, Ts...>
+    {
+        static void bind(py::module& m, const char* name)
+        {
+            (void)std::initializer_list<int>{(m.def(
+                name,
+                [] (const Ts& obj, const input_array<>& a) {
+                    const size_t n = common_length(a);
+                    py::gil_scoped_release release;
+                    return to_pair(queries::run(obj, Op(), n, a.data())); },
+                py::arg("obj"), py::arg("a")), 0)...};
+        }
+    };
+
+    template <class Op, class... Ts>
+    struct native_loop<Op, 2, Ts...>
+    {
+        static void bind(py::module& m, const char* name)
+        {
+            (void)std::initializer_list<int>{(m.def(
+                name,
+                [] (const Ts& obj, const input_array<>& a,
+                    const input_array<>& b) {
+                    const size_t n = common_length(a, b);
+                    py::gil_scoped_release release;
+                    return to_pair(queries::run(obj, Op(), n, a.data(),
+                                                b.data())); },
+                py::arg("obj"), py::arg("a"), py::arg("b")), 0)...};
+        }
+    };
+
+    template <class Op, class... Ts>
+    struct native_loop<Op, 3, Ts...>
+    {
+        static void bind(py::module& m, const char* name)
+        {
+            (void)std::initializer_list<int>{(m.def(
+                name,
+                [] (const Ts& obj, const input_array<>& a,
+                    const input_array<>& b, const input_array<>& c) {
+                    const size_t n = common_length(a, b, c);
+                    py::gil_scoped_release release;
+                    return to_pair(queries::run(obj, Op(), n, a.data(),
+                                                b.data(), c.data())); },
+                py::arg("obj"), py::arg("a"), py::arg("b"), py::arg("c")),
+                0)...};
+        }
+    };
+
+    template <class Op, class... Ts>
+    struct pattern_loop
+    {
+        static void bind(py::module& m, const char* name)
+        {
+            (void)std::initializer_list<int>{(m.def(
+                name,
+                [] (const Ts& obj, const std::vector<std::string>& patterns) {
+                    return to_pair(queries::run(obj, Op(), patterns.size(),
+                                                patterns.data())); },
+                py::arg("obj"), py::arg("patterns"),
+                py::call_guard<py::gil_scoped_release>()), 0)...};
+        }
+    };
+}  // namespace
+
+
+PYBIND11_MODULE(_bench, m)
+{
+    m.doc() = "Native query loops used by pysdsl.bench to measure the cost "
+              "of Python dispatch. Every function runs one operation for "
+              "all queries without bounds checks and returns "
+              "(nanoseconds, checksum).";
+    locking::gil_not_used(m);
+
+    py::module::import("pysdsl._vectors");
+    py::module::import("pysdsl._bitvectors");
+    py::module::import("pysdsl._encoded");
+    py::module::import("pysdsl._wavelet");
+    py::module::import("pysdsl._csa");
+
+    native_loop<queries::access, 1,
+                sdsl::int_vector<>, sdsl::bit_vector,
+                sdsl::enc_vector<>, sdsl::dac_vector<>,
+                sdsl::rrr_vector<63>, sdsl::sd_vector<>,
+                sdsl::wt_int<>, sdsl::wm_int<>>::bind(m, "access");
+    native_loop<queries::support_call, 1,
+                sdsl::rank_support_v<1, 1>, sdsl::rank_support_v5<1, 1>,
+                support_helper<sdsl::select_support_mcl<1, 1>>>::bind(
+        m, "support_call");
+    native_loop<queries::wt_rank, 2,
+                sdsl::wt_int<>, sdsl::wm_int<>>::bind(m, "wt_rank");
+    native_loop<queries::wt_select, 2,
+                sdsl::wt_int<>, sdsl::wm_int<>>::bind(m, "wt_select");
+    native_loop<queries::quantile_freq, 3,
+                sdsl::wt_int<>>::bind(m, "quantile_freq");
+    pattern_loop<queries::csa_count,
+                 sdsl::csa_wt<>, sdsl::csa_sada<>>::bind(m, "csa_count");
+    pattern_loop<queries::csa_locate,
+                 sdsl::csa_wt<>, sdsl::csa_sada<>>::bind(m, "csa_locate");
+    native_loop<queries::csa_extract, 2,
+                sdsl::csa_wt<>, sdsl::csa_sada<>>::bind(m, "csa_extract");
+}
@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <sdsl/vectors.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "operations/creation.hpp"
+#include "types/bitvector.hpp"
+#include "types/dynamic_bitvector.hpp"
+#include "types/intvector.hpp"
+#include "types/sorted_int_stack.hpp"
+#include "util/locking.hpp"
+#include "util/registered.hpp"
+
+namespace py = pybind11;
+
+
+PYBIND11_MODULE(_bitvectors, m)
+{
+    m.doc() = "sdsl-lite bindings for python: compressed bit vectors";
+    locking::gil_not_used(m);
+
+    py::module::import("pysdsl._vectors");
+    auto iv_classes = registered_classes<int_vector_classes>();
+    auto bit_vector_classes = std::make_tuple(std::get<1>(iv_classes));
+
+    auto compressed_bit_vector_classes = std::get<0>(add_bitvectors(m));
+    auto dynamic_bit_vector_classes = std::make_tuple(
+        add_dynamic_bit_vector(m));
+
+    for_each_in_tuple(iv_classes,
+                      make_inits_many_functor(compressed_bit_vector_classes));
+
+    for_each_in_tuple(compressed_bit_vector_classes,
+                      make_inits_many_functor(bit_vector_classes));
+
+    for_each_in_tuple(dynamic_bit_vector_classes,
+                      make_inits_many_functor(bit_vector_classes));
+    for_each_in_tuple(bit_vector_classes,
+                      detail::add_init_from_dynamic_functor());
+    for_each_in_tuple(compressed_bit_vector_classes,
+                      detail::add_init_from_dynamic_functor());
+
+    auto sd_vector_classes = std::make_tuple(
+        registered_class<sdsl::sd_vector<>>());
+    for_each_in_tuple(sd_vector_classes,
+                      detail::add_init_from_sorted_int_stack_functor());
+#ifndef NOCROSSCONSTRUCTORS
+    for_each_in_tuple(compressed_bit_vector_classes,
+                      make_inits_many_functor(compressed_bit_vector_classes));
+#endif
+}
@@ -0,0 +1,38 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <sdsl/vectors.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "operations/creation.hpp"
+#include "types/intvector.hpp"
+#include "types/suffixarray.hpp"
+#include "util/locking.hpp"
+#include "util/registered.hpp"
+
+namespace py = pybind11;
+
+
+PYBIND11_MODULE(_csa, m)
+{
+    m.doc() = "sdsl-lite bindings for python: compressed suffix arrays";
+    locking::gil_not_used(m);
+
+    py::module::import("pysdsl._vectors");
+    auto iv_classes = registered_classes<int_vector_classes>();
+    // texts of IntVector and Int8Vector are written into the
+    // construction cache without a serialized copy
+    auto text_classes = std::make_tuple(std::get<0>(iv_classes),
+                                        std::get<3>(iv_classes));
+
+    auto csa_classes = add_csa(m);
+
+    for_each_in_tuple(csa_classes, make_inits_many_functor(text_classes));
+
+    for_each_in_tuple(csa_classes, make_pysequence_init_functor());
+}
@@ -0,0 +1,38 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <sdsl/vectors.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "operations/creation.hpp"
+#include "types/encodedvector.hpp"
+#include "types/intvector.hpp"
+#include "util/locking.hpp"
+#include "util/registered.hpp"
+
+namespace py = pybind11;
+
+
+PYBIND11_MODULE(_encoded, m)
+{
+    m.doc() = "sdsl-lite bindings for python: compressed integer vectors";
+    locking::gil_not_used(m);
+
+    py::module::import("pysdsl._vectors");
+    auto iv_classes = registered_classes<int_vector_classes>();
+
+    auto enc_classes = add_encoded_vectors(m);
+
+    for_each_in_tuple(iv_classes, make_inits_many_functor(enc_classes));
+    for_each_in_tuple(enc_classes, make_inits_many_functor(iv_classes));
+#ifndef NOCROSSCONSTRUCTORS
+    for_each_in_tuple(enc_classes, make_inits_many_functor(enc_classes));
+#endif
+
+    for_each_in_tuple(enc_classes, make_pysequence_init_functor());
+}
@@ -5,6 +5,8 @@
 
 #include <sdsl/memory_management.hpp>
 
+#include "util/locking.hpp"
+
 namespace py = pybind11;
 
 
@@ -12,6 +14,8 @@ PYBIND11_MODULE(_memory_monitor, m)
 {
     m.doc() = "Internals of memory monitor module";
 
+    locking::gil_not_used(m);
+
     m.def("start", [] () { return sdsl::memory_monitor::start(); });
     m.def("stop", [] () { return sdsl::memory_monitor::stop(); });
     m.def(
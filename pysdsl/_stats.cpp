@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "util/locking.hpp"
+#include "util/stats.hpp"
+
+namespace py = pybind11;
+
+
+namespace
+{
+    // Counters of all instrumented methods written by one thread. Counters
+    // are allocated by the owner on first use and published to readers
+    // with release stores; they are never freed.
+    class thread_counters
+    {
+    private:
+        static constexpr size_t chunk_size = 64;
+        static constexpr size_t max_chunks = 1024;
+
+        struct chunk
+        {
+            std::atomic<stats::method_counters*> counters[chunk_size] = {};
+        };
+
+        std::atomic<chunk*> m_chunks[max_chunks] = {};
+    public:
+        stats::method_counters* get(size_t id)
+        {
+            if (id >= chunk_size * max_chunks) {
+                throw std::length_error("too many instrumented methods"); }
+            auto& slot = m_chunks[id / chunk_size];
+            chunk* c = slot.load(std::memory_order_relaxed);
+            if (!c) {
+                c = new chunk();
+                slot.store(c, std::memory_order_release); }
+            auto& counters = c->counters[id % chunk_size];
+            stats::method_counters* result =
+                counters.load(std::memory_order_relaxed);
+            if (!result) {
+                result = new stats::method_counters();
+                counters.store(result, std::memory_order_release); }
+            return result;
+        }
+
+        const stats::method_counters* find(size_t id) const
+        {
+            chunk* c = m_chunks[id / chunk_size].load(
+                std::memory_order_acquire);
+            if (!c) return nullptr;
+            return c->counters[id % chunk_size].load(std::memory_order_acquire);
+        }
+    };
+
+
+    struct state
+    {
+        std::mutex mutex;
+        std::vector<std::string> names;
+        std::unordered_map<std::string, size_t> ids;
+        // counters of all threads that ever recorded a call
+        std::vector<thread_counters*> threads;
+        // counters of finished threads, reused by new threads
+        std::vector<thread_counters*> released;
+    };
+
+    state& global()
+    {
+        // never destroyed: threads may still record during shutdown
+        static state* instance = new state();
+        return *instance;
+    }
+
+
+    size_t method_id(const char* name)
+    {
+        auto& g = global();
+        std::lock_guard<std::mutex> lock(g.mutex);
+        auto found = g.ids.find(name);
+        if (found != g.ids.end()) return found->second;
+        g.names.emplace_back(name);
+        return g.ids[name] = g.names.size() - 1;
+    }
+
+
+    // Gives the counters of a finished thread (and the calls it recorded)
+    // to the next thread that starts recording
+    class thread_slot
+    {
+    private:
+        thread_counters* m_counters = nullptr;
+    public:
+        thread_counters* get()
+        {
+            if (m_counters) return m_counters;
+            auto& g = global();
+            std::lock_guard<std::mutex> lock(g.mutex);
+            if (!g.released.empty()) {
+                m_counters = g.released.back();
+                g.released.pop_back();
+            } else {
+                m_counters = new thread_counters();
+                g.threads.push_back(m_counters); }
+            return m_counters;
+        }
+
+        ~thread_slot()
+        {
+            if (!m_counters) return;
+            auto& g = global();
+            std::lock_guard<std::mutex> lock(g.mutex);
+            g.released.push_back(m_counters);
+        }
+    };
+
+
+    stats::method_counters* counters(size_t id)
+    {
+        thread_local thread_slot slot;
+        return slot.get()->get(id);
+    }
+
+
+    stats::registry& registry()
+    {
+        static stats::registry* instance = [] {
+            auto result = new stats::registry();
+            result->method_id = method_id;
+            result->counters = counters;
+            return result; }();
+        return *instance;
+    }
+
+
+    template <class F>
+    void for_each_counters(F f)
+    {
+        auto& g = global();
+        std::lock_guard<std::mutex> lock(g.mutex);
+        for (size_t id = 0; id < g.names.size(); id++) {
+            for (const auto* t: g.threads) {
+                if (const auto* c = t->find(id)) f(g.names[id], *c); } }
+    }
+}  // namespace
+
+
+PYBIND11_MODULE(_stats, m)
+{
+    m.doc() = "Internals of pysdsl.stats";
+    locking::gil_not_used(m);
+
+    m.attr("_registry") = py::capsule(&registry(), "pysdsl._stats.registry");
+
+    m.def("enable", [] () { registry().enabled = true; });
+    m.def("disable", [] () { registry().enabled = false; });
+    m.def("is_enabled", [] () { return bool(registry().enabled); });
+    m.def(
+        "reset",
+        [] () {
+            for_each_counters([] (const std::string&,
+                                  const stats::method_counters& c) {
+                auto& counters = const_cast<stats::method_counters&>(c);
+                counters.calls = 0;
+                counters.elements = 0;
+                counters.total_ns = 0;
+                counters.max_ns = 0;
+                for (auto& h: counters.histogram) h = 0; }); },
+        py::call_guard<py::gil_scoped_release>());
+    m.def(
+        "raw_snapshot",
+        [] () {
+            // name -> (calls, elements, total_ns, max_ns,
+            //          [(bucket lower bound in ns, count), ...])
+            typedef std::tuple<uint64_t, uint64_t, uint64_t, uint64_t,
+                               std::vector<std::pair<uint64_t, uint64_t>>>
+                totals;
+            std::unordered_map<std::string, totals> result;
+            {
+                py::gil_scoped_release release;
+                std::unordered_map<std::string,
+                                   std::vector<uint64_t>> histograms;
+                for_each_counters([&] (const std::string& name,
+                                       const stats::method_counters& c) {
+                    auto& t = result[name];
+                    std::get<0>(t) += c.calls.load(std::memory_order_relaxed);
+                    std::get<1>(t) += c.elements.load(
+                        std::memory_order_relaxed);
+                    std::get<2>(t) += c.total_ns.load(
+                        std::memory_order_relaxed);
+                    std::get<3>(t) = std::max<uint64_t>(
+                        std::get<3>(t),
+                        c.max_ns.load(std::memory_order_relaxed));
+                    auto& h = histograms[name];
+                    h.resize(stats::histogram_buckets);
+                    for (size_t b = 0; b < stats::histogram_buckets; b++) {
+                        h[b] += c.histogram[b].load(
+                            std::memory_order_relaxed); } });
+                for (auto& named: result) {
+                    const auto& h = histograms[named.first];
+                    for (size_t b = 0; b < h.size(); b++) {
+                        if (!h[b]) continue;
+                        std::get<4>(named.second).emplace_back(
+                            stats::bucket_lower_bound(b), h[b]); } }
+            }
+            return result; });
+}
@@ -0,0 +1,27 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <pybind11/pybind11.h>
+
+#include "types/k2tree.hpp"
+#include "types/tree.hpp"
+#include "util/locking.hpp"
+
+namespace py = pybind11;
+
+
+PYBIND11_MODULE(_trees, m)
+{
+    m.doc() = "sdsl-lite bindings for python: succinct trees and k2-trees";
+    locking::gil_not_used(m);
+
+    py::module::import("pysdsl._vectors");
+
+    add_trees(m);
+
+    add_k2_trees(m);
+}
@@ -0,0 +1,45 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <sdsl/vectors.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "operations/creation.hpp"
+#include "supports.hpp"
+#include "types/intvector.hpp"
+#include "types/intvector_builder.hpp"
+#include "types/sorted_int_stack.hpp"
+#include "util/locking.hpp"
+#include "util/registered.hpp"
+
+namespace py = pybind11;
+
+
+PYBIND11_MODULE(_vectors, m)
+{
+    m.doc() = "sdsl-lite bindings for python: int vectors, bit vector "
+              "supports and sorted int stacks";
+    locking::gil_not_used(m);
+
+    add_int_vectors(m);
+    auto iv_classes = registered_classes<int_vector_classes>();
+    add_int_vector_builder(m);
+
+    add_bitvector_supports(m, std::get<1>(iv_classes));
+
+    auto sorted_stack = add_sorted_int_stack(m);
+
+    for_each_in_tuple(iv_classes, make_inits_many_functor(iv_classes));
+    for_each_in_tuple(sorted_stack, make_inits_many_functor(sorted_stack));
+
+    for_each_in_tuple(iv_classes, make_pysequence_init_functor());
+
+    auto bit_vector_classes = std::make_tuple(std::get<1>(iv_classes));
+    for_each_in_tuple(bit_vector_classes,
+                      detail::add_init_from_sorted_int_stack_functor());
+}
@@ -0,0 +1,49 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+#define assert(x) if(!x) {throw std::runtime_error("assertion failed");}
+
+#include <sdsl/vectors.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "operations/creation.hpp"
+#include "types/appendable_wavelet.hpp"
+#include "types/bitvector.hpp"
+#include "types/encodedvector.hpp"
+#include "types/intvector.hpp"
+#include "types/wavelet.hpp"
+#include "util/locking.hpp"
+#include "util/registered.hpp"
+
+namespace py = pybind11;
+
+
+PYBIND11_MODULE(_wavelet, m)
+{
+    m.doc() = "sdsl-lite bindings for python: wavelet trees";
+    locking::gil_not_used(m);
+
+    py::module::import("pysdsl._vectors");
+    py::module::import("pysdsl._bitvectors");
+    py::module::import("pysdsl._encoded");
+    auto iv_classes = registered_classes<int_vector_classes>();
+    auto enc_classes = registered_classes<encoded_vector_classes>();
+    auto cbv_propagate = registered_classes<propagated_bit_vector_classes>();
+
+    auto wavelet_classes = add_wavelet(m, cbv_propagate);
+    add_appendable_wavelet_matrix(m);
+
+    for_each_in_tuple(iv_classes, make_inits_many_functor(wavelet_classes));
+
+    for_each_in_tuple(wavelet_classes, make_inits_many_functor(iv_classes));
+#ifndef NOCROSSCONSTRUCTORS
+    for_each_in_tuple(wavelet_classes, make_inits_many_functor(enc_classes));
+    for_each_in_tuple(wavelet_classes,
+                      make_inits_many_functor(wavelet_classes));
+#endif
+
+    for_each_in_tuple(wavelet_classes, make_pysequence_init_functor());
+}
@@ -0,0 +1,78 @@
+"""asyncio front end of the `*_async` methods.
+
+    sa = await pysdsl.SuffixArrayWaveletTree.build_async(text)
+    positions = await sa.locate_async("abra")
+    ranks = await wt.rank_many_async(positions, values)
+
+The calls run without the GIL on a worker pool owned by pysdsl (one
+thread per CPU, see workers()), so they neither block the event loop nor
+take threads from its default executor. Every event loop has one
+completion queue with an eventfd (a pipe outside Linux): workers signal it
+only when it was empty, so a burst of completions wakes the loop once and
+resolves all of its futures in one callback.
+
+Each event loop has at most PENDING_PER_WORKER * workers() calls queued or
+running on the pool; further calls wait for a slot in the returned task
+before they are handed to the pool.
+
+Cancelling an awaited call discards its result; the native call still runs
+to the end (unless it was still waiting for a slot) and keeps its slot
+until then. The awaited structure and arguments are kept alive until then.
+"""
+
+import asyncio
+import weakref
+
+from pysdsl import _async
+
+
+PENDING_PER_WORKER = 4
+
+
+class _LoopQueue:
+    def __init__(self, loop):
+        self.native = _async.CompletionQueue()
+        self.slots = asyncio.Semaphore(PENDING_PER_WORKER * workers())
+        loop.add_reader(self.native.fileno(), self.drain)
+
+    async def run(self, job):
+        await self.slots.acquire()
+        future = asyncio.get_running_loop().create_future()
+        self.native.submit(job, future)
+        return await future
+
+    def drain(self):
+        for future, job in self.native.drain():
+            # released once the native call is over, even if cancelled
+            self.slots.release()
+            if future.cancelled():
+                continue
+            try:
+                result = _async.result(job)
+            except Exception as error:
+                future.set_exception(error)
+            else:
+                future.set_result(result)
+
+
+_queues = weakref.WeakKeyDictionary()
+
+
+def _queue(loop):
+    queue = _queues.get(loop)
+    if queue is None:
+        queue = _queues[loop] = _LoopQueue(loop)
+    return queue
+
+
+def submit(job):
+    """Runs a native job (created by a `*_async` method) on the worker pool
+    once the running event loop has a free slot; returns a task of its
+    result"""
+    loop = asyncio.get_running_loop()
+    return loop.create_task(_queue(loop).run(job))
+
+
+def workers():
+    """Number of threads of the worker pool"""
+    return _async.workers()
@@ -0,0 +1,24 @@
+"""Benchmark helpers shipped with pysdsl.
+
+``python -m pysdsl.bench`` runs the query latency harness (see
+pysdsl.bench.latency); construction benchmarks live in ``benchmarks/`` of
+the source tree and share the synthetic data of pysdsl.bench.datagen.
+"""
+
+import platform
+
+
+def environment():
+    """Description of the machine and versions, stored with results"""
+    try:
+        from importlib.metadata import version
+        pysdsl_version = version("pysdsl")
+    except Exception:
+        pysdsl_version = "unknown"
+    return {
+        "pysdsl": pysdsl_version,
+        "python": platform.python_version(),
+        "platform": platform.platform(),
+        "machine": platform.machine(),
+        "processor": platform.processor(),
+    }
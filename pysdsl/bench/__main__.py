@@ -0,0 +1,4 @@
+from pysdsl.bench.latency import main
+
+
+main()
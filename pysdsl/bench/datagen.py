@@ -0,0 +1,92 @@
+"""Synthetic inputs for the benchmarks.
+
+Every generator returns a one-dimensional numpy uint64 array of `n` values
+and is deterministic for a given `seed`. Text-like generators return byte
+values without zeros, so their output can be used as a suffix array text.
+"""
+
+import numpy as np
+
+
+DNA_ALPHABET = np.frombuffer(b"ACGT", dtype=np.uint8)
+
+# Most frequent English words; drawn with Zipf-distributed ranks
+ENGLISH_WORDS = (
+    "the of and to a in is you that it he was for on are as with his they "
+    "i at be this have from or one had by word but not what all were we "
+    "when your can said there use an each which she do how their if will "
+    "up other about out many then them these so some her would make like "
+    "him into time has look two more write go see number no way could "
+    "people my than first water been call who oil its now find long down "
+    "day did get come made may part").split()
+
+
+def uniform(n, sigma=1 << 16, seed=42):
+    """Values drawn uniformly from [0..sigma)"""
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, sigma, size=n, dtype=np.uint64)
+
+
+def zipf(n, sigma=1 << 16, a=1.3, seed=42):
+    """Zipf-distributed values in [0..sigma): value k has probability
+    proportional to (k + 1) ** -a"""
+    rng = np.random.default_rng(seed)
+    return ((rng.zipf(a, size=n) - 1) % sigma).astype(np.uint64)
+
+
+def sorted_values(n, max_gap=64, seed=42):
+    """Strictly increasing values with uniform gaps in [1..max_gap]"""
+    rng = np.random.default_rng(seed)
+    return np.cumsum(rng.integers(1, max_gap + 1, size=n, dtype=np.uint64),
+                     dtype=np.uint64)
+
+
+def dna(n, seed=42):
+    """Bytes of a uniformly random DNA string"""
+    rng = np.random.default_rng(seed)
+    return DNA_ALPHABET[rng.integers(0, 4, size=n)].astype(np.uint64)
+
+
+def english(n, a=1.1, seed=42):
+    """Bytes of a text of English words with Zipf-distributed frequencies"""
+    rng = np.random.default_rng(seed)
+    ranks = (rng.zipf(a, size=n // 3 + 1) - 1) % len(ENGLISH_WORDS)
+    text = " ".join(ENGLISH_WORDS[r] for r in ranks).encode()[:n]
+    return np.frombuffer(text.ljust(n), dtype=np.uint8).astype(np.uint64)
+
+
+def bits(dataset, n, seed=42):
+    """`n` bits (as 0/1 values) derived from `dataset`: random bits of
+    density 1/2 (uniform), runs of Zipf-distributed lengths (zipf), the
+    sparse characteristic vector of sorted values (sorted), G/C positions
+    (dna) and word separators (english)"""
+    if dataset == "uniform":
+        rng = np.random.default_rng(seed)
+        return rng.integers(0, 2, size=n, dtype=np.uint64)
+    if dataset == "zipf":
+        runs = zipf(n, sigma=n, a=1.5, seed=seed) + 1
+        values = np.repeat(np.arange(len(runs)) % 2, runs.astype(np.int64))
+        return values[:n].astype(np.uint64)
+    if dataset == "sorted":
+        positions = sorted_values(n // 32 + 1, seed=seed)
+        result = np.zeros(n, dtype=np.uint64)
+        result[positions[positions < n].astype(np.int64)] = 1
+        return result
+    if dataset == "dna":
+        values = dna(n, seed=seed)
+        return ((values == ord("G")) | (values == ord("C"))).astype(np.uint64)
+    if dataset == "english":
+        return (english(n, seed=seed) == ord(" ")).astype(np.uint64)
+    raise ValueError("unknown dataset: " + dataset)
+
+
+DATASETS = {
+    "uniform": uniform,
+    "zipf": zipf,
+    "sorted": sorted_values,
+    "dna": dna,
+    "english": english,
+}
+
+# Datasets with byte values 1..255, usable as text
+TEXT_DATASETS = ("dna", "english")
@@ -0,0 +1,294 @@
+"""Query latency benchmark: ``python -m pysdsl.bench``.
+
+Drives uniform and Zipf-skewed query streams through the hot methods of
+representative classes on 1..N Python threads. Every call is timed
+separately; the results hold latency percentiles, a log2 latency histogram
+and the throughput of all threads together. The same queries are run once
+by a native C++ loop (pysdsl._bench) and the difference of mean latencies is
+reported as the overhead of Python dispatch.
+
+    python -m pysdsl.bench --size 1000000 --queries 100000 --out q.json
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+import threading
+import time
+
+import numpy as np
+
+import pysdsl
+from pysdsl import _bench
+from pysdsl.bench import datagen, environment
+
+
+PERCENTILES = {"p50_ns": 50, "p90_ns": 90, "p99_ns": 99, "p999_ns": 99.9}
+
+
+class Operation(object):
+    """Queries for one method of one object.
+
+    `call` is the bound Python method, `args` the query arguments as numpy
+    arrays (or a list for patterns) and `native` the function of
+    pysdsl._bench running the same queries, if there is one.
+    """
+
+    def __init__(self, name, call, args, native=None, obj=None):
+        self.name = name
+        self.call = call
+        self.args = args
+        self.native = native
+        self.obj = obj
+
+    def python_args(self):
+        return [a.tolist() if isinstance(a, np.ndarray) else a
+                for a in self.args]
+
+
+def positions(count, limit, distribution, rng):
+    """`count` positions in [0..limit) drawn uniformly or with Zipf-skewed
+    frequencies; the hot positions are scattered over the whole range"""
+    if distribution == "uniform":
+        return rng.integers(0, limit, size=count, dtype=np.uint64)
+    ranks = rng.zipf(1.2, size=count).astype(np.uint64)
+    return (ranks * np.uint64(0x9E3779B97F4A7C15)) % np.uint64(limit)
+
+
+def occurrences(values):
+    """occurrences[i] = number of j <= i with values[j] == values[i]"""
+    order = np.argsort(values, kind="stable")
+    ordered = values[order]
+    first = np.searchsorted(ordered, ordered, side="left")
+    result = np.empty(len(values), dtype=np.uint64)
+    result[order] = np.arange(len(values), dtype=np.uint64) - first + 1
+    return result
+
+
+def int_vector(values):
+    raw = pysdsl.Int64Vector(len(values))
+    np.asarray(raw)[:] = values
+    v = pysdsl.IntVector(raw)
+    v.bit_compress()
+    return v
+
+
+def vector_cases(n, count, distribution, rng, seed):
+    values = datagen.uniform(n, sigma=1 << 16, seed=seed)
+    iv = int_vector(values)
+    idx = positions(count, n, distribution, rng)
+    for cls in (pysdsl.IntVector, pysdsl.EncVectorEliasDelta,
+                pysdsl.DACVector):
+        obj = iv if cls is pysdsl.IntVector else cls(iv)
+        yield cls.__name__, Operation("__getitem__", obj.__getitem__, [idx],
+                                      _bench.access, obj)
+
+
+def bitvector_cases(n, count, distribution, rng, seed):
+    raw = pysdsl.Int64Vector(n)
+    np.asarray(raw)[:] = datagen.bits("uniform", n, seed=seed)
+    bv = pysdsl.BitVector(raw)
+    idx = positions(count, n, distribution, rng)
+
+    yield "BitVector", Operation("__getitem__", bv.__getitem__, [idx],
+                                 _bench.access, bv)
+    for init in ("init_rankV_1", "init_rankV5_1"):
+        support = getattr(bv, init)()
+        yield "BitVector", Operation(init + ".rank", support.rank, [idx],
+                                     _bench.support_call, support)
+
+    rank = bv.init_rank_1()
+    ones = rank.rank(n - 1) + bv[n - 1]
+    select = bv.init_select_1()
+    ks = positions(count, ones, distribution, rng) + np.uint64(1)
+    yield "BitVector", Operation("init_select_1.select", select.select, [ks],
+                                 _bench.support_call, select)
+
+    for cls in (pysdsl.RamanRamanRaoVector63, pysdsl.SDVector):
+        obj = cls(bv)
+        yield cls.__name__, Operation("__getitem__", obj.__getitem__, [idx],
+                                      _bench.access, obj)
+
+
+def wavelet_cases(n, count, distribution, rng, seed, window=1024):
+    values = datagen.zipf(n, sigma=1 << 8, seed=seed)
+    iv = int_vector(values)
+    occ = occurrences(values)
+
+    idx = positions(count, n, distribution, rng)
+    # symbols that occur, each paired with a valid occurrence number
+    at = positions(count, n, distribution, rng).astype(np.int64)
+    symbols = values[at]
+    ks = occ[at]
+
+    lbs = positions(count, n - window + 1, distribution, rng)
+    rbs = lbs + np.uint64(window - 1)
+    qs = rng.integers(0, window, size=count, dtype=np.uint64)
+
+    for cls in (pysdsl.WaveletTreeInt, pysdsl.WaveletMatrixInt):
+        wt = cls(iv)
+        name = cls.__name__
+        yield name, Operation("__getitem__", wt.__getitem__, [idx],
+                              _bench.access, wt)
+        yield name, Operation("rank", wt.rank, [idx, symbols],
+                              _bench.wt_rank, wt)
+        yield name, Operation("select", wt.select, [ks, symbols],
+                              _bench.wt_select, wt)
+        if hasattr(wt, "quantile_freq"):
+            yield name, Operation("quantile_freq", wt.quantile_freq,
+                                  [lbs, rbs, qs], _bench.quantile_freq, wt)
+
+
+def csa_cases(n, count, distribution, rng, seed, pattern_length=8,
+              extract_length=64):
+    text = datagen.english(n, seed=seed).astype(np.uint8).tobytes()
+
+    starts = positions(count, n - pattern_length, distribution, rng)
+    patterns = [text[s:s + pattern_length] for s in starts.tolist()]
+    begins = positions(count, n - extract_length - 1, distribution, rng)
+    ends = begins + np.uint64(extract_length)
+
+    for cls in (pysdsl.SuffixArrayWaveletTree, pysdsl.SuffixArraySadakane):
+        csa = cls(text)
+        name = cls.__name__
+        yield name, Operation("count", csa.count, [patterns],
+                              _bench.csa_count, csa)
+        yield name, Operation("locate", csa.locate, [patterns],
+                              _bench.csa_locate, csa)
+        yield name, Operation("extract", csa.extract, [begins, ends],
+                              _bench.csa_extract, csa)
+
+
+FAMILIES = {
+    "vectors": vector_cases,
+    "bitvectors": bitvector_cases,
+    "wavelet": wavelet_cases,
+    "csa": csa_cases,
+}
+
+
+def time_python(op, threads):
+    """Latencies of all queries of `op` in ns and the wall time in seconds
+    when the queries are split between `threads` threads"""
+    args = op.python_args()
+    count = len(args[0])
+    latencies = np.empty(count, dtype=np.int64)
+    bounds = np.linspace(0, count, threads + 1).astype(int)
+    barrier = threading.Barrier(threads + 1)
+
+    def worker(begin, end):
+        call = op.call
+        clock = time.perf_counter_ns
+        chunk = list(zip(*(a[begin:end] for a in args)))
+        barrier.wait()
+        for i, query in enumerate(chunk, begin):
+            start = clock()
+            call(*query)
+            latencies[i] = clock() - start
+
+    workers = [threading.Thread(target=worker, args=(bounds[t], bounds[t + 1]))
+               for t in range(threads)]
+    for w in workers:
+        w.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for w in workers:
+        w.join()
+    return latencies, time.perf_counter() - start
+
+
+def time_native(op):
+    """Mean latency in ns of the native loop, None if there is none"""
+    if op.native is None:
+        return None
+    try:
+        nanoseconds, _ = op.native(op.obj, *op.args)
+    except TypeError:  # no native loop for this class
+        return None
+    return nanoseconds / len(op.args[0])
+
+
+def histogram(latencies):
+    """Number of latencies in every [2^k, 2^(k+1)) ns bucket"""
+    buckets = np.bincount(np.log2(np.maximum(latencies, 1)).astype(int))
+    return {str(1 << k): int(c) for k, c in enumerate(buckets) if c}
+
+
+def run(families, distributions, thread_counts, n, count, seed,
+        class_filter):
+    results = []
+    for family in families:
+        for distribution in distributions:
+            rng = np.random.default_rng(seed)
+            for name, op in FAMILIES[family](n, count, distribution, rng,
+                                             seed):
+                if class_filter and not class_filter.search(name):
+                    continue
+                native = time_native(op)
+                for threads in thread_counts:
+                    latencies, wall = time_python(op, threads)
+                    record = {"family": family, "class": name,
+                              "operation": op.name, "dataset": distribution,
+                              "threads": threads, "n": n,
+                              "queries": len(latencies),
+                              "throughput_qps": len(latencies) / wall,
+                              "mean_ns": float(latencies.mean()),
+                              "max_ns": int(latencies.max()),
+                              "native_mean_ns": native,
+                              "dispatch_overhead_ns": (
+                                  None if native is None
+                                  else float(latencies.mean()) - native),
+                              "histogram": histogram(latencies)}
+                    for key, q in PERCENTILES.items():
+                        record[key] = float(np.percentile(latencies, q))
+                    print("{class:<26} {operation:<22} {dataset:<8} "
+                          "t={threads:<3} p50 {p50_ns:9.0f} ns  "
+                          "p99 {p99_ns:9.0f} ns  p999 {p999_ns:9.0f} ns  "
+                          "{throughput_qps:12.0f} q/s".format(**record),
+                          file=sys.stderr)
+                    results.append(record)
+    return results
+
+
+def default_threads():
+    cpus = os.cpu_count() or 1
+    counts = [1]
+    while counts[-1] * 2 <= cpus:
+        counts.append(counts[-1] * 2)
+    return counts
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        prog="python -m pysdsl.bench", description=__doc__.splitlines()[0])
+    parser.add_argument("--size", type=int, default=10 ** 6,
+                        help="number of elements of every structure")
+    parser.add_argument("--queries", type=int, default=10 ** 5,
+                        help="number of queries per operation")
+    parser.add_argument("--families", nargs="+", choices=sorted(FAMILIES),
+                        default=sorted(FAMILIES))
+    parser.add_argument("--distributions", nargs="+",
+                        choices=["uniform", "zipf"],
+                        default=["uniform", "zipf"])
+    parser.add_argument("--threads", type=int, nargs="+",
+                        default=default_threads(),
+                        help="thread counts (default: powers of two up to "
+                             "the number of CPUs)")
+    parser.add_argument("--classes", type=re.compile, default=None,
+                        help="regular expression for class names to run")
+    parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--out", type=argparse.FileType("w"),
+                        default=sys.stdout, help="JSON output file")
+    args = parser.parse_args(argv)
+
+    results = run(args.families, args.distributions, args.threads,
+                  args.size, args.queries, args.seed, args.classes)
+    json.dump({"benchmark": "queries",
+               "environment": environment(),
+               "parameters": {"size": args.size, "queries": args.queries,
+                              "seed": args.seed},
+               "results": results},
+              args.out, indent=2)
+    args.out.write("\n")
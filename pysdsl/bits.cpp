@@ -4,6 +4,10 @@
 #include "sdsl/bits.hpp"
 #include <pybind11/pybind11.h>
 
+#include "operations/batch.hpp"
+#include "util/bits_kernels.hpp"
+#include "util/locking.hpp"
+
 
 namespace py = pybind11;
 
@@ -12,7 +16,7 @@ template<typename T, std::size_t N>
 decltype(auto) as_tuple(const T (&a) [N])
 {
     py::tuple result{N};
-    for (std::size_t i; i < N; i++) result[i] = a[i];
+    for (std::size_t i = 0; i < N; i++) result[i] = a[i];
     return result;
 }
 
@@ -30,10 +34,10 @@ auto cnt01 = [] (uint64_t x, uint64_t& c) {
     return std::make_pair(result, c);
 };
 auto sel = [] (uint64_t x, uint32_t i) {
-    if (i >= sizeof(sdsl::bits::ps_overflow) / sizeof(sdsl::bits::ps_overflow[0])) {
+    if (i == 0 || i >= sizeof(sdsl::bits::ps_overflow) / sizeof(sdsl::bits::ps_overflow[0])) {
         throw py::index_error(std::to_string(i));
     }
-    return sdsl::bits::sel(x, i);
+    return bits_kernels::select(x, i);
 };
 auto sel11 = [] (uint64_t x, uint32_t i, uint32_t c=0) {
     if (i >= sizeof(sdsl::bits::ps_overflow) / sizeof(sdsl::bits::ps_overflow[0])) {
@@ -43,8 +47,48 @@ auto sel11 = [] (uint64_t x, uint32_t i, uint32_t c=0) {
 };
 
 
+// Array versions: one kernel call over the whole buffer without the GIL
+template <class K>
+py::array_t<uint64_t> apply(const bits_kernels::kernel<K>& kernel,
+                            const input_array<uint64_t>& x)
+{
+    detail::check_1d(x, "x");
+    const size_t n = x.shape(0);
+    py::array_t<uint64_t> result(n);
+    const uint64_t* in = x.data();
+    uint64_t* out = result.mutable_data();
+    {
+        py::gil_scoped_release release;
+        kernel.run(in, out, n);
+    }
+    return result;
+}
+
+auto sel_many = [] (const input_array<uint64_t>& x,
+                    const input_array<uint64_t>& i) {
+    detail::check_1d(x, "x");
+    detail::check_1d(i, "i");
+    if (x.shape(0) != i.shape(0)) {
+        throw std::invalid_argument("arrays should have equal length"); }
+    const size_t n = x.shape(0);
+    py::array_t<uint64_t> result(n);
+    const uint64_t* words = x.data();
+    const uint64_t* ranks = i.data();
+    uint64_t* out = result.mutable_data();
+    {
+        py::gil_scoped_release release;
+        for (size_t k = 0; k < n; k++) {
+            if (ranks[k] < 1 || ranks[k] > 64) {
+                throw py::index_error(std::to_string(ranks[k])); } }
+        bits_kernels::sel().run(words, ranks, out, n);
+    }
+    return result;
+};
+
+
 PYBIND11_MODULE(bits, m) {
     m.doc() = "bitwise tricks on 64 bit words.";
+    locking::gil_not_used(m);
 
 
     auto bits_cls = py::class_<sdsl::bits>(m, "bits")
@@ -109,11 +153,17 @@ PYBIND11_MODULE(bits, m) {
                     "Use to help to decide if a prefix sum stored in a byte overflows.")
 
         .def_static("cnt", &sdsl::bits::cnt, "Counts the number of set bits in x.", py::arg("x"))
+        .def_static("cnt", [](const input_array<uint64_t>& x) { return apply(bits_kernels::cnt(), x); },
+                    "Numbers of set bits of every word of a uint64 array.", py::arg("x"))
         .def_static("cnt32", &sdsl::bits::cnt32, "Counts the number of set bits in 32-bit integer x.", py::arg("x"))
         .def_static("hi", &sdsl::bits::hi, "The position (in 0..63) of the most significant set bit "
                                            "in `x` or 0 if x equals 0.", py::arg("x"))
+        .def_static("hi", [](const input_array<uint64_t>& x) { return apply(bits_kernels::hi(), x); },
+                    "hi of every word of a uint64 array.", py::arg("x"))
         .def_static("lo", &sdsl::bits::lo, "The position (in 0..63) of the rightmost 1-bit in the 64bit integer x if "
                                            "x>0 and 0 if x equals 0.", py::arg("x"))
+        .def_static("lo", [](const input_array<uint64_t>& x) { return apply(bits_kernels::lo(), x); },
+                    "lo of every word of a uint64 array.", py::arg("x"))
 
         .def_static("cnt11", (uint32_t (*) (uint64_t)) &sdsl::bits::cnt11, py::arg("x"),
                     "Count the number of consecutive and distinct 11 in the 64bit integer x.\n"
@@ -136,6 +186,9 @@ PYBIND11_MODULE(bits, m) {
         .def_static("sel",  sel, py::arg("x"), py::arg("i"),
                     "Calculate the position of the i-th rightmost 1 bit in the 64bit integer x\n"
                     "x: 64bit integer.\ni: Argument i must be in the range [1..cnt(x)].")
+        .def_static("sel", sel_many, py::arg("x"), py::arg("i"),
+                    "sel(x[k], i[k]) for every word of a uint64 array x; i[k] in [1..64], "
+                    "the result is undefined when i[k] > cnt(x[k]).")
         .def_static("sel11", sel11, py::arg("x"), py::arg("i"), py::arg("c") = 0,
                      "The position (in 1..63) of the i-th 11-bit-pattern which terminates a Fibonacci coded integer in x if "
                      "x contains at least i 11-bit-patterns and a undefined value otherwise.\n"
@@ -146,6 +199,8 @@ PYBIND11_MODULE(bits, m) {
                     "The position (in 1..63) of the leftmost 1 of the leftmost 11-bit-pattern which "
                     "terminates a Fibonacci coded integer in x if x contains a 11-bit-pattern and 0 otherwise.")
         .def_static("rev", &sdsl::bits::rev, "reverses a given 64 bit word")
+        .def_static("rev", [](const input_array<uint64_t>& x) { return apply(bits_kernels::rev(), x); },
+                    "reverses every word of a uint64 array", py::arg("x"))
         ;
 
     m.attr("all_set") = bits_cls.attr("all_set_");
@@ -173,4 +228,16 @@ PYBIND11_MODULE(bits, m) {
     m.attr("sel11") = bits_cls.attr("sel11");
     m.attr("hi11") = bits_cls.attr("hi11");
     m.attr("rev") = bits_cls.attr("rev");
+
+    m.def("kernels", [] () {
+        return py::dict(py::arg("cnt") = bits_kernels::cnt().name,
+                        py::arg("hi") = bits_kernels::hi().name,
+                        py::arg("lo") = bits_kernels::lo().name,
+                        py::arg("rev") = bits_kernels::rev().name,
+                        py::arg("sel") = bits_kernels::sel().name,
+                        py::arg("popcount") = bits_kernels::popcount().name,
+                        py::arg("ones") = bits_kernels::ones().name); },
+          "Instruction set of the kernel used by the array version of every "
+          "function, and by the bit vector scans (popcount, ones), on this "
+          "CPU");
 }
@@ -0,0 +1,174 @@
+"""Directories keeping several pysdsl objects together, e.g. a suffix array,
+its document boundaries and a rank support on them.
+
+    pysdsl.store_bundle("index", {"csa": csa, "docs": docs},
+                        supports={"doc_rank": ("docs", "init_rank_1")})
+
+    bundle = pysdsl.load_bundle("index", mmap={"csa"})
+    bundle["doc_rank"](bundle["csa"].locate("abra")[0])
+
+Every object is stored to its own file by `store_to_file`. `manifest.json`
+records the format version and, for every component, its pysdsl class and
+exact sdsl type, its size and the CRC-32 of its file. Supports are not
+stored: the manifest names the vector and the method building them.
+
+Components are checked and loaded concurrently on a thread pool (loading
+releases the GIL), each either read from its file or deserialized from an
+mmap of it.
+"""
+
+import concurrent.futures
+import json
+import mmap as _mmap
+import os
+import re
+import zlib
+
+import pysdsl
+
+
+FORMAT_VERSION = 1
+
+MANIFEST = "manifest.json"
+
+_NAME = re.compile(r"^[A-Za-z0-9_.-]+$")
+
+_CHUNK = 1 << 20
+
+
+class Bundle(dict):
+    """Components of a bundle by name; `manifest` is the parsed manifest"""
+
+    def __init__(self, path, manifest, components):
+        super().__init__(components)
+        self.path = path
+        self.manifest = manifest
+
+
+def _check_name(name):
+    if not _NAME.match(name) or name == os.path.splitext(MANIFEST)[0]:
+        raise ValueError("invalid component name {!r}".format(name))
+
+
+def _crc32(file_name):
+    crc = 0
+    with open(file_name, "rb") as f:
+        for chunk in iter(lambda: f.read(_CHUNK), b""):
+            crc = zlib.crc32(chunk, crc)
+    return crc
+
+
+def store_bundle(path, components, supports=None):
+    """Stores `components` (name -> object) into the directory `path`.
+
+    `supports` maps names to (component, method) pairs, e.g.
+    ("docs", "init_rank_1"): load_bundle calls the method on the loaded
+    component to rebuild the support. Returns the manifest.
+    """
+    supports = supports or {}
+    os.makedirs(path, exist_ok=True)
+
+    entries = {}
+    for name, obj in components.items():
+        _check_name(name)
+        cls = type(obj)
+        if not hasattr(cls, "sdsl_type"):
+            raise TypeError("{} can not be stored in a bundle".format(
+                cls.__name__))
+        file_name = name + ".sdsl"
+        full_name = os.path.join(path, file_name)
+        if not obj.store_to_file(full_name):
+            raise OSError("cannot store {!r}".format(full_name))
+        entries[name] = {
+            "class": cls.__name__,
+            "sdsl_type": cls.sdsl_type,
+            "file": file_name,
+            "bytes": os.path.getsize(full_name),
+            "crc32": _crc32(full_name),
+        }
+        if hasattr(obj, "__len__"):
+            entries[name]["size"] = len(obj)
+
+    for name, (of, method) in supports.items():
+        _check_name(name)
+        if name in entries:
+            raise ValueError("duplicate component name {!r}".format(name))
+        if of not in components:
+            raise ValueError("support {!r} of unknown component {!r}".format(
+                name, of))
+        if not callable(getattr(components[of], method, None)):
+            raise ValueError("{} has no method {!r}".format(
+                type(components[of]).__name__, method))
+        entries[name] = {"support": method, "of": of}
+
+    manifest = {"format_version": FORMAT_VERSION, "components": entries}
+    temporary = os.path.join(path, MANIFEST + ".tmp")
+    with open(temporary, "w") as f:
+        json.dump(manifest, f, indent=2, sort_keys=True)
+    # the manifest appears once every component is written
+    os.replace(temporary, os.path.join(path, MANIFEST))
+    return manifest
+
+
+def read_manifest(path):
+    with open(os.path.join(path, MANIFEST)) as f:
+        manifest = json.load(f)
+    version = manifest.get("format_version")
+    if not isinstance(version, int) or version > FORMAT_VERSION:
+        raise ValueError("unsupported bundle format version {!r}".format(
+            version))
+    return manifest
+
+
+def _load_component(path, name, entry, use_mmap, verify):
+    # the manifest only names files of the bundle, as store_bundle does
+    _check_name(name)
+    if entry["file"] != name + ".sdsl":
+        raise ValueError("component {!r}: unexpected file {!r}".format(
+            name, entry["file"]))
+    cls = getattr(pysdsl, entry["class"], None)
+    if getattr(cls, "sdsl_type", None) != entry["sdsl_type"]:
+        raise ValueError("component {!r}: {} is not bound as {}".format(
+            name, entry["sdsl_type"], entry["class"]))
+    file_name = os.path.join(path, entry["file"])
+    if os.path.getsize(file_name) != entry["bytes"]:
+        raise ValueError("component {!r}: size mismatch".format(name))
+    if verify and _crc32(file_name) != entry["crc32"]:
+        raise ValueError("component {!r}: checksum mismatch".format(name))
+    if not use_mmap:
+        return cls.load_from_file(file_name)
+    with open(file_name, "rb") as f:
+        with _mmap.mmap(f.fileno(), 0, access=_mmap.ACCESS_READ) as mapped:
+            return cls.load_from_buffer(mapped)
+
+
+def load_bundle(path, mmap=False, threads=None, verify=True):
+    """Loads a bundle stored by store_bundle, as a Bundle.
+
+    mmap: True, False or the names of the components to deserialize from
+          an mmap of their file instead of reading it
+    threads: size of the loading thread pool (None: Python's default)
+    verify: whether to check the CRC-32 of every file
+    """
+    manifest = read_manifest(path)
+    entries = manifest["components"]
+
+    def use_mmap(name):
+        return mmap if isinstance(mmap, bool) else name in mmap
+
+    stored = {name: entry for name, entry in entries.items()
+              if "support" not in entry}
+    with concurrent.futures.ThreadPoolExecutor(threads) as pool:
+        futures = {
+            name: pool.submit(_load_component, path, name, entry,
+                              use_mmap(name), verify)
+            for name, entry in stored.items()}
+        components = {name: future.result()
+                      for name, future in futures.items()}
+
+    for name, entry in entries.items():
+        if "support" in entry:
+            components[name] = getattr(
+                components[entry["of"]], entry["support"])()
+
+    return Bundle(path, manifest, components)
@@ -8,6 +8,8 @@
 #include "operations/creation.hpp"
 #include "operations/iteration.hpp"
 #include "operations/sizes.hpp"
+#include "util/locking.hpp"
+#include "util/stats.hpp"
 
 
 namespace py = pybind11;
@@ -24,38 +26,55 @@ inline auto add_read_access(py::class_<Sequence>& cls)
 {
     typedef typename Sequence::value_type value_type;
 
-    add_iteration(cls);
+    add_iteration<Sequence, T>(cls);
 
     cls.def(
         "__getitem__",
-        [](const Sequence &self, size_t position) -> T {
-            if (position >= detail::size(self)) {
-                throw std::out_of_range(std::to_string(position)); }
-            return self[position]; });
+        stats::timed(cls, "__getitem__", locking::reading(
+            [](const Sequence &self, size_t position) -> T {
+                if (position >= detail::size(self)) {
+                    throw std::out_of_range(std::to_string(position)); }
+                return self[position]; })),
+        py::call_guard<py::gil_scoped_release>());
     cls.def(
         "__getitem__",
-        [](const Sequence &self, int64_t position) -> T {
-            auto abs_position = std::abs(position);
-            if (position >= 0) {
-                throw std::exception(); }
-            if (abs_position > detail::size(self)) {
-                throw std::out_of_range(std::to_string(position)); }
-            return self[detail::size(self) - abs_position]; });
+        stats::timed(cls, "__getitem__", locking::reading(
+            [](const Sequence &self, int64_t position) -> T {
+                auto abs_position = std::abs(position);
+                if (position >= 0) {
+                    throw std::exception(); }
+                if (abs_position > detail::size(self)) {
+                    throw std::out_of_range(std::to_string(position)); }
+                return self[detail::size(self) - abs_position]; })),
+        py::call_guard<py::gil_scoped_release>());
     cls.def(
         "__getitem__",
-        [](const Sequence& self, py::slice slice) {
-            size_t start, stop, step, slicelength;
-            if (!slice.compute(detail::size(self), &start, &stop, &step,
-                               &slicelength)) {
-                throw py::error_already_set{}; }
-
-            typename
-            detail::IntermediateVector<Sequence, T>::type result(slicelength);
-
-            for (size_t i = 0; i < slicelength; i++) {
-                result[i] = self[start];
-                start += step; }
-            return result; });
+        stats::timed(cls, "__getitem__",
+            [](const Sequence& self, py::slice slice) {
+                Py_ssize_t start, stop, step;
+                if (PySlice_Unpack(slice.ptr(), &start, &stop, &step) < 0) {
+                    throw py::error_already_set{}; }
+
+                // bounds are only known under the lock, which is never
+                // taken with the GIL held
+                py::gil_scoped_release release;
+                locking::shared_guard<Sequence> lock(self);
+                const Py_ssize_t slicelength = PySlice_AdjustIndices(
+                    detail::size(self), &start, &stop, step);
+
+                typename
+                detail::IntermediateVector<Sequence, T>::type
+                    result(slicelength);
+
+                for (Py_ssize_t i = 0; i < slicelength; i++) {
+                    result[i] = self[start];
+                    start += step; }
+                return result; },
+            [](const Sequence& self, const py::slice& slice) -> uint64_t {
+                size_t start, stop, step, slicelength;
+                return slice.compute(detail::size(self), &start, &stop,
+                                     &step, &slicelength) ? slicelength : 0;
+            }));
             //return construct_from<Sequence>(result); });
     return cls;
 }
@@ -69,76 +88,98 @@ auto add_std_algo(py::class_<Sequence>& cls)
 
     cls.def(
         "__contains__",
-        [](const Sequence &self, typename Sequence::value_type element) {
-            return std::find(cbegin(self),
-                             cend(self), element) != cend(self); },
+        stats::timed(cls, "__contains__", locking::reading(
+            [](const Sequence &self, typename Sequence::value_type element) {
+                return std::find(cbegin(self),
+                                 cend(self), element) != cend(self); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "max",
-        [](const Sequence &self) -> T {
-            return *std::max_element(cbegin(self), cend(self)); },
+        stats::timed(cls, "max", locking::reading(
+            [](const Sequence &self) -> T {
+                return *std::max_element(cbegin(self), cend(self)); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "argmax",
-        [](const Sequence &self) {
-            return std::distance(cbegin(self),
-                                 std::max_element(cbegin(self),
-                                                  cend(self))); },
+        stats::timed(cls, "argmax", locking::reading(
+            [](const Sequence &self) {
+                return std::distance(cbegin(self),
+                                     std::max_element(cbegin(self),
+                                                      cend(self))); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "min",
-        [](const Sequence &self) -> T {
-            return *std::min_element(cbegin(self), cend(self)); },
+        stats::timed(cls, "min", locking::reading(
+            [](const Sequence &self) -> T {
+                return *std::min_element(cbegin(self), cend(self)); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "argmin",
-        [](const Sequence &self) {
-            return std::distance(cbegin(self),
-                                 std::min_element(cbegin(self),
-                                                  cend(self))); },
+        stats::timed(cls, "argmin", locking::reading(
+            [](const Sequence &self) {
+                return std::distance(cbegin(self),
+                                     std::min_element(cbegin(self),
+                                                      cend(self))); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "minmax",
-        [](const Sequence &self) -> std::pair<T, T> {
-            auto result = std::minmax_element(cbegin(self),
-                                              cend(self));
-            return std::make_pair(*std::get<0>(result),
-                                  *std::get<1>(result)); },
+        stats::timed(cls, "minmax", locking::reading(
+            [](const Sequence &self) -> std::pair<T, T> {
+                auto result = std::minmax_element(cbegin(self),
+                                                  cend(self));
+                return std::make_pair(*std::get<0>(result),
+                                      *std::get<1>(result)); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "sum",
-        [](const Sequence &self) {
-            return std::accumulate(cbegin(self), cend(self),
-                                   uint64_t(0)); },
+        stats::timed(cls, "sum", locking::reading(
+            [](const Sequence &self) {
+                return std::accumulate(cbegin(self), cend(self),
+                                       uint64_t(0)); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "all",
-        [](const Sequence &self) {
-            return std::all_of(
-                cbegin(self), cend(self),
-                [] (const value_type value) -> bool {
-                    return value; }); },
+        stats::timed(cls, "all", locking::reading(
+            [](const Sequence &self) {
+                return std::all_of(
+                    cbegin(self), cend(self),
+                    [] (const value_type value) -> bool {
+                        return value; }); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "any",
-        [](const Sequence &self) {
-            return std::any_of(
-                cbegin(self), cend(self),
-                [] (const value_type value) -> bool {
-                    return value; }); },
+        stats::timed(cls, "any", locking::reading(
+            [](const Sequence &self) {
+                return std::any_of(
+                    cbegin(self), cend(self),
+                    [] (const value_type value) -> bool {
+                        return value; }); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "none",
-        [](const Sequence &self) {
-            return std::none_of(
-                cbegin(self), cend(self),
-                [] (const value_type value) -> bool {
-                    return value; }); },
+        stats::timed(cls, "none", locking::reading(
+            [](const Sequence &self) {
+                return std::none_of(
+                    cbegin(self), cend(self),
+                    [] (const value_type value) -> bool {
+                        return value; }); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "is_sorted",
-        [](const Sequence &self) {
-            return std::is_sorted(cbegin(self), cend(self)); },
+        stats::timed(cls, "is_sorted", locking::reading(
+            [](const Sequence &self) {
+                return std::is_sorted(cbegin(self), cend(self)); }),
+            stats::whole_sequence()),
         py::call_guard<py::gil_scoped_release>());
 
     return cls;
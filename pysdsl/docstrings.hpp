@@ -12,6 +12,20 @@ const char* doc_capacity(
     "vector: capacity ≥ bit_size)."
 );
 
+const char* doc_int_vector_builder(
+    "Grows an IntVector at the end: capacity doubles when full, whole "
+    "arrays are appended by a bit-packing loop, the width grows when a "
+    "value does not fit. finish() returns the vector without copying it."
+);
+
+const char* doc_archived_int_vector(
+    "Read-only IntVector in a file written by store_to_archive, whose "
+    "payload is cut into independently compressed blocks (zstd or lz4). "
+    "Only the block offsets are loaded: values are read by decompressing "
+    "the blocks holding them, the most recently used of which are kept in "
+    "a cache of `cache_blocks` blocks."
+);
+
 const char* doc_bit_compress(
     "Bit compress the int_vector. Determine the biggest value X "
     "and then set the int_width to the smallest possible so that "
@@ -101,6 +115,14 @@ const char* doc_hyb_vector(
     "FM-Index.'' DCC 2014."
 );
 
+const char* doc_dynamic_bit_vector(
+    "A bit vector with insertions and deletions: a B+-tree with leaves of "
+    "up to 8 KB of bits and per-node counts of bits and set bits.\n"
+    "access, rank, select, set, insert and erase take Order(log(n)); "
+    "rank and select need no support structures and stay valid after "
+    "updates."
+);
+
 const char* doc_rank_v(
     "A rank structure proposed by Sebastiano Vigna\nSpace complexity: "
     "0.25n for a bit vector of length n bits.\n\nThe superblock size is "
@@ -223,6 +245,15 @@ const char* doc_wm_int(
     "Proceedings of SPIRE 2012."
 );
 
+const char* doc_appendable_wavelet_matrix(
+    "A wavelet matrix of integers which grows at the end.\n"
+    "Appended values are buffered in a tail indexed by value. A full tail "
+    "is built into a static segment (a WaveletMatrixInt) and segments of "
+    "similar size are merged, log-structured, so appending n values "
+    "rebuilds every value Order(log(n)) times. rank, select, access and "
+    "range_search_2d combine all segments and the tail."
+);
+
 const char* doc_wt_blcd(
     "A balanced wavelet tree.\n"
     "Space complexity: Order(n * log(|Sigma|) + 2 * |Sigma| * log(n)) bits, "
@@ -259,6 +290,67 @@ const char* doc_csa_wt(
     "(WT) of the Burrow Wheeler Transform of the original text."
 );
 
+const char* doc_sharded_csa(
+    "Texts indexed by independent suffix arrays (shards), each serialized "
+    "to its own file.\nShards are built concurrently, loaded on first use "
+    "and queried concurrently; results are merged. Positions are global, "
+    "numbering the texts as if concatenated in shard order, but patterns "
+    "are only found within a shard."
+);
+
 const char* doc_sorted_int_stack(
     "A stack class which can contain integers in strictly increasing order."
 );
+
+const char* doc_bp_tree(
+    "An ordinal tree represented by its balanced parentheses sequence.\n"
+    "Each node is written as an opening parenthesis (1), followed by the "
+    "representations of its children and a closing parenthesis (0). The "
+    "sequence has to describe a single tree: unbalanced sequences and "
+    "forests such as ()() raise ValueError. A node is identified by the "
+    "position of its opening parenthesis; the root is node 0.\n"
+    "Space complexity: 2n + o(n) bits for a tree of n nodes.\n"
+    "Methods that may not find a node (e.g. `parent` of the root) return "
+    "`size`."
+);
+
+const char* doc_bp_support_sada(
+    "Navigation is supported by a range min-max tree as proposed by "
+    "Sadakane.\nReference: Kunihiko Sadakane: ''The Ultimate Balanced "
+    "Parentheses'', Technical Report, 2006."
+);
+
+const char* doc_bp_support_g(
+    "Navigation is supported by the two-level structure of Geary et al.\n"
+    "Reference: Richard F. Geary, Naila Rahman, Rajeev Raman, Venkatesh "
+    "Raman: ''A Simple Optimal Representation for Balanced Parentheses'', "
+    "CPM 2004."
+);
+
+const char* doc_bp_support_gg(
+    "Navigation is supported by the multi-level structure of Geary et al. "
+    "with pioneers stored recursively.\nReference: Richard F. Geary, "
+    "Naila Rahman, Rajeev Raman, Venkatesh Raman: ''A Simple Optimal "
+    "Representation for Balanced Parentheses'', CPM 2004."
+);
+
+const char* doc_louds_tree(
+    "An ordinal tree represented by its level-order unary degree sequence "
+    "(LOUDS).\nThe sequence starts with `10` (a virtual super-root) followed "
+    "by the degree of every node in level order written in unary: `d` ones "
+    "and a zero. A node is identified by the position of the one which "
+    "refers to it; the root is node 0.\nSpace complexity: 2n + o(n) bits "
+    "for a tree of n nodes.\n"
+    "Reference: Guy Jacobson: ''Space-efficient Static Trees and Graphs'', "
+    "FOCS 1989."
+);
+
+const char* doc_k2_tree(
+    "A k²-tree: compressed representation of the adjacency matrix of a "
+    "directed graph supporting direct and reverse neighbor queries.\n"
+    "The matrix is recursively split into k² submatrices; a bit per "
+    "submatrix tells whether it contains any edge, and only non-empty "
+    "submatrices are split further.\n"
+    "Reference: N. R. Brisaboa, S. Ladra and G. Navarro: ''k2-trees for "
+    "Compact Web Graph Representation'', SPIRE 2009."
+);
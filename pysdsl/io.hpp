@@ -1,12 +1,16 @@
 #pragma once
 
 #include <fstream>
+#include <istream>
+#include <streambuf>
+#include <typeinfo>
 
 #include <sdsl/io.hpp>
 
 #include <pybind11/pybind11.h>
 
 #include "operations/iteration.hpp"
+#include "util/locking.hpp"
 
 
 namespace py = pybind11;
@@ -21,6 +25,11 @@ decltype(auto) to_string(const T &self, const size_t max_elements=100,
                                                const char* ends="]")
 {
     std::ostringstream fout;
+
+    // called with the GIL held, which is never kept while locking
+    py::gil_scoped_release release;
+    locking::shared_guard<T> lock(self);
+
     fout.exceptions(std::ostringstream::failbit | std::ostringstream::badbit);
 
     fout << start;
@@ -64,29 +73,72 @@ inline auto add_to_string(py::class_<T>& cls)
 }
 
 
+namespace detail
+{
+    // Read-only stream buffer over memory owned by someone else (e.g. an
+    // mmap), so objects are deserialized without copying the bytes first
+    class memory_streambuf: public std::streambuf
+    {
+    public:
+        memory_streambuf(const char* data, size_t size)
+        {
+            char* begin = const_cast<char*>(data);
+            setg(begin, begin, begin + size);
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                         std::ios_base::openmode) override
+        {
+            char* base = dir == std::ios_base::beg ? eback() :
+                         dir == std::ios_base::cur ? gptr() : egptr();
+            if (off < eback() - base || off > egptr() - base) {
+                return pos_type(off_type(-1)); }
+            setg(eback(), base + off, egptr());
+            return pos_type(gptr() - eback());
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+        {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+    };
+}  // namespace detail
+
+
 template <class T, typename... TCtorArgs>
 inline auto add_serialization(py::class_<T>& cls, TCtorArgs&&... args)
 {
+    // exact sdsl type, e.g. to check what a file was stored from
+    cls.attr("sdsl_type") = sdsl::util::demangle2(typeid(T).name());
+
     cls.def(py::pickle(
-        [&](const T& self){
-            std::stringstream fout;
-            self.serialize(fout);
-            return py::bytes(fout.str()); },
-        [&](const py::bytes& serialized){
-            T result(args...);
+        [](const T& self){
+            std::string state;
+            {
+                py::gil_scoped_release release;
+                locking::shared_guard<T> lock(self);
+                std::stringstream fout;
+                self.serialize(fout);
+                state = fout.str();
+            }
+            return py::bytes(state); },
+        [args...](const py::bytes& serialized){
             std::stringstream fin(serialized);
+            py::gil_scoped_release release;
+            T result(args...);
             result.load(fin);
             return result; }));
     cls.def(
         "store_to_file",
-        [](const T &self, const std::string& file_name) {
-            return sdsl::store_to_file(self, file_name); },
+        locking::reading([](const T &self, const std::string& file_name) {
+            return sdsl::store_to_file(self, file_name); }),
         py::arg("file_name"),
         py::call_guard<py::gil_scoped_release>());
 
     cls.def_static(
         "load_from_file",
-        [&](const std::string& file_name) {
+        [args...](const std::string& file_name) {
             T self(args...);
             if (sdsl::load_from_file(self, file_name)) {
                 return self; }
@@ -94,16 +146,34 @@ inline auto add_serialization(py::class_<T>& cls, TCtorArgs&&... args)
         py::arg("file_name"),
         py::call_guard<py::gil_scoped_release>());
 
+    cls.def_static(
+        "load_from_buffer",
+        [args...](py::buffer buffer) {
+            const py::buffer_info info = buffer.request();
+            py::gil_scoped_release release;
+            detail::memory_streambuf memory(
+                static_cast<const char*>(info.ptr), info.size * info.itemsize);
+            std::istream fin(&memory);
+            T self(args...);
+            self.load(fin);
+            if (fin.fail()) {
+                throw std::invalid_argument(
+                    "buffer does not hold a serialized object"); }
+            return self; },
+        py::arg("buffer"),
+        "Loads an object stored with store_to_file from a bytes-like "
+        "object, e.g. an mmap of the file, without copying it first");
+
     cls.def(
         "store_to_checked_file",
-        [](const T &self, const std::string& file_name) {
-            return sdsl::store_to_checked_file(self, file_name); },
+        locking::reading([](const T &self, const std::string& file_name) {
+            return sdsl::store_to_checked_file(self, file_name); }),
         py::arg("file_name"),
         py::call_guard<py::gil_scoped_release>() );
 
     cls.def_static(
         "load_from_checkded_file",
-        [&](const std::string& file_name) {
+        [args...](const std::string& file_name) {
             T self(args...);
             if (sdsl::load_from_checked_file(self, file_name)) {
                 return self; }
@@ -120,47 +190,47 @@ inline auto add_description(X& cls)
     typedef typename X::type P;
     cls.def(
         "write_structure_json",
-        [](const P& self, const std::string& file_name) {
+        locking::reading([](const P& self, const std::string& file_name) {
             std::ofstream fout;
             fout.open(file_name, std::ios::out | std::ios::binary);
             if (!fout.good()) throw std::runtime_error("Can't write to file");
             sdsl::write_structure<sdsl::JSON_FORMAT, T>(self, fout);
             if (!fout.good()) throw std::runtime_error("Error during write");
-            fout.close(); },
+            fout.close(); }),
         py::arg("file_name"),
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "write_structure_html",
-        [](const P& self, const std::string& file_name) {
+        locking::reading([](const P& self, const std::string& file_name) {
             std::ofstream fout;
             fout.open(file_name, std::ios::out | std::ios::binary);
             if (!fout.good()) throw std::runtime_error("Can't write to file");
             sdsl::write_structure<sdsl::HTML_FORMAT, T>(self, fout);
             if (!fout.good()) throw std::runtime_error("Error during write");
-            fout.close(); },
+            fout.close(); }),
         py::arg("file_name"),
         py::call_guard<py::gil_scoped_release>());
 
     cls.def_property_readonly(
         "structure_json",
-        [](const P& self) {
+        locking::reading([](const P& self) {
             std::ostringstream fout;
             fout.exceptions(std::ostringstream::failbit |
                             std::ostringstream::badbit);
 
             sdsl::write_structure<sdsl::JSON_FORMAT, T>(self, fout);
-            return fout.str(); },
+            return fout.str(); }),
         py::call_guard<py::gil_scoped_release>());
 
     cls.def_property_readonly(
         "structure_html",
-        [](const P& self) {
+        locking::reading([](const P& self) {
             std::ostringstream fout;
             fout.exceptions(std::ostringstream::failbit |
                             std::ostringstream::badbit);
 
             sdsl::write_structure<sdsl::HTML_FORMAT, T>(self, fout);
-            return fout.str();},
+            return fout.str();}),
         py::call_guard<py::gil_scoped_release>());
 
     cls.def_property_readonly(
@@ -175,10 +245,14 @@ inline auto add_description(X& cls)
             return json.attr("loads")(fout.str()); });
     cls.def_property_readonly(
         "size_in_mega_bytes",
-        [](const P &self) { return sdsl::size_in_mega_bytes<T>(self); });
+        locking::reading([](const P &self) {
+            return sdsl::size_in_mega_bytes<T>(self); }),
+        py::call_guard<py::gil_scoped_release>());
     cls.def_property_readonly(
         "size_in_bytes",
-        [](const P &self) { return sdsl::size_in_bytes<T>(self); });
+        locking::reading([](const P &self) {
+            return sdsl::size_in_bytes<T>(self); }),
+        py::call_guard<py::gil_scoped_release>());
 
     return cls;
 }
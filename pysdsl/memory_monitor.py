@@ -6,13 +6,18 @@ class MemoryMonitor(object):
     def __init__(self, out_html=None, out_json=None):
         self.out_html = out_html
         self.out_json = out_json
+        self.report = None
 
     def __enter__(self):
         _memory_monitor.start()
+        return self
 
     def __exit__(self, exc_type, exc_value, traceback):
         _memory_monitor.stop()
 
+        # sdsl's memory log parsed from JSON
+        self.report = _memory_monitor.report()
+
         if self.out_html is not None:
             _memory_monitor.report_html(self.out_html)
 
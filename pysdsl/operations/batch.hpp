@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+
+namespace py = pybind11;
+
+
+template <typename T = uint64_t>
+using input_array = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+
+namespace detail
+{
+    template <typename T>
+    inline void check_1d(const input_array<T>& arr, const char* name)
+    {
+        if (arr.ndim() != 1) {
+            throw std::invalid_argument(std::string(name) +
+                                        " should be one-dimensional"); }
+    }
+
+    template <typename T>
+    inline py::array_t<T> to_numpy(const std::vector<T>& values)
+    {
+        py::array_t<T> result(values.size());
+        std::copy(values.begin(), values.end(), result.mutable_data());
+        return result;
+    }
+
+    // Whether values[0..n) strictly increase. The comparisons of a block
+    // are and-ed without branches, which the compiler vectorizes.
+    template <typename T>
+    inline bool strictly_increasing(const T* values, size_t n)
+    {
+        constexpr size_t block = 1024;
+        for (size_t begin = 1; begin < n; begin += block) {
+            const size_t end = std::min(n, begin + block);
+            bool increasing = true;
+            for (size_t i = begin; i < end; i++) {
+                increasing &= values[i - 1] < values[i]; }
+            if (!increasing) return false;
+        }
+        return true;
+    }
+}  // namespace detail
+
+
+// Applies `f` to every element of `arr` without the GIL and returns
+// the results as a new numpy array of the same length
+template <typename R = uint64_t, typename T = uint64_t, typename F>
+inline py::array_t<R> map_array(const input_array<T>& arr, F f,
+                                const char* name = "arr")
+{
+    detail::check_1d(arr, name);
+
+    const auto n = static_cast<size_t>(arr.shape(0));
+    py::array_t<R> result(n);
+
+    const T* in = arr.data();
+    R* out = result.mutable_data();
+    {
+        py::gil_scoped_release release;
+        for (size_t i = 0; i < n; i++) {
+            out[i] = f(in[i]); }
+    }
+    return result;
+}
+
+
+// Same as map_array but for two arrays of equal length
+template <typename R = uint64_t, typename T1 = uint64_t, typename T2 = uint64_t,
+          typename F>
+inline py::array_t<R> map_arrays(const input_array<T1>& first,
+                                 const input_array<T2>& second, F f)
+{
+    detail::check_1d(first, "first");
+    detail::check_1d(second, "second");
+    if (first.shape(0) != second.shape(0)) {
+        throw std::invalid_argument("arrays should have equal length"); }
+
+    const auto n = static_cast<size_t>(first.shape(0));
+    py::array_t<R> result(n);
+
+    const T1* in1 = first.data();
+    const T2* in2 = second.data();
+    R* out = result.mutable_data();
+    {
+        py::gil_scoped_release release;
+        for (size_t i = 0; i < n; i++) {
+            out[i] = f(in1[i], in2[i]); }
+    }
+    return result;
+}
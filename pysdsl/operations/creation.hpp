@@ -1,18 +1,22 @@
 #pragma once
 
 #include <algorithm>
+#include <string>
 #include <utility>
 #include <tuple>
 #include <type_traits>
 
 #include <sdsl/vectors.hpp>
 #include <sdsl/construct.hpp>
+#include <sdsl/ram_fs.hpp>
 
 #include <pybind11/pybind11.h>
 
 #include "operations/iteration.hpp"
 #include "operations/sizes.hpp"
 #include "types/pysequence.hpp"
+#include "util/cache.hpp"
+#include "util/locking.hpp"
 #include "util/tupletricks.hpp"
 
 
@@ -55,6 +59,13 @@ using has_non_const_begin = decltype(has_non_const_begin_impl(
         std::declval<T*>()));
 
 
+// Types specialising in_memory_builder are built by
+// in_memory_builder<T>::build(first, last) straight from the source values
+// instead of sdsl::construct_im, which round-trips through a ram_fs image
+template <class T>
+struct in_memory_builder { static constexpr bool enabled = false; };
+
+
 struct construct_explicit { int value; };
 struct construct_iter { int value; };
 struct construct_copy_empty { int value; };
@@ -67,6 +78,9 @@ struct construct_copy_size { int value; };
 template <class T, class From,
     typename /* direct construction */ = typename std::enable_if<
             std::is_constructible<T, const From&>::value
+        >::type,
+    typename /* no in-memory builder */ = typename std::enable_if<
+            !detail::in_memory_builder<T>::enabled
         >::type>
 constexpr T construct_from(const From& obj,
                            detail::construct_explicit /* unused */ = {}) {
@@ -85,6 +99,9 @@ template <
                 decltype(detail::cbegin(std::declval<From>())),
                 decltype(detail::cend(std::declval<From>()))
             >::value
+        >::type,
+    typename /* no in-memory builder */ = typename std::enable_if<
+            !detail::in_memory_builder<T>::enabled
         >::type>
 constexpr T construct_from(const From& obj,
                            detail::construct_iter /* unused */ = {}) {
@@ -150,6 +167,31 @@ inline T construct_from(const From& obj,
     return result;
 }
 
+namespace detail
+{
+    // Same as sdsl::construct_im but stores `data` by reference, so the
+    // intermediate vector is not copied once more before being written
+    template <class T, class With>
+    inline void construct_im_ref(T& result, const With& data)
+    {
+        const std::string tmp_file = sdsl::ram_file_name(unique_file_id());
+        sdsl::store_to_file(data, tmp_file);
+        sdsl::construct(result, tmp_file, 0);
+        sdsl::ram_fs::remove(tmp_file);
+    }
+
+    template <class With, class T, class From>
+    inline void construct_im_from(T& result, const From& obj,
+                                  std::false_type /* From is With */) {
+        construct_im_ref(result, construct_from<With>(obj)); }
+
+    template <class With, class T, class From>
+    inline void construct_im_from(T& result, const From& obj,
+                                  std::true_type /* From is With */) {
+        construct_im_ref(result, obj); }
+}  // namespace detail
+
+
 // The only version of construct_from if T can only be constructed
 // via sdsl::construct_im
 template <
@@ -172,16 +214,31 @@ template <
         >::type,
     typename = typename std::enable_if<
             !detail::has_non_const_begin<T>::value
+        >::type,
+    typename = typename std::enable_if<
+            !detail::in_memory_builder<T>::enabled
         >::type>
 inline T construct_from(const From& obj)
 {
     T result;
-    sdsl::construct_im(result, construct_from<With>(obj));
+    detail::construct_im_from<With>(
+        result, obj, std::is_same<With, From>());
 
     return result;
 }
 
 
+// The only version of construct_from if T has an in-memory builder
+template <
+    class T, class From,
+    typename = typename std::enable_if<
+            detail::in_memory_builder<T>::enabled
+        >::type>
+inline T construct_from(const From& obj) {
+    return detail::in_memory_builder<T>::build(detail::cbegin(obj),
+                                               detail::cend(obj)); }
+
+
 namespace detail
 {
     template <class BindCls,
@@ -194,10 +251,13 @@ namespace detail
         template <typename InputCls>
         decltype(auto) operator()(const InputCls &)
         {
-            m_cls_to.def(py::init(
+            m_cls_to.def(py::init(locking::reading(
                 [] (const typename InputCls::type& from) {
-                    return construct_from<typename BindCls::type>(from); }),
+                    return construct_from<typename BindCls::type>(from); })),
                 py::arg("v"),
+                // ahead of the generic sequence constructor, which may
+                // already be bound by another extension module
+                py::prepend(),
                 py::call_guard<py::gil_scoped_release>());
             return m_cls_to;
         }
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/sd_vector.hpp>
+
+#include "operations/batch.hpp"
+#include "util/bits_kernels.hpp"
+#include "util/locking.hpp"
+
+
+namespace py = pybind11;
+
+
+namespace detail
+{
+    // words read from a vector at once
+    constexpr size_t scan_block = 256;
+
+    // Words [first, first + n) of the bits of v, the last word of v may
+    // hold less than 64 bits
+    template <class T>
+    inline void read_words(const T& v, uint64_t first, size_t n,
+                           uint64_t* out)
+    {
+        const uint64_t size = v.size();
+        for (size_t k = 0; k < n; k++) {
+            const uint64_t idx = (first + k) * 64;
+            out[k] = v.get_int(idx, uint8_t(std::min<uint64_t>(64,
+                                                               size - idx)));
+        }
+    }
+
+    inline void read_words(const sdsl::int_vector<1>& v, uint64_t first,
+                           size_t n, uint64_t* out)
+    {
+        std::copy(v.data() + first, v.data() + first + n, out);
+    }
+
+
+    // Appends the positions of the set (or, with `zeros`, unset) bits in
+    // [pos, stop) of v to `out`, at most `room` of them, and returns the
+    // position the scan stopped at. Takes whole words, so room should be
+    // at least 64.
+    template <class T>
+    inline uint64_t scan_words(const T& v, uint64_t pos, uint64_t stop,
+                               bool zeros, size_t room,
+                               std::vector<uint64_t>& out)
+    {
+        uint64_t words[scan_block];
+        const uint64_t end_word = (stop + 63) / 64;
+        while (pos < stop && room) {
+            const uint64_t first = pos / 64;
+            const size_t n = std::min<uint64_t>(scan_block, end_word - first);
+            read_words(v, first, n, words);
+            if (zeros) {
+                for (size_t k = 0; k < n; k++) words[k] = ~words[k]; }
+            words[0] &= ~sdsl::bits::lo_set[pos % 64];
+            if (first + n == end_word && stop % 64) {
+                words[n - 1] &= sdsl::bits::lo_set[stop % 64]; }
+
+            size_t take = 0;
+            size_t found = 0;
+            for (; take < n; take++) {
+                const size_t c = sdsl::bits::cnt(words[take]);
+                if (found + c > room) break;
+                found += c;
+            }
+            if (!take) break;
+
+            const size_t old = out.size();
+            out.resize(old + found + bits_kernels::ones_slack);
+            bits_kernels::ones().run(words, take, first * 64,
+                                     out.data() + old);
+            out.resize(old + found);
+            room -= found;
+            pos = std::min(stop, (first + take) * 64);
+        }
+        return pos;
+    }
+
+    template <class T>
+    inline uint64_t scan_bits(const T& v, uint64_t pos, uint64_t stop,
+                              bool zeros, size_t room,
+                              std::vector<uint64_t>& out)
+    {
+        return scan_words(v, pos, stop, zeros, room, out);
+    }
+
+    // Set bits of an sd_vector are walked by select, without touching the
+    // runs of zeros between them
+    template <class... P>
+    inline uint64_t scan_bits(const sdsl::sd_vector<P...>& v, uint64_t pos,
+                              uint64_t stop, bool zeros, size_t room,
+                              std::vector<uint64_t>& out)
+    {
+        if (zeros) return scan_words(v, pos, stop, zeros, room, out);
+        typename sdsl::sd_vector<P...>::rank_1_type rank(&v);
+        typename sdsl::sd_vector<P...>::select_1_type select(&v);
+        const uint64_t ones = rank.rank(stop);
+        for (uint64_t i = rank.rank(pos); i < ones; i++) {
+            if (!room--) return out.back() + 1;
+            out.push_back(select.select(i + 1));
+        }
+        return stop;
+    }
+
+
+    // Set bits in [begin, end) of v
+    template <class T>
+    inline uint64_t count_ones(const T& v, uint64_t begin, uint64_t end)
+    {
+        typename T::rank_1_type rank(&v);
+        return rank.rank(end) - rank.rank(begin);
+    }
+
+    inline uint64_t count_ones(const sdsl::int_vector<1>& v, uint64_t begin,
+                               uint64_t end)
+    {
+        if (begin == end) return 0;
+        const uint64_t* data = v.data();
+        const uint64_t first = begin / 64;
+        const uint64_t last = (end - 1) / 64;
+        uint64_t result = bits_kernels::popcount().run(data + first,
+                                                       last - first + 1);
+        result -= sdsl::bits::cnt(data[first] &
+                                  sdsl::bits::lo_set[begin % 64]);
+        if (end % 64) {
+            result -= sdsl::bits::cnt(data[last] &
+                                      ~sdsl::bits::lo_set[end % 64]); }
+        return result;
+    }
+}  // namespace detail
+
+
+// Positions of the set (or unset) bits of a bit vector in [start, stop),
+// as numpy arrays of up to `chunk` positions. A mutable vector is locked
+// while a chunk is read, and `stop` is clipped to its length at that time.
+template <class T>
+class bit_positions
+{
+private:
+    const T& m_vector;
+    uint64_t m_pos;
+    uint64_t m_stop;
+    bool m_zeros;
+    size_t m_chunk;
+    std::unique_ptr<std::mutex> m_mutex;
+
+public:
+    bit_positions(const T& vector, uint64_t start, uint64_t stop, bool zeros,
+                  size_t chunk):
+        m_vector(vector),
+        m_pos(start),
+        m_stop(stop),
+        m_zeros(zeros),
+        m_chunk(chunk),
+        m_mutex(new std::mutex())
+    {
+        if (start > stop) {
+            throw std::invalid_argument("start should not exceed stop"); }
+        if (chunk < 64) {
+            throw std::invalid_argument("chunk should be at least 64"); }
+    }
+
+    py::array_t<uint64_t> next()
+    {
+        std::vector<uint64_t> found;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            locking::shared_guard<T> lock(m_vector);
+            const uint64_t stop = std::min<uint64_t>(m_stop,
+                                                     m_vector.size());
+            if (m_pos < stop) {
+                m_pos = detail::scan_bits(m_vector, m_pos, stop, m_zeros,
+                                          m_chunk, found); }
+        }
+        if (found.empty()) throw py::stop_iteration();
+        return detail::to_numpy(found);
+    }
+};
+
+
+template <class T>
+inline auto add_bit_enumeration(py::module& m, py::class_<T>& cls,
+                                const std::string& name)
+{
+    typedef bit_positions<T> P;
+
+    py::class_<P>(m, ("_BitPositionsOf" + name).c_str())
+        .def("__iter__", [] (py::object self) { return self; })
+        .def("__next__", &P::next);
+
+    const auto positions = [] (bool zeros) {
+        return [zeros] (const T& self, uint64_t start, py::object stop,
+                        size_t chunk) {
+            return P(self, start,
+                     stop.is_none() ? std::numeric_limits<uint64_t>::max()
+                                    : stop.cast<uint64_t>(),
+                     zeros, chunk); }; };
+
+    cls.def(
+        "ones",
+        positions(false),
+        py::arg("start") = 0, py::arg("stop") = py::none(),
+        py::arg("chunk") = 1 << 16,
+        "Iterates over the positions of the set bits in [start, stop) as "
+        "numpy arrays of up to `chunk` (>= 64) positions",
+        py::keep_alive<0, 1>());
+    cls.def(
+        "zeros",
+        positions(true),
+        py::arg("start") = 0, py::arg("stop") = py::none(),
+        py::arg("chunk") = 1 << 16,
+        "Iterates over the positions of the unset bits in [start, stop) as "
+        "numpy arrays of up to `chunk` (>= 64) positions",
+        py::keep_alive<0, 1>());
+    cls.def(
+        "ones_count_in_range",
+        locking::reading([] (const T& self, uint64_t begin, uint64_t end) {
+            if (end > self.size()) {
+                throw std::out_of_range(std::to_string(end)); }
+            if (begin > end) {
+                throw std::invalid_argument(
+                    "begin should not exceed end"); }
+            return detail::count_ones(self, begin, end); }),
+        py::arg("begin"), py::arg("end"),
+        "Number of set bits in [begin, end)",
+        py::call_guard<py::gil_scoped_release>());
+
+    return cls;
+}
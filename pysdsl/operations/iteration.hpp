@@ -1,7 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+
 #include "operations/sizes.hpp"
 #include "util/indexiterator.hpp"
+#include "util/locking.hpp"
+
+
+namespace py = pybind11;
 
 
 namespace detail
@@ -52,8 +64,86 @@ namespace detail
 }  // namespace detail
 
 
-template <class Sequence>
-inline auto add_iteration(py::class_<Sequence>& cls)
+namespace detail
+{
+    // Iterates over a mutable sequence by chunks copied under its lock, so
+    // that it may be resized or assigned meanwhile: every chunk is read as
+    // the sequence is at that time and iteration stops at its length then.
+    // Buffered elements are returned without locking; the GIL is only
+    // released, and the sequence locked, to read the next chunk.
+    template <class Sequence, typename T>
+    class locked_iterator
+    {
+    private:
+        static constexpr size_t chunk = 1024;
+
+        const Sequence& m_sequence;
+        size_t m_next;  // index of the first element not read yet
+        std::vector<T> m_buffer;
+        size_t m_taken;  // elements of m_buffer returned
+        // orders chunk reads, guards m_next (and the buffer without GIL)
+        std::unique_ptr<std::mutex> m_mutex;
+
+    public:
+        explicit locked_iterator(const Sequence& sequence):
+            m_sequence(sequence),
+            m_next(0),
+            m_taken(0),
+            m_mutex(new std::mutex())
+        {}
+
+        T next()
+        {
+#ifdef Py_GIL_DISABLED
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            if (m_taken == m_buffer.size()) append(read_chunk());
+#else
+            // The GIL guards the buffer. The mutex is taken without it and
+            // kept until the chunk is appended, so concurrent refills
+            // append their chunks in order.
+            if (m_taken == m_buffer.size()) {
+                std::unique_lock<std::mutex> lock(*m_mutex, std::defer_lock);
+                std::vector<T> values;
+                {
+                    py::gil_scoped_release release;
+                    lock.lock();
+                    values = read_chunk();
+                }
+                append(values);
+            }
+#endif
+            if (m_taken == m_buffer.size()) throw py::stop_iteration();
+            return m_buffer[m_taken++];
+        }
+
+    private:
+        std::vector<T> read_chunk()
+        {
+            locking::shared_guard<Sequence> lock(m_sequence);
+            const size_t end = std::min<size_t>(size(m_sequence),
+                                                m_next + chunk);
+            std::vector<T> values;
+            for (size_t i = m_next; i < end; i++) {
+                values.push_back(m_sequence[i]); }
+            m_next = std::max(m_next, end);
+            return values;
+        }
+
+        void append(const std::vector<T>& values)
+        {
+            if (m_taken == m_buffer.size()) {
+                m_buffer.clear();
+                m_taken = 0;
+            }
+            m_buffer.insert(m_buffer.end(), values.begin(), values.end());
+        }
+    };
+}  // namespace detail
+
+
+template <class Sequence, typename T>
+inline auto add_iteration(py::class_<Sequence>& cls,
+                          std::false_type /* mutable */)
 {
     return cls.def(
         "__iter__",
@@ -63,3 +153,28 @@ inline auto add_iteration(py::class_<Sequence>& cls)
         py::keep_alive<0, 1>()
     );
 }
+
+
+template <class Sequence, typename T>
+inline auto add_iteration(py::class_<Sequence>& cls,
+                          std::true_type /* mutable */)
+{
+    typedef detail::locked_iterator<Sequence, T> I;
+
+    py::class_<I>(cls, "_Iterator")
+        .def("__iter__", [] (py::object self) { return self; })
+        .def("__next__", &I::next);
+
+    return cls.def(
+        "__iter__",
+        [](const Sequence &sequence) { return I(sequence); },
+        py::keep_alive<0, 1>()
+    );
+}
+
+
+template <class Sequence, typename T = typename Sequence::value_type>
+inline auto add_iteration(py::class_<Sequence>& cls)
+{
+    return add_iteration<Sequence, T>(cls, locking::is_mutable<Sequence>());
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sdsl/suffix_arrays.hpp>
+#include <sdsl/wt_algorithm.hpp>
+
+
+// Query operations measured by the benchmarks, shared by the native loops
+// of pysdsl._bench and the Google Benchmark target in benchmarks/native.
+// Every operation returns an integer folded into a checksum so that the
+// compiler can not drop the calls.
+namespace queries
+{
+    struct access
+    {
+        template <class T>
+        uint64_t operator()(const T& v, uint64_t i) const { return v[i]; }
+    };
+
+    // rank and select supports are both called with a single argument
+    struct support_call
+    {
+        template <class S>
+        uint64_t operator()(const S& support, uint64_t i) const {
+            return support(i); }
+    };
+
+    struct wt_rank
+    {
+        template <class T>
+        uint64_t operator()(const T& wt, uint64_t i, uint64_t c) const {
+            return wt.rank(i, c); }
+    };
+
+    struct wt_select
+    {
+        template <class T>
+        uint64_t operator()(const T& wt, uint64_t k, uint64_t c) const {
+            return wt.select(k, c); }
+    };
+
+    struct quantile_freq
+    {
+        template <class T>
+        uint64_t operator()(const T& wt, uint64_t lb, uint64_t rb,
+                            uint64_t q) const {
+            const auto result = sdsl::quantile_freq(wt, lb, rb, q);
+            return result.first + result.second; }
+    };
+
+    struct csa_count
+    {
+        template <class T>
+        uint64_t operator()(const T& csa, const std::string& pattern) const {
+            return sdsl::count(csa, pattern.begin(), pattern.end()); }
+    };
+
+    struct csa_locate
+    {
+        template <class T>
+        uint64_t operator()(const T& csa, const std::string& pattern) const {
+            return sdsl::locate(csa, pattern.begin(), pattern.end()).size(); }
+    };
+
+    struct csa_extract
+    {
+        template <class T>
+        uint64_t operator()(const T& csa, uint64_t begin,
+                            uint64_t end) const {
+            return sdsl::extract(csa, begin, end).size(); }
+    };
+
+
+    struct loop_result
+    {
+        uint64_t nanoseconds;
+        uint64_t checksum;
+    };
+
+
+    // Calls op(obj, args[i]...) for every i in [0..n) and measures the
+    // whole loop
+    template <class T, class Op, class... Args>
+    inline loop_result run(const T& obj, Op op, size_t n,
+                           const Args*... args)
+    {
+        uint64_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++) checksum += op(obj, args[i]...);
+        const auto stop = std::chrono::steady_clock::now();
+        return {static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        stop - start).count()),
+                checksum};
+    }
+}  // namespace queries
@@ -3,6 +3,8 @@
 #include <pybind11/pybind11.h>
 #include <sdsl/bit_vectors.hpp>
 
+#include "util/locking.hpp"
+
 
 namespace py = pybind11;
 
@@ -56,12 +58,14 @@ inline auto add_sizes(py::class_<Sequence>& cls)
 {
     add_max_size(cls);
 
-    auto size = [] (const Sequence& self) {
-        return detail::size(self); };
+    auto size = locking::reading([] (const Sequence& self) {
+        return detail::size(self); });
 
     cls.def("__len__", size,
-            "The number of elements in the container.");
+            "The number of elements in the container.",
+            py::call_guard<py::gil_scoped_release>());
     cls.def_property_readonly("size", size,
-                              "The number of elements in the container.");
+                              "The number of elements in the container.",
+                              py::call_guard<py::gil_scoped_release>());
     return cls;
 }
@@ -0,0 +1,96 @@
+"""Opt-in call counters and latency histograms of hot pysdsl methods.
+
+    import pysdsl.stats
+
+    pysdsl.stats.enable()
+    ...
+    for name, s in pysdsl.stats.snapshot().items():
+        print(name, s["calls"], s["p99_ns"])
+
+Element access, scans (`sum`, `max`, ...), rank/select supports, wavelet
+tree rank/select and suffix array count/locate/extract are instrumented.
+Every thread records into its own counters without locks; while disabled
+(the default) an instrumented call only checks a flag.
+"""
+
+import contextlib
+
+from pysdsl import _stats
+
+
+PERCENTILES = {"p50_ns": 50, "p90_ns": 90, "p99_ns": 99, "p999_ns": 99.9}
+
+
+def enable():
+    _stats.enable()
+
+
+def disable():
+    _stats.disable()
+
+
+def is_enabled():
+    return _stats.is_enabled()
+
+
+def reset():
+    """Zeroes all counters. Calls running concurrently may be lost."""
+    _stats.reset()
+
+
+@contextlib.contextmanager
+def collecting(reset_first=True):
+    """Enables instrumentation for the duration of a `with` block"""
+    if reset_first:
+        reset()
+    was_enabled = is_enabled()
+    enable()
+    try:
+        yield
+    finally:
+        if not was_enabled:
+            disable()
+
+
+def percentile(histogram, q):
+    """Lower bound of the histogram bucket holding the q-th percentile;
+    histogram is a sorted list of (bucket lower bound, count)"""
+    total = sum(count for _, count in histogram)
+    if not total:
+        return 0
+    rank = q / 100.0 * total
+    seen = 0
+    for bound, count in histogram:
+        seen += count
+        if seen >= rank:
+            return bound
+    return histogram[-1][0]
+
+
+def snapshot():
+    """Counters of every instrumented method called since the last reset,
+    summed over threads, keyed by "ClassName.method":
+
+        calls, elements, total_ns, mean_ns, max_ns,
+        p50_ns, p90_ns, p99_ns, p999_ns,
+        histogram: {bucket lower bound in ns: number of calls}
+
+    Histogram buckets are log-linear: latencies are within 12.5% of their
+    bucket's lower bound. Only methods of loaded pysdsl families appear.
+    """
+    result = {}
+    for name, raw in _stats.raw_snapshot().items():
+        calls, elements, total_ns, max_ns, histogram = raw
+        if not calls:
+            continue
+        histogram = sorted(histogram)
+        record = {"calls": calls,
+                  "elements": elements,
+                  "total_ns": total_ns,
+                  "mean_ns": total_ns / calls,
+                  "max_ns": max_ns,
+                  "histogram": dict(histogram)}
+        for key, q in PERCENTILES.items():
+            record[key] = percentile(histogram, q)
+        result[name] = record
+    return result
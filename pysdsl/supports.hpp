@@ -2,6 +2,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 
 #include <sdsl/bit_vectors.hpp>
 
@@ -9,6 +10,8 @@
 
 #include "docstrings.hpp"
 #include "io.hpp"
+#include "util/locking.hpp"
+#include "util/stats.hpp"
 
 
 namespace py = pybind11;
@@ -30,10 +33,62 @@ public:
     auto size() const { return m_vec.size(); }
     auto operator()(size_t idx) const { return m_support(idx); }
 
+    const sdsl::bit_vector& vector() const { return m_vec; }
+
     operator const T&() const { return m_support; }
 };
 
 
+namespace detail
+{
+    // The BitVector a rank support of sdsl::rank_support's hierarchy was
+    // initialized with, kept in its protected member
+    struct rank_support_vector: sdsl::rank_support
+    {
+        static const sdsl::bit_vector& of(const sdsl::rank_support& support)
+        {
+            return *(support.*(&rank_support_vector::m_v));
+        }
+    };
+
+
+    // Holds the lock of the BitVector a support queries, shared. Supports
+    // of the immutable compressed vectors need none.
+    template <class Base,
+              bool = std::is_base_of<sdsl::rank_support, Base>::value>
+    class support_guard
+    {
+    public:
+        static constexpr bool locks = false;
+        explicit support_guard(const Base&) {}
+    };
+
+    template <class Base>
+    class support_guard<Base, true>
+    {
+    private:
+        locking::shared_guard<sdsl::bit_vector> m_lock;
+    public:
+        static constexpr bool locks = true;
+        explicit support_guard(const Base& support):
+            m_lock(rank_support_vector::of(support))
+        {}
+    };
+
+    template <class T>
+    class support_guard<support_helper<T>, false>
+    {
+    private:
+        locking::shared_guard<sdsl::bit_vector> m_lock;
+    public:
+        static constexpr bool locks = true;
+        explicit support_guard(const support_helper<T>& support):
+            m_lock(support.vector())
+        {}
+    };
+}  // namespace detail
+
+
 template <class Base>
 inline
 auto add_support_class(py::module &m,
@@ -44,12 +99,17 @@ auto add_support_class(py::module &m,
 {
     auto cls = py::class_<Base>(m, name.c_str());
 
+    if (detail::support_guard<Base>::locks) locking::table();
+
     cls.def(
         method_name.c_str(),
-        [](const Base& self, size_t idx) {
-            if (idx >= self.size()) {
-                throw std::out_of_range(std::to_string(idx)); }
-            return self(idx); },
+        stats::timed(cls, method_name,
+            [](const Base& self, size_t idx) {
+                // the supported vector is kept alive by the support
+                detail::support_guard<Base> lock(self);
+                if (idx >= self.size()) {
+                    throw std::out_of_range(std::to_string(idx)); }
+                return self(idx); }),
         py::call_guard<py::gil_scoped_release>(),
         py::arg("idx"),
         doc_call.c_str());
@@ -71,11 +131,11 @@ decltype(auto) bind_support(const S*,
 {
     cls.def(
         call_name.c_str(),
-        [](T& self) {
+        locking::reading([](T& self) {
             S support;
             sdsl::util::init_support(support, &self);
 
-            return support; },
+            return support; }),
         py::keep_alive<0, 1>());
 
     if (alt_name) cls.attr(alt_name) = cls.attr(call_name.c_str());
@@ -92,11 +152,11 @@ decltype(auto) bind_support(const support_helper<S>*,
 {
     cls.def(
         call_name.c_str(),
-        [](T& self) {
+        locking::reading([](T& self) {
             S support;
             sdsl::util::init_support(support, &self);
 
-            return support_helper<S>(self, std::move(support)); },
+            return support_helper<S>(self, std::move(support)); }),
         py::keep_alive<0, 1>() );
 
     if (alt_name) cls.attr(alt_name) = cls.attr(call_name.c_str());
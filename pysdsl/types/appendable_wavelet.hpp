@@ -0,0 +1,435 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sdsl/wavelet_trees.hpp>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "docstrings.hpp"
+#include "operations/batch.hpp"
+#include "operations/sizes.hpp"
+#include "types/wavelet.hpp"
+#include "types/wavelet_build.hpp"
+#include "util/locking.hpp"
+#include "util/stats.hpp"
+
+
+namespace py = pybind11;
+
+
+// Wavelet matrix which grows at the end. Appended values go to a tail
+// buffer indexed by value; a full tail becomes a static segment
+// (sdsl::wm_int) and the last segments are merged while the one before is
+// less than twice as large as the last, log-structured: there are
+// O(log(n / tail_capacity)) segments and every value is rebuilt
+// O(log(n / tail_capacity)) times. Queries combine the segments and the
+// tail.
+class appendable_wavelet_matrix
+{
+public:
+    typedef sdsl::wm_int<> segment_type;
+    typedef uint64_t size_type;
+    typedef uint64_t value_type;
+
+private:
+    std::vector<std::unique_ptr<segment_type>> m_segments;
+    // position of the first value of every segment
+    std::vector<size_type> m_starts;
+    size_type m_segments_size = 0;
+
+    std::vector<value_type> m_tail;
+    // positions within the tail of every value in it
+    std::unordered_map<value_type, std::vector<size_type>> m_tail_positions;
+
+    size_type m_tail_capacity;
+    size_t m_threads;
+
+    template <class Get>
+    std::unique_ptr<segment_type> build(size_type n, Get get) const
+    {
+        return std::unique_ptr<segment_type>(new segment_type(
+            detail::parallel_build<wm_int_parallel_builder<>>(n, get,
+                                                              m_threads)));
+    }
+
+    void push_segment(std::unique_ptr<segment_type> segment)
+    {
+        m_starts.push_back(m_segments_size);
+        m_segments_size += segment->size();
+        m_segments.push_back(std::move(segment));
+    }
+
+    void merge_last()
+    {
+        while (m_segments.size() >= 2 &&
+               m_segments[m_segments.size() - 2]->size() <
+               2 * m_segments.back()->size()) {
+            std::unique_ptr<segment_type> right = std::move(m_segments.back());
+            m_segments.pop_back();
+            m_starts.pop_back();
+            const segment_type& left = *m_segments.back();
+            const size_type split = left.size();
+            m_segments.back() = build(
+                split + right->size(),
+                [&left, &right, split] (size_t i) -> uint64_t {
+                    return i < split ? left[i] : (*right)[i - split]; });
+        }
+    }
+
+    void clear_tail()
+    {
+        m_tail.clear();
+        m_tail_positions.clear();
+    }
+
+    // Segment holding position i < m_segments_size
+    size_t segment_of(size_type i) const
+    {
+        return std::upper_bound(m_starts.begin(), m_starts.end(), i) -
+               m_starts.begin() - 1;
+    }
+
+    static value_type max_value(const segment_type& segment)
+    {
+        return segment.max_level >= 64 ?
+            ~value_type(0) : (value_type(1) << segment.max_level) - 1;
+    }
+
+public:
+    explicit appendable_wavelet_matrix(size_type tail_capacity = 1 << 14,
+                                       size_t threads = 1):
+        m_tail_capacity(std::max<size_type>(tail_capacity, 1)),
+        m_threads(threads)
+    {}
+
+    appendable_wavelet_matrix(const segment_type& base,
+                              size_type tail_capacity = 1 << 14,
+                              size_t threads = 1):
+        appendable_wavelet_matrix(tail_capacity, threads)
+    {
+        if (base.size()) {
+            push_segment(std::unique_ptr<segment_type>(
+                new segment_type(base))); }
+    }
+
+    size_type size() const { return m_segments_size + m_tail.size(); }
+
+    size_type tail_size() const { return m_tail.size(); }
+
+    std::vector<size_type> segment_sizes() const
+    {
+        std::vector<size_type> result;
+        for (const auto& segment: m_segments) {
+            result.push_back(segment->size()); }
+        return result;
+    }
+
+    void append(value_type value)
+    {
+        m_tail_positions[value].push_back(m_tail.size());
+        m_tail.push_back(value);
+        if (m_tail.size() >= m_tail_capacity) flush();
+    }
+
+    // Appends n values; a batch filling the tail becomes one segment
+    // together with the tail
+    void append(const value_type* values, size_type n)
+    {
+        if (m_tail.size() + n < m_tail_capacity) {
+            for (size_type i = 0; i < n; i++) append(values[i]);
+            return; }
+        const size_type tail = m_tail.size();
+        push_segment(build(tail + n, [this, values, tail] (size_t i) {
+            return i < tail ? m_tail[i] : values[i - tail]; }));
+        clear_tail();
+        merge_last();
+    }
+
+    // Turns the tail into a segment
+    void flush()
+    {
+        if (m_tail.empty()) return;
+        push_segment(build(m_tail.size(), [this] (size_t i) {
+            return m_tail[i]; }));
+        clear_tail();
+        merge_last();
+    }
+
+    // Single wavelet matrix over all values
+    segment_type to_wavelet_matrix() const
+    {
+        return detail::parallel_build<wm_int_parallel_builder<>>(
+            size(), [this] (size_t i) { return (*this)[i]; }, m_threads);
+    }
+
+    // Merges everything into one segment
+    void compact()
+    {
+        if (m_segments.size() == 1 && m_tail.empty()) return;
+        std::unique_ptr<segment_type> all(
+            new segment_type(to_wavelet_matrix()));
+        m_segments.clear();
+        m_starts.clear();
+        m_segments_size = 0;
+        clear_tail();
+        if (all->size()) push_segment(std::move(all));
+    }
+
+    value_type operator[](size_type i) const
+    {
+        if (i >= m_segments_size) return m_tail[i - m_segments_size];
+        const size_t k = segment_of(i);
+        return (*m_segments[k])[i - m_starts[k]];
+    }
+
+    // Number of values c in [0..i)
+    size_type rank(size_type i, value_type c) const
+    {
+        size_type result = 0;
+        for (size_t k = 0; k < m_segments.size() && m_starts[k] < i; k++) {
+            const auto& segment = *m_segments[k];
+            result += segment.rank(
+                std::min<size_type>(i - m_starts[k], segment.size()), c); }
+        if (i > m_segments_size) {
+            auto found = m_tail_positions.find(c);
+            if (found != m_tail_positions.end()) {
+                result += std::lower_bound(
+                    found->second.begin(), found->second.end(),
+                    i - m_segments_size) - found->second.begin(); } }
+        return result;
+    }
+
+    // Position of the k-th (1-based) value c
+    size_type select(size_type k, value_type c) const
+    {
+        if (k >= 1) {
+            for (size_t s = 0; s < m_segments.size(); s++) {
+                const auto& segment = *m_segments[s];
+                const size_type count = segment.rank(segment.size(), c);
+                if (k <= count) return m_starts[s] + segment.select(k, c);
+                k -= count; }
+            auto found = m_tail_positions.find(c);
+            if (found != m_tail_positions.end() &&
+                k <= found->second.size()) {
+                return m_segments_size + found->second[k - 1]; }
+        }
+        throw std::invalid_argument(
+            "there are less than k occurrences of c");
+    }
+
+    // Points of [lb..rb] with values in [vlb..vrb]: returns their number
+    // and reports at most `limit` of them (0 means all) if `report`
+    size_type range_search_2d(size_type lb, size_type rb, value_type vlb,
+                              value_type vrb, bool report, size_type limit,
+                              std::vector<uint64_t>& indices,
+                              std::vector<uint64_t>& values) const
+    {
+        auto full = [&] () { return limit && indices.size() >= limit; };
+        // points are appended as they are found, up to the limit
+        auto append = [&] (uint64_t index, uint64_t value) {
+            indices.push_back(index);
+            values.push_back(value);
+            return !full(); };
+        size_type count = 0;
+        for (size_t k = 0; k < m_segments.size(); k++) {
+            const auto& segment = *m_segments[k];
+            const size_type start = m_starts[k];
+            const size_type end = start + segment.size() - 1;
+            if (end < lb || start > rb || vlb > max_value(segment)) continue;
+            const size_type l = std::max(lb, start) - start;
+            const size_type r = std::min(rb, end) - start;
+            const value_type v = std::min(vrb, max_value(segment));
+            count += segment.range_search_2d(l, r, vlb, v, false).first;
+            if (!report || full()) continue;
+            const size_t first = indices.size();
+            detail::for_each_point_2d(segment, segment.root(),
+                                      sdsl::range_type{l, r}, vlb, v, append);
+            for (size_t i = first; i < indices.size(); i++) {
+                indices[i] += start; }
+        }
+        for (size_type i = std::max(lb, m_segments_size); i <= rb; i++) {
+            const value_type value = m_tail[i - m_segments_size];
+            if (value < vlb || value > vrb) continue;
+            count++;
+            if (report && !full()) {
+                indices.push_back(i);
+                values.push_back(value); }
+        }
+        return count;
+    }
+
+    size_type size_in_bytes() const
+    {
+        size_type result = sizeof(*this) +
+                           m_tail.capacity() * sizeof(value_type);
+        for (const auto& positions: m_tail_positions) {
+            result += sizeof(positions) +
+                      positions.second.capacity() * sizeof(size_type); }
+        for (const auto& segment: m_segments) {
+            result += sdsl::size_in_bytes(*segment); }
+        return result;
+    }
+};
+
+
+namespace locking
+{
+    template <>
+    struct is_mutable<appendable_wavelet_matrix>: std::true_type {};
+}  // namespace locking
+
+
+inline auto add_appendable_wavelet_matrix(py::module& m)
+{
+    typedef appendable_wavelet_matrix T;
+    typedef T::size_type size_type;
+    typedef T::value_type value_type;
+
+    auto cls = py::class_<T>(m, "AppendableWaveletMatrixInt");
+
+    cls.def(py::init<size_type, size_t>(),
+            py::arg("tail_capacity") = 1 << 14, py::arg("threads") = 1,
+            "Empty matrix. Segments are built on `threads` threads (0 means "
+            "all hardware threads).");
+    cls.def(py::init<const T::segment_type&, size_type, size_t>(),
+            py::arg("base"), py::arg("tail_capacity") = 1 << 14,
+            py::arg("threads") = 1,
+            "Starts with a copy of a WaveletMatrixInt as its first segment.",
+            py::call_guard<py::gil_scoped_release>());
+
+    add_sizes(cls);
+
+    cls.def_property_readonly(
+        "tail_size",
+        locking::reading([] (const T& self) { return self.tail_size(); }),
+        "Number of values not yet merged into a segment",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def_property_readonly(
+        "segments",
+        locking::reading([] (const T& self) { return self.segment_sizes(); }),
+        "Sizes of the static segments, oldest first",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "size_in_bytes",
+        locking::reading([] (const T& self) { return self.size_in_bytes(); }),
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.def(
+        "append",
+        locking::writing([] (T& self, value_type value) {
+            self.append(value); }),
+        py::arg("value"),
+        "Appends a value: amortized Order(log(n) * log(sigma)), a full "
+        "tail is built into a segment and merged",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "extend",
+        [] (T& self, const input_array<uint64_t>& values) {
+            detail::check_1d(values, "values");
+            const uint64_t* data = values.data();
+            const size_type n = values.shape(0);
+            py::gil_scoped_release release;
+            locking::unique_guard<T> guard(self);
+            self.append(data, n); },
+        py::arg("values"),
+        "Appends an array of values; a batch which fills the tail is built "
+        "into one segment at once");
+    cls.def(
+        "flush",
+        locking::writing([] (T& self) { self.flush(); }),
+        "Builds the tail into a segment",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "compact",
+        locking::writing([] (T& self) { self.compact(); }),
+        "Merges all segments and the tail into one segment",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "to_wavelet_matrix",
+        locking::reading([] (const T& self) {
+            return self.to_wavelet_matrix(); }),
+        "WaveletMatrixInt of all values",
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.def(
+        "__getitem__",
+        stats::timed(cls, "__getitem__", locking::reading(
+            [] (const T& self, int64_t i) {
+                if (i < 0) i += self.size();
+                if (i < 0 || size_type(i) >= self.size()) {
+                    throw std::out_of_range(std::to_string(i)); }
+                return self[i]; })),
+        py::arg("i"),
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "rank",
+        stats::timed(cls, "rank", locking::reading(
+            [] (const T& self, size_type i, value_type c) {
+                if (i > self.size()) {
+                    throw std::out_of_range(std::to_string(i)); }
+                return self.rank(i, c); })),
+        py::arg("i"), py::arg("c"),
+        "Calculates how many values c are in the prefix [0..i-1] "
+        "(i in [0..size]).\nTime complexity: "
+        "Order(segments * log(|Sigma|) + log(tail))",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "select",
+        stats::timed(cls, "select", locking::reading(
+            [] (const T& self, size_type k, value_type c) {
+                return self.select(k, c); })),
+        py::arg("k"), py::arg("c"),
+        "Calculates the k-th (1-based) occurrence of the value c.\n"
+        "Time complexity: Order(segments * log(|Sigma|))",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "range_search_2d",
+        [] (const T& self, size_type lb, size_type rb,
+            value_type vlb, value_type vrb, bool report, size_type limit)
+        {
+            size_type count;
+            std::vector<uint64_t> indices, values;
+            {
+                py::gil_scoped_release release;
+                locking::shared_guard<T> guard(self);
+                detail::check_range_2d(self, lb, rb, vlb, vrb);
+                count = self.range_search_2d(lb, rb, vlb, vrb, report, limit,
+                                             indices, values);
+            }
+            return std::make_tuple(count, detail::to_numpy(indices),
+                                   detail::to_numpy(values));
+        },
+        py::arg("lb"), py::arg("rb"), py::arg("vlb"), py::arg("vrb"),
+        py::arg("report") = true, py::arg("limit") = 0,
+        "searches points in the index interval [lb..rb] and "
+        "value interval [vlb..vrb] of all segments and the tail, see "
+        "WaveletMatrixInt.range_search_2d. Points are reported segment by "
+        "segment.");
+    cls.def(
+        "range_count_2d",
+        locking::reading(
+            [] (const T& self, size_type lb, size_type rb,
+                value_type vlb, value_type vrb) {
+                detail::check_range_2d(self, lb, rb, vlb, vrb);
+                std::vector<uint64_t> indices, values;
+                return self.range_search_2d(lb, rb, vlb, vrb, false, 0,
+                                            indices, values); }),
+        py::arg("lb"), py::arg("rb"), py::arg("vlb"), py::arg("vrb"),
+        "Number of points in the index interval [lb..rb] and value "
+        "interval [vlb..vrb].",
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.doc() = doc_appendable_wavelet_matrix;
+
+    return cls;
+}
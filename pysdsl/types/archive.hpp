@@ -0,0 +1,447 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+
+#include "docstrings.hpp"
+#include "util/locking.hpp"
+#include "util/parallel.hpp"
+
+
+namespace py = pybind11;
+
+
+// Block-compressed int_vector files.
+//
+// The payload words of the vector are cut into blocks of `block_words`
+// words, each compressed on its own, so a value is read by decompressing
+// only the one or two blocks holding it. Layout (native byte order):
+// header, offsets of the blocks[blocks + 1] relative to the first block,
+// compressed blocks.
+namespace archive
+{
+    enum class codec: uint32_t { zstd = 1, lz4 = 2 };
+
+    struct header
+    {
+        char magic[8];
+        uint32_t codec;
+        uint32_t width;
+        uint64_t size;
+        uint64_t block_words;
+        uint64_t words;
+        uint64_t blocks;
+    };
+
+    constexpr char magic[8] = {'S', 'D', 'S', 'L', 'A', 'R', 'C', '1'};
+
+
+    inline codec parse_codec(const std::string& name)
+    {
+        if (name == "zstd") return codec::zstd;
+        if (name == "lz4") return codec::lz4;
+        throw std::invalid_argument("unknown codec " + name);
+    }
+
+
+    inline std::string codec_name(codec c)
+    {
+        return c == codec::zstd ? "zstd" : "lz4";
+    }
+
+
+    // Largest uncompressed block a codec takes, lz4 sizes are ints
+    inline uint64_t max_block_bytes(codec c)
+    {
+        return c == codec::lz4 ? LZ4_MAX_INPUT_SIZE : UINT64_MAX;
+    }
+
+
+    inline std::string compress(codec c, int level, const uint64_t* words,
+                                uint64_t n)
+    {
+        const size_t bytes = n * sizeof(uint64_t);
+        std::string result;
+        if (c == codec::zstd) {
+            result.resize(ZSTD_compressBound(bytes));
+            const size_t size = ZSTD_compress(&result[0], result.size(),
+                                              words, bytes, level);
+            if (ZSTD_isError(size)) {
+                throw std::runtime_error(ZSTD_getErrorName(size)); }
+            result.resize(size);
+        } else {
+            result.resize(LZ4_compressBound(int(bytes)));
+            const int size = LZ4_compress_default(
+                reinterpret_cast<const char*>(words), &result[0],
+                int(bytes), int(result.size()));
+            if (size <= 0) throw std::runtime_error("lz4 compression failed");
+            result.resize(size);
+        }
+        return result;
+    }
+
+
+    inline void decompress(codec c, const std::string& data, uint64_t* words,
+                           uint64_t n)
+    {
+        const size_t bytes = n * sizeof(uint64_t);
+        bool ok;
+        if (c == codec::zstd) {
+            const size_t size = ZSTD_decompress(words, bytes, data.data(),
+                                                data.size());
+            ok = !ZSTD_isError(size) && size == bytes;
+        } else {
+            if (bytes > max_block_bytes(c) ||
+                data.size() > size_t(LZ4_compressBound(LZ4_MAX_INPUT_SIZE))) {
+                throw std::runtime_error("corrupted archive block"); }
+            const int size = LZ4_decompress_safe(
+                data.data(), reinterpret_cast<char*>(words),
+                int(data.size()), int(bytes));
+            ok = size >= 0 && size_t(size) == bytes;
+        }
+        if (!ok) throw std::runtime_error("corrupted archive block");
+    }
+
+
+    // Blocks are compressed concurrently on `threads` threads
+    template <class T>
+    inline void store(const T& v, const std::string& file_name, codec c,
+                      int level, uint64_t block_bytes, size_t threads)
+    {
+        if (block_bytes < sizeof(uint64_t)) {
+            throw std::invalid_argument(
+                "block_bytes should hold at least one word"); }
+        if (block_bytes > max_block_bytes(c)) {
+            throw std::invalid_argument(
+                "block_bytes should not exceed " +
+                std::to_string(max_block_bytes(c)) + " for " +
+                codec_name(c)); }
+        const uint64_t block_words = block_bytes / sizeof(uint64_t);
+        const uint64_t words = (v.bit_size() + 63) / 64;
+        const uint64_t blocks = (words + block_words - 1) / block_words;
+
+        std::vector<std::string> compressed(blocks);
+        parallel_for_each_index(blocks, threads, [&] (size_t k) {
+            const uint64_t first = k * block_words;
+            compressed[k] = compress(
+                c, level, v.data() + first,
+                std::min(words, first + block_words) - first); });
+
+        header h;
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.codec = uint32_t(c);
+        h.width = v.width();
+        h.size = v.size();
+        h.block_words = block_words;
+        h.words = words;
+        h.blocks = blocks;
+        std::vector<uint64_t> offsets(1, 0);
+        for (const auto& block: compressed) {
+            offsets.push_back(offsets.back() + block.size()); }
+
+        std::ofstream out(file_name, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(offsets.data()),
+                  offsets.size() * sizeof(uint64_t));
+        for (const auto& block: compressed) out.write(block.data(),
+                                                      block.size());
+        if (!out.good()) throw std::runtime_error("cannot write " + file_name);
+    }
+}  // namespace archive
+
+
+// Read-only int_vector in a block-compressed file. Only the block offsets
+// are loaded; blocks are read and decompressed on access and the last
+// `cache_blocks` of them are kept in an LRU cache.
+class archived_int_vector
+{
+public:
+    typedef uint64_t size_type;
+    typedef uint64_t value_type;
+
+private:
+    typedef std::shared_ptr<const std::vector<uint64_t>> block_ptr;
+
+    archive::header m_header;
+    std::vector<uint64_t> m_offsets;
+    uint64_t m_data_start;
+    size_t m_cache_blocks;
+
+    // the stream is shared by readers, the cache by everybody
+    mutable std::mutex m_file_mutex;
+    mutable std::ifstream m_file;
+    mutable std::mutex m_cache_mutex;
+    mutable std::list<std::pair<uint64_t, block_ptr>> m_lru;
+    mutable std::unordered_map<
+        uint64_t,
+        std::list<std::pair<uint64_t, block_ptr>>::iterator> m_cached;
+    mutable uint64_t m_hits = 0;
+    mutable uint64_t m_misses = 0;
+
+    block_ptr read_block(uint64_t k) const
+    {
+        std::string data(m_offsets[k + 1] - m_offsets[k], '\0');
+        {
+            std::lock_guard<std::mutex> lock(m_file_mutex);
+            m_file.seekg(m_data_start + m_offsets[k]);
+            m_file.read(&data[0], data.size());
+            if (!m_file.good()) {
+                m_file.clear();
+                throw std::runtime_error("truncated archive"); }
+        }
+        const uint64_t first = k * m_header.block_words;
+        auto words = std::make_shared<std::vector<uint64_t>>(
+            std::min(m_header.words, first + m_header.block_words) - first);
+        archive::decompress(archive::codec(m_header.codec), data,
+                            words->data(), words->size());
+        return words;
+    }
+
+    block_ptr block(uint64_t k) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_cache_mutex);
+            auto found = m_cached.find(k);
+            if (found != m_cached.end()) {
+                m_lru.splice(m_lru.begin(), m_lru, found->second);
+                m_hits++;
+                return found->second->second; }
+            m_misses++;
+        }
+        // decompressed outside of the lock, a concurrent miss of the same
+        // block only wastes work
+        auto words = read_block(k);
+        if (m_cache_blocks == 0) return words;
+
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        if (m_cached.count(k)) return words;
+        m_lru.emplace_front(k, words);
+        m_cached[k] = m_lru.begin();
+        if (m_lru.size() > m_cache_blocks) {
+            m_cached.erase(m_lru.back().first);
+            m_lru.pop_back(); }
+        return words;
+    }
+
+    uint64_t word(uint64_t w) const
+    {
+        const uint64_t k = w / m_header.block_words;
+        return (*block(k))[w - k * m_header.block_words];
+    }
+
+public:
+    archived_int_vector(const std::string& file_name, size_t cache_blocks):
+        m_cache_blocks(cache_blocks),
+        m_file(file_name, std::ios::binary)
+    {
+        if (!m_file.good()) {
+            throw std::runtime_error("cannot open " + file_name); }
+        m_file.read(reinterpret_cast<char*>(&m_header), sizeof(m_header));
+        if (!m_file.good() || std::memcmp(m_header.magic, archive::magic,
+                                          sizeof(archive::magic))) {
+            throw std::invalid_argument(file_name + " is not an archive"); }
+        if (m_header.codec != uint32_t(archive::codec::zstd) &&
+            m_header.codec != uint32_t(archive::codec::lz4)) {
+            throw std::invalid_argument(
+                "unknown codec " + std::to_string(m_header.codec)); }
+        if (m_header.width == 0 || m_header.width > 64) {
+            throw std::invalid_argument(
+                "invalid width " + std::to_string(m_header.width)); }
+        if (m_header.block_words == 0) {
+            throw std::invalid_argument(file_name + " has empty blocks"); }
+        if (m_header.block_words > archive::max_block_bytes(
+                archive::codec(m_header.codec)) / sizeof(uint64_t)) {
+            throw std::invalid_argument(
+                file_name + " has blocks too large for " + codec()); }
+        // the layout follows from size, width and block_words
+        const uint64_t bits = m_header.size * m_header.width;
+        if (m_header.size > UINT64_MAX / m_header.width ||
+            m_header.words != bits / 64 + (bits % 64 != 0) ||
+            m_header.blocks != (m_header.words + m_header.block_words - 1) /
+                               m_header.block_words) {
+            throw std::invalid_argument(file_name + " is corrupted"); }
+        m_offsets.resize(m_header.blocks + 1);
+        m_file.read(reinterpret_cast<char*>(m_offsets.data()),
+                    m_offsets.size() * sizeof(uint64_t));
+        if (!m_file.good()) {
+            throw std::invalid_argument(file_name + " is truncated"); }
+        m_data_start = m_file.tellg();
+        // read_block trusts the offsets: blocks are in order and in the file
+        m_file.seekg(0, std::ios::end);
+        const uint64_t data_bytes = uint64_t(m_file.tellg()) - m_data_start;
+        if (m_offsets.front() != 0 ||
+            !std::is_sorted(m_offsets.begin(), m_offsets.end()) ||
+            m_offsets.back() > data_bytes) {
+            throw std::invalid_argument(file_name + " is corrupted"); }
+    }
+
+    size_type size() const { return m_header.size; }
+
+    uint8_t width() const { return m_header.width; }
+
+    std::string codec() const
+    {
+        return archive::codec_name(archive::codec(m_header.codec));
+    }
+
+    uint64_t blocks() const { return m_header.blocks; }
+
+    uint64_t block_bytes() const
+    {
+        return m_header.block_words * sizeof(uint64_t);
+    }
+
+    uint64_t compressed_bytes() const { return m_offsets.back(); }
+
+    size_t cache_blocks() const { return m_cache_blocks; }
+
+    std::pair<uint64_t, uint64_t> cache_stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        return {m_hits, m_misses};
+    }
+
+    value_type operator[](size_type i) const
+    {
+        const uint8_t width = m_header.width;
+        const uint64_t bit = i * width;
+        const uint64_t w = bit / 64;
+        const unsigned offset = bit % 64;
+        uint64_t value = word(w) >> offset;
+        if (offset + width > 64) value |= word(w + 1) << (64 - offset);
+        return value & sdsl::bits::lo_set[width];
+    }
+
+    // Values [begin..end), decompressing every block once
+    sdsl::int_vector<> extract(size_type begin, size_type end) const
+    {
+        sdsl::int_vector<> result(end - begin, 0, m_header.width);
+        if (begin == end) return result;
+        const uint64_t first_word = begin * m_header.width / 64;
+        const uint64_t last_word = (end * m_header.width - 1) / 64;
+        std::vector<uint64_t> words;
+        words.reserve(last_word - first_word + 1);
+        for (uint64_t w = first_word; w <= last_word; ) {
+            const uint64_t k = w / m_header.block_words;
+            const auto data = block(k);
+            const uint64_t block_first = k * m_header.block_words;
+            for (; w <= last_word && w < block_first + data->size(); w++) {
+                words.push_back((*data)[w - block_first]); }
+        }
+        words.push_back(0);  // read_int may look one word ahead
+        const uint64_t skip = begin * m_header.width - first_word * 64;
+        for (size_type i = 0; i < end - begin; i++) {
+            const uint64_t bit = skip + i * m_header.width;
+            result[i] = sdsl::bits::read_int(words.data() + bit / 64,
+                                             bit % 64, m_header.width); }
+        return result;
+    }
+};
+
+
+// store_to_archive(v, ...) of the module, for the int vector class given
+class add_store_to_archive_functor
+{
+    py::module& m;
+
+public:
+    explicit add_store_to_archive_functor(py::module& m): m(m) {}
+
+    template <class T>
+    decltype(auto) operator()(py::class_<T>& cls)
+    {
+        m.def(
+            "store_to_archive",
+            locking::reading([] (const T& v, const std::string& file_name,
+                                 const std::string& codec, int level,
+                                 uint64_t block_bytes, size_t threads) {
+                archive::store(v, file_name, archive::parse_codec(codec),
+                               level, block_bytes, threads); }),
+            py::arg("v"), py::arg("file_name"), py::arg("codec") = "zstd",
+            py::arg("level") = 3, py::arg("block_bytes") = 1 << 16,
+            py::arg("threads") = 0,
+            "Stores the int vector v cut into blocks of `block_bytes` "
+            "compressed independently with zstd (at `level`) or lz4, on "
+            "`threads` threads; open it with ArchivedIntVector",
+            py::call_guard<py::gil_scoped_release>());
+        return cls;
+    }
+};
+
+
+inline auto add_archived_int_vector(py::module& m)
+{
+    typedef archived_int_vector T;
+
+    auto cls = py::class_<T>(m, "ArchivedIntVector");
+
+    cls.def(py::init<const std::string&, size_t>(),
+            py::arg("file_name"), py::arg("cache_blocks") = 16,
+            py::call_guard<py::gil_scoped_release>());
+
+    cls.def("__len__", &T::size);
+    cls.def_property_readonly("size", &T::size);
+    cls.def_property_readonly("width", &T::width);
+    cls.def_property_readonly("codec", &T::codec);
+    cls.def_property_readonly("blocks", &T::blocks);
+    cls.def_property_readonly("block_bytes", &T::block_bytes);
+    cls.def_property_readonly("compressed_bytes", &T::compressed_bytes,
+                              "Size of the compressed blocks");
+    cls.def_property_readonly("cache_blocks", &T::cache_blocks);
+    cls.def_property_readonly(
+        "cache_stats",
+        [] (const T& self) {
+            const auto stats = self.cache_stats();
+            return py::dict(py::arg("hits") = stats.first,
+                            py::arg("misses") = stats.second); },
+        "Block cache hits and misses");
+
+    cls.def(
+        "__getitem__",
+        [] (const T& self, int64_t position) {
+            const int64_t size = self.size();
+            if (position < 0) position += size;
+            if (position < 0 || position >= size) {
+                throw std::out_of_range(std::to_string(position)); }
+            return self[position]; },
+        py::arg("position"),
+        "Decompresses (or finds in the cache) the blocks holding the value",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "extract",
+        [] (const T& self, uint64_t begin, uint64_t end) {
+            if (begin > end || end > self.size()) {
+                throw std::out_of_range(
+                    std::to_string(begin) + ":" + std::to_string(end)); }
+            return self.extract(begin, end); },
+        py::arg("begin"), py::arg("end"),
+        "IntVector of values [begin:end)",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "to_int_vector",
+        [] (const T& self) { return self.extract(0, self.size()); },
+        "Decompresses the whole vector",
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.doc() = doc_archived_int_vector;
+
+    return cls;
+}
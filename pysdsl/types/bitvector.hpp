@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <utility>
 
 #include <sdsl/bit_vectors.hpp>
 #include <sdsl/vectors.hpp>
@@ -13,8 +15,10 @@
 #include "docstrings.hpp"
 #include "io.hpp"
 #include "supports.hpp"
+#include "operations/enumeration.hpp"
 #include "operations/sizes.hpp"
 #include "operations/iteration.hpp"
+#include "types/bitvector_sets.hpp"
 
 
 namespace py = pybind11;
@@ -53,6 +57,9 @@ auto add_bitvector_class(py::module &m, const std::string&& name,
         "starting at position `idx`.",
         py::call_guard<py::gil_scoped_release>());
 
+    add_bit_enumeration(m, cls, name);
+    add_bit_set_operations(cls);
+
     add_rank_support(m, cls, "_" + name, "", true, "0", "1", doc_rank);
     add_select_support(m, cls, "_" + name, "", true, "0", "1", doc_select);
 
@@ -175,11 +182,8 @@ inline auto add_hyb_vector(py::module& m)
 }
 
 
-template <class B>
-auto add_bitvectors(py::module& m, py::class_<B>& bit_vector_cls)
+inline auto add_bitvectors(py::module& m)
 {
-    add_bitvector_supports(m, bit_vector_cls);
-
     m.attr("all_immutable_bitvectors") = py::list();
     m.attr("bit_vector_interleaved") = py::dict();
     m.attr("raman_raman_rao_vectors") = py::dict();
@@ -219,3 +223,11 @@ auto add_bitvectors(py::module& m, py::class_<B>& bit_vector_cls)
     );
 
 }
+
+
+using compressed_bit_vector_classes = std::tuple_element_t<
+    0, decltype(add_bitvectors(std::declval<py::module&>()))>;
+
+// Bit vectors the wavelet trees are additionally instantiated with
+using propagated_bit_vector_classes = std::tuple_element_t<
+    1, decltype(add_bitvectors(std::declval<py::module&>()))>;
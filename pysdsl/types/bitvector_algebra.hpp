@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+
+#include "util/bits_kernels.hpp"
+#include "util/locking.hpp"
+#include "util/parallel.hpp"
+
+
+namespace py = pybind11;
+
+
+namespace detail
+{
+    // Words a thread gets at least, smaller vectors are combined by the
+    // calling thread
+    constexpr size_t parallel_words = 1 << 16;
+
+    // Words combined operand by operand in reductions, to stay in cache
+    constexpr size_t reduce_block = 1 << 12;
+
+    inline size_t algebra_threads(size_t words)
+    {
+        return std::max<size_t>(
+            1, std::min(resolve_threads(0), words / parallel_words));
+    }
+
+    inline size_t words_of(const sdsl::bit_vector& v)
+    {
+        return (v.size() + 63) / 64;
+    }
+
+    inline void check_lengths(const sdsl::bit_vector& a,
+                              const sdsl::bit_vector& b)
+    {
+        if (a.size() != b.size()) {
+            throw std::invalid_argument(
+                "bit vectors should have equal length"); }
+    }
+
+    // Keeps the bits past the end of the last word unset
+    inline void clear_tail(sdsl::bit_vector& v)
+    {
+        if (v.size() % 64) {
+            v.data()[v.size() / 64] &= sdsl::bits::lo_set[v.size() % 64]; }
+    }
+
+    // out = a op b, out may be a
+    template <bits_kernels::bitwise_op op>
+    inline void combine(const sdsl::bit_vector& a, const sdsl::bit_vector& b,
+                        sdsl::bit_vector& out)
+    {
+        const size_t n = words_of(a);
+        const auto& kernel = bits_kernels::combine<op>();
+        parallel_for(n, algebra_threads(n), [&] (size_t begin, size_t end) {
+            kernel.run(a.data() + begin, b.data() + begin,
+                       out.data() + begin, end - begin); });
+        clear_tail(out);
+    }
+
+    // Set bits of a op b
+    template <bits_kernels::bitwise_op op>
+    inline uint64_t combine_count(const sdsl::bit_vector& a,
+                                  const sdsl::bit_vector& b)
+    {
+        const size_t n = a.size() / 64;
+        const auto& kernel = bits_kernels::combine_count<op>();
+        std::atomic<uint64_t> result(0);
+        parallel_for(n, algebra_threads(n), [&] (size_t begin, size_t end) {
+            result += kernel.run(a.data() + begin, b.data() + begin,
+                                 end - begin); });
+        if (a.size() % 64) {
+            result += sdsl::bits::cnt(
+                bits_kernels::combine_word<op>(a.data()[n], b.data()[n]) &
+                sdsl::bits::lo_set[a.size() % 64]); }
+        return result;
+    }
+
+    inline sdsl::bit_vector invert(const sdsl::bit_vector& v)
+    {
+        sdsl::bit_vector result(v.size(), 0);
+        const size_t n = words_of(v);
+        parallel_for(n, algebra_threads(n), [&] (size_t begin, size_t end) {
+            const uint64_t* in = v.data();
+            uint64_t* out = result.data();
+            for (size_t i = begin; i < end; i++) out[i] = ~in[i]; });
+        clear_tail(result);
+        return result;
+    }
+
+    // vectors[0] op vectors[1] op ..., block by block: every block of the
+    // result is combined with all operands while it is in cache
+    template <bits_kernels::bitwise_op op>
+    inline sdsl::bit_vector reduce(
+        const std::vector<const sdsl::bit_vector*>& vectors)
+    {
+        if (vectors.empty()) {
+            throw std::invalid_argument("no bit vectors given"); }
+        for (auto v: vectors) {
+            if (!v) throw std::invalid_argument("None is not a BitVector"); }
+        locking::multi_guard<sdsl::bit_vector> guard(vectors);
+        for (auto v: vectors) check_lengths(*vectors[0], *v);
+
+        sdsl::bit_vector result(vectors[0]->size(), 0);
+        const size_t n = words_of(result);
+        const auto& kernel = bits_kernels::combine<op>();
+        parallel_for(n, algebra_threads(n), [&] (size_t begin, size_t end) {
+            uint64_t* out = result.data();
+            for (size_t b = begin; b < end; b += reduce_block) {
+                const size_t e = std::min(end, b + reduce_block);
+                std::copy(vectors[0]->data() + b, vectors[0]->data() + e,
+                          out + b);
+                for (size_t k = 1; k < vectors.size(); k++) {
+                    kernel.run(out + b, vectors[k]->data() + b, out + b,
+                               e - b); }
+            } });
+        clear_tail(result);
+        return result;
+    }
+}  // namespace detail
+
+
+template <bits_kernels::bitwise_op op>
+inline auto combined()
+{
+    return [] (const sdsl::bit_vector& self, const sdsl::bit_vector& other) {
+        locking::multi_guard<sdsl::bit_vector> guard({&self, &other});
+        detail::check_lengths(self, other);
+        sdsl::bit_vector result(self.size(), 0);
+        detail::combine<op>(self, other, result);
+        return result; };
+}
+
+
+template <bits_kernels::bitwise_op op>
+inline auto combined_in_place()
+{
+    return [] (py::object self, const sdsl::bit_vector& other) {
+        auto& v = self.cast<sdsl::bit_vector&>();
+        {
+            py::gil_scoped_release release;
+            locking::multi_guard<sdsl::bit_vector> guard({&other}, &v);
+            detail::check_lengths(v, other);
+            detail::combine<op>(v, other, v);
+        }
+        return self; };
+}
+
+
+template <bits_kernels::bitwise_op op>
+inline auto combined_count()
+{
+    return [] (const sdsl::bit_vector& self, const sdsl::bit_vector& other) {
+        locking::multi_guard<sdsl::bit_vector> guard({&self, &other});
+        detail::check_lengths(self, other);
+        return detail::combine_count<op>(self, other); };
+}
+
+
+// Bitwise operators between BitVectors of equal length, on the word
+// arrays with the dispatched kernels of util/bits_kernels.hpp and on
+// several threads for vectors of 2^22 bits and more
+inline auto add_bitvector_algebra(py::module& m,
+                                  py::class_<sdsl::bit_vector>& cls)
+{
+    using namespace bits_kernels;
+
+    cls.def("__and__", combined<op_and>(), py::is_operator(),
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("__or__", combined<op_or>(), py::is_operator(),
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("__xor__", combined<op_xor>(), py::is_operator(),
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("__invert__",
+            locking::reading([] (const sdsl::bit_vector& self) {
+                return detail::invert(self); }),
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("andnot", combined<op_andnot>(), py::arg("other"),
+            "self & ~other without the temporary",
+            py::call_guard<py::gil_scoped_release>());
+
+    cls.def("__iand__", combined_in_place<op_and>(), py::is_operator());
+    cls.def("__ior__", combined_in_place<op_or>(), py::is_operator());
+    cls.def("__ixor__", combined_in_place<op_xor>(), py::is_operator());
+    cls.def("andnot_update", combined_in_place<op_andnot>(),
+            py::arg("other"), "self &= ~other, returns self");
+
+    cls.def("and_count", combined_count<op_and>(), py::arg("other"),
+            "Number of set bits of self & other, without computing it",
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("or_count", combined_count<op_or>(), py::arg("other"),
+            "Number of set bits of self | other, without computing it",
+            py::call_guard<py::gil_scoped_release>());
+
+    m.def("reduce_and", &detail::reduce<op_and>, py::arg("bit_vectors"),
+          "AND of a list of BitVectors of equal length, in one pass without "
+          "intermediate vectors",
+          py::call_guard<py::gil_scoped_release>());
+    m.def("reduce_or", &detail::reduce<op_or>, py::arg("bit_vectors"),
+          "OR of a list of BitVectors of equal length, in one pass without "
+          "intermediate vectors",
+          py::call_guard<py::gil_scoped_release>());
+
+    return cls;
+}
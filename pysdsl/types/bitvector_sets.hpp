@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/sd_vector.hpp>
+
+#include "operations/batch.hpp"
+#include "operations/enumeration.hpp"
+
+
+namespace py = pybind11;
+
+
+namespace detail
+{
+    // Set bits of a bit vector as a sorted sequence, read by skipping
+    // forward
+    class bit_cursor
+    {
+    public:
+        virtual ~bit_cursor() = default;
+
+        // length of the vector
+        virtual uint64_t size() const = 0;
+
+        // number of set bits
+        virtual uint64_t count() const = 0;
+
+        // Smallest set position >= x, size() if there is none. Calls
+        // should not go back: x at least the previous x.
+        virtual uint64_t next_geq(uint64_t x) = 0;
+
+        virtual void positions(std::vector<uint64_t>& out) const = 0;
+    };
+
+
+    // Skips by reading words, for vectors without a cheap select. The
+    // last answer is kept: queries up to it, e.g. every set bit of a dense
+    // vector looked up in a sparse one, do not read the run of zeros
+    // before it again.
+    template <class T>
+    class scan_cursor: public bit_cursor
+    {
+    private:
+        const T& m_vector;
+        uint64_t m_from;   // last x asked for
+        uint64_t m_found;  // its answer: no set bit in [m_from, m_found)
+
+    public:
+        explicit scan_cursor(const T& vector):
+            m_vector(vector),
+            m_from(std::numeric_limits<uint64_t>::max()),
+            m_found(0)
+        {}
+
+        uint64_t size() const override { return m_vector.size(); }
+
+        uint64_t count() const override
+        {
+            return count_ones(m_vector, 0, m_vector.size());
+        }
+
+        uint64_t next_geq(uint64_t x) override
+        {
+            if (m_from <= x && x <= m_found) return m_found;
+            m_from = x;
+            m_found = scan(x);
+            return m_found;
+        }
+
+        void positions(std::vector<uint64_t>& out) const override
+        {
+            scan_bits(m_vector, 0, m_vector.size(), false,
+                      std::numeric_limits<size_t>::max(), out);
+        }
+
+    private:
+        uint64_t scan(uint64_t x) const
+        {
+            const uint64_t size = m_vector.size();
+            if (x >= size) return size;
+            const uint64_t words = (size + 63) / 64;
+            uint64_t word = x / 64;
+            uint64_t bits;
+            read_words(m_vector, word, 1, &bits);
+            bits &= ~sdsl::bits::lo_set[x % 64];
+            while (!bits) {
+                if (++word == words) return size;
+                read_words(m_vector, word, 1, &bits);
+            }
+            return word * 64 + sdsl::bits::lo(bits);
+        }
+    };
+
+
+    // Skips on the Elias-Fano representation: a few neighbouring ones are
+    // tried by select (the common case of a merge), then rank jumps to the
+    // target directly
+    template <class T>
+    class select_cursor: public bit_cursor
+    {
+    private:
+        static constexpr int probes = 4;
+
+        const T& m_vector;
+        typename T::rank_1_type m_rank;
+        typename T::select_1_type m_select;
+        uint64_t m_ones;
+        uint64_t m_next;  // index of the next candidate one
+
+    public:
+        explicit select_cursor(const T& vector):
+            m_vector(vector),
+            m_rank(&vector),
+            m_select(&vector),
+            m_ones(m_rank.rank(vector.size())),
+            m_next(0)
+        {}
+
+        uint64_t size() const override { return m_vector.size(); }
+
+        uint64_t count() const override { return m_ones; }
+
+        uint64_t next_geq(uint64_t x) override
+        {
+            for (int probe = 0; probe < probes && m_next < m_ones; probe++) {
+                const uint64_t position = m_select.select(m_next + 1);
+                if (position >= x) return position;
+                m_next++;
+            }
+            if (m_next >= m_ones || x >= m_vector.size()) {
+                return m_vector.size(); }
+            m_next = m_rank.rank(x);
+            return m_next < m_ones ? m_select.select(m_next + 1)
+                                   : m_vector.size();
+        }
+
+        void positions(std::vector<uint64_t>& out) const override
+        {
+            scan_bits(m_vector, 0, m_vector.size(), false,
+                      std::numeric_limits<size_t>::max(), out);
+        }
+    };
+
+
+    template <class T>
+    inline std::unique_ptr<bit_cursor> make_cursor(const T& vector)
+    {
+        return std::unique_ptr<bit_cursor>(new scan_cursor<T>(vector));
+    }
+
+    template <class... P>
+    inline std::unique_ptr<bit_cursor> make_cursor(
+        const sdsl::sd_vector<P...>& vector)
+    {
+        return std::unique_ptr<bit_cursor>(
+            new select_cursor<sdsl::sd_vector<P...>>(vector));
+    }
+
+
+    // Cursors of the Python objects of every bound bit vector class, which
+    // register themselves when bound
+    typedef std::function<std::unique_ptr<bit_cursor>(py::handle)>
+        cursor_maker;
+
+    inline std::vector<cursor_maker>& cursor_makers()
+    {
+        static std::vector<cursor_maker> makers;
+        return makers;
+    }
+
+    inline std::unique_ptr<bit_cursor> cursor_of(py::handle object)
+    {
+        for (const auto& make: cursor_makers()) {
+            auto cursor = make(object);
+            if (cursor) return cursor;
+        }
+        throw py::type_error(
+            py::str(object.get_type()).cast<std::string>() +
+            " is not a compressed bit vector");
+    }
+
+
+    // Sorted positions of the set bits of a vector of length `size`
+    struct bit_set
+    {
+        std::vector<uint64_t> positions;
+        uint64_t size;
+    };
+
+    // Leapfrog join: the cursors in turn skip to the current candidate
+    // until all of them agree on it. The sparsest vector proposes the
+    // candidates.
+    inline bit_set intersection(
+        const std::vector<std::unique_ptr<bit_cursor>>& cursors)
+    {
+        std::vector<bit_cursor*> order;
+        for (const auto& cursor: cursors) order.push_back(cursor.get());
+        std::vector<uint64_t> counts;
+        for (auto cursor: order) counts.push_back(cursor->count());
+        std::vector<size_t> by_count(order.size());
+        for (size_t k = 0; k < by_count.size(); k++) by_count[k] = k;
+        std::sort(by_count.begin(), by_count.end(),
+                  [&counts] (size_t a, size_t b) {
+                      return counts[a] < counts[b]; });
+
+        bit_set result;
+        result.size = 0;
+        for (auto cursor: order) {
+            result.size = std::max(result.size, cursor->size()); }
+        uint64_t end = result.size;
+        for (auto cursor: order) end = std::min(end, cursor->size());
+
+        const size_t n = order.size();
+        uint64_t x = order[by_count[0]]->next_geq(0);
+        size_t agreed = 1;
+        size_t k = 1 % n;
+        while (x < end) {
+            if (agreed == n) {
+                result.positions.push_back(x);
+                x = order[by_count[0]]->next_geq(x + 1);
+                agreed = 1;
+                k = 1 % n;
+                continue;
+            }
+            const uint64_t y = order[by_count[k]]->next_geq(x);
+            if (y == x) {
+                agreed++;
+            } else {
+                x = y;
+                agreed = 1;
+            }
+            k = (k + 1) % n;
+        }
+        return result;
+    }
+
+    inline bit_set set_union(bit_cursor& a, bit_cursor& b)
+    {
+        std::vector<uint64_t> first;
+        std::vector<uint64_t> second;
+        a.positions(first);
+        b.positions(second);
+        bit_set result;
+        result.size = std::max(a.size(), b.size());
+        result.positions.reserve(first.size() + second.size());
+        std::set_union(first.begin(), first.end(),
+                       second.begin(), second.end(),
+                       std::back_inserter(result.positions));
+        return result;
+    }
+
+    // Set bits of a, each looked up in b by skipping
+    inline bit_set set_difference(bit_cursor& a, bit_cursor& b)
+    {
+        std::vector<uint64_t> first;
+        a.positions(first);
+        bit_set result;
+        result.size = a.size();
+        for (auto x: first) {
+            if (b.next_geq(x) != x) result.positions.push_back(x); }
+        return result;
+    }
+
+    inline py::object bit_set_result(const bit_set& set, bool positions)
+    {
+        if (positions) return to_numpy(set.positions);
+        sdsl::sd_vector<> result;
+        {
+            py::gil_scoped_release release;
+            sdsl::sd_vector_builder builder(set.size, set.positions.size());
+            for (auto x: set.positions) builder.set(x);
+            result = sdsl::sd_vector<>(builder);
+        }
+        return py::cast(std::move(result));
+    }
+}  // namespace detail
+
+
+// Sorted-set operations between compressed bit vectors of any classes, on
+// their set bits and without decompressing them
+template <class T>
+inline auto add_bit_set_operations(py::class_<T>& cls)
+{
+    detail::cursor_makers().push_back(
+        [] (py::handle object) -> std::unique_ptr<detail::bit_cursor> {
+            if (!py::isinstance<T>(object)) return nullptr;
+            return detail::make_cursor(object.cast<const T&>()); });
+
+    cls.def(
+        "intersect",
+        [] (const T& self, py::object others, bool positions) {
+            std::vector<std::unique_ptr<detail::bit_cursor>> cursors;
+            cursors.push_back(detail::make_cursor(self));
+            if (py::isinstance<py::list>(others) ||
+                py::isinstance<py::tuple>(others)) {
+                for (auto other: others.cast<py::sequence>()) {
+                    cursors.push_back(detail::cursor_of(other)); }
+            } else {
+                cursors.push_back(detail::cursor_of(others));
+            }
+            detail::bit_set result;
+            {
+                py::gil_scoped_release release;
+                result = detail::intersection(cursors);
+            }
+            return detail::bit_set_result(result, positions); },
+        py::arg("other"), py::arg("positions") = false,
+        "Set bits common to this vector and `other`, a compressed bit vector "
+        "or a list of them (k-way intersection), as an SDVector or, with "
+        "`positions`, a numpy array");
+    cls.def(
+        "union",
+        [] (const T& self, py::object other, bool positions) {
+            auto a = detail::make_cursor(self);
+            auto b = detail::cursor_of(other);
+            detail::bit_set result;
+            {
+                py::gil_scoped_release release;
+                result = detail::set_union(*a, *b);
+            }
+            return detail::bit_set_result(result, positions); },
+        py::arg("other"), py::arg("positions") = false,
+        "Bits set in this vector or in `other`, as an SDVector or, with "
+        "`positions`, a numpy array");
+    cls.def(
+        "difference",
+        [] (const T& self, py::object other, bool positions) {
+            auto a = detail::make_cursor(self);
+            auto b = detail::cursor_of(other);
+            detail::bit_set result;
+            {
+                py::gil_scoped_release release;
+                result = detail::set_difference(*a, *b);
+            }
+            return detail::bit_set_result(result, positions); },
+        py::arg("other"), py::arg("positions") = false,
+        "Bits set in this vector but not in `other`, as an SDVector or, "
+        "with `positions`, a numpy array");
+
+    return cls;
+}
@@ -0,0 +1,614 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "docstrings.hpp"
+#include "operations/sizes.hpp"
+#include "util/bits_kernels.hpp"
+#include "util/locking.hpp"
+#include "util/stats.hpp"
+
+
+namespace py = pybind11;
+
+
+// Bit vector with insertions and deletions: a B+-tree whose leaves hold
+// up to 8 KB of bits and whose nodes store the number of bits and set bits
+// below them. Access, rank, select, set, insert and erase take
+// O(log n) node visits plus a scan or shift of one leaf.
+class dynamic_bit_vector
+{
+public:
+    typedef uint64_t size_type;
+
+    // Full leaves are split into two 4 KB halves, leaves shrunk below
+    // 2 KB are merged with a neighbour
+    static constexpr size_type leaf_max_bits = 8 * 1024 * 8;
+    static constexpr size_type leaf_min_bits = leaf_max_bits / 4;
+    static constexpr size_type leaf_build_bits = leaf_max_bits * 3 / 4;
+    static constexpr size_t max_children = 64;
+    static constexpr size_t min_children = max_children / 4;
+    static constexpr size_t build_children = max_children * 3 / 4;
+
+private:
+    struct node
+    {
+        size_type size = 0;
+        size_type ones = 0;
+        // bits of a leaf, words.size() == ceil(size / 64) and bits past
+        // `size` are zero
+        std::vector<uint64_t> words;
+        // empty for leaves
+        std::vector<std::unique_ptr<node>> children;
+
+        bool leaf() const { return children.empty(); }
+
+        size_type count(bool bit) const { return bit ? ones : size - ones; }
+    };
+
+    std::unique_ptr<node> m_root;
+
+    static uint64_t low_mask(unsigned bits)
+    {
+        return bits ? ~uint64_t(0) >> (64 - bits) : 0;
+    }
+
+    // Leaf operations
+
+    static void append_bits(node& leaf, uint64_t value, unsigned len)
+    {
+        const unsigned offset = leaf.size % 64;
+        if (offset == 0) {
+            leaf.words.push_back(value);
+        } else {
+            leaf.words.back() |= value << offset;
+            if (offset + len > 64) leaf.words.push_back(value >> (64 - offset));
+        }
+        leaf.size += len;
+        leaf.ones += sdsl::bits::cnt(value);
+    }
+
+    static void append_leaf(node& leaf, const node& other)
+    {
+        for (size_t w = 0; w < other.words.size(); w++) {
+            append_bits(leaf, other.words[w], std::min<size_type>(
+                64, other.size - 64 * w)); }
+    }
+
+    static void leaf_insert(node& leaf, size_type i, bool bit)
+    {
+        if (leaf.size % 64 == 0) leaf.words.push_back(0);
+        const size_t w = i / 64;
+        auto& words = leaf.words;
+        for (size_t k = words.size() - 1; k > w; k--) {
+            words[k] = (words[k] << 1) | (words[k - 1] >> 63); }
+        const uint64_t mask = low_mask(i % 64);
+        words[w] = (words[w] & mask) | ((words[w] & ~mask) << 1) |
+                   (uint64_t(bit) << (i % 64));
+        leaf.size++;
+        leaf.ones += bit;
+    }
+
+    static bool leaf_erase(node& leaf, size_type i)
+    {
+        const size_t w = i / 64;
+        auto& words = leaf.words;
+        const bool bit = (words[w] >> (i % 64)) & 1;
+        const uint64_t mask = low_mask(i % 64);
+        words[w] = (words[w] & mask) | ((words[w] >> 1) & ~mask);
+        for (size_t k = w; k + 1 < words.size(); k++) {
+            words[k] |= words[k + 1] << 63;
+            words[k + 1] >>= 1; }
+        leaf.size--;
+        leaf.ones -= bit;
+        if (leaf.size % 64 == 0) words.pop_back();
+        return bit;
+    }
+
+    static size_type leaf_rank(const node& leaf, size_type i)
+    {
+        size_type result = 0;
+        for (size_t w = 0; w < i / 64; w++) {
+            result += sdsl::bits::cnt(leaf.words[w]); }
+        if (i % 64) {
+            result += sdsl::bits::cnt(leaf.words[i / 64] & low_mask(i % 64)); }
+        return result;
+    }
+
+    // Position of the k-th (1-based) `bit` in the leaf
+    static size_type leaf_select(const node& leaf, size_type k, bool bit)
+    {
+        for (size_t w = 0;; w++) {
+            uint64_t word = bit ? leaf.words[w] : ~leaf.words[w];
+            if (!bit) {
+                word &= low_mask(std::min<size_type>(64, leaf.size - 64 * w));
+            }
+            const size_type c = sdsl::bits::cnt(word);
+            if (k <= c) return 64 * w + bits_kernels::select(word, k);
+            k -= c;
+        }
+    }
+
+    // Node structure
+
+    static bool underfull(const node& n)
+    {
+        return n.leaf() ? n.size < leaf_min_bits :
+                          n.children.size() < min_children;
+    }
+
+    static bool overfull(const node& n)
+    {
+        return n.leaf() ? n.size > leaf_max_bits :
+                          n.children.size() > max_children;
+    }
+
+    static void add_child(node& n, std::unique_ptr<node> child)
+    {
+        n.size += child->size;
+        n.ones += child->ones;
+        n.children.push_back(std::move(child));
+    }
+
+    // Moves the second half of `n` into a new right sibling
+    static std::unique_ptr<node> split(node& n)
+    {
+        std::unique_ptr<node> right(new node());
+        if (n.leaf()) {
+            const size_t half = n.words.size() / 2;
+            right->words.assign(n.words.begin() + half, n.words.end());
+            right->size = n.size - 64 * half;
+            for (auto word: right->words) {
+                right->ones += sdsl::bits::cnt(word); }
+            n.words.resize(half);
+        } else {
+            const size_t half = n.children.size() / 2;
+            for (size_t c = half; c < n.children.size(); c++) {
+                add_child(*right, std::move(n.children[c])); }
+            n.children.resize(half);
+        }
+        n.size -= right->size;
+        n.ones -= right->ones;
+        return right;
+    }
+
+    // Child of an inner node holding position i, i becomes the position
+    // within the child
+    static size_t child_at(const node& n, size_type& i)
+    {
+        size_t c = 0;
+        while (i >= n.children[c]->size) i -= n.children[c++]->size;
+        return c;
+    }
+
+    // Merges the underfull child c with a neighbour, splitting the result
+    // again if it is too large
+    static void rebalance(node& n, size_t c)
+    {
+        if (n.children.size() < 2) return;
+        const size_t left = c + 1 < n.children.size() ? c : c - 1;
+        node& target = *n.children[left];
+        std::unique_ptr<node> source = std::move(n.children[left + 1]);
+        n.children.erase(n.children.begin() + left + 1);
+
+        if (target.leaf()) {
+            append_leaf(target, *source);
+        } else {
+            for (auto& child: source->children) {
+                add_child(target, std::move(child)); } }
+        if (overfull(target)) {
+            n.children.insert(n.children.begin() + left + 1, split(target)); }
+    }
+
+    static std::unique_ptr<node> insert(node& n, size_type i, bool bit)
+    {
+        if (n.leaf()) {
+            leaf_insert(n, i, bit);
+        } else {
+            n.size++;
+            n.ones += bit;
+            size_t c = 0;
+            while (c + 1 < n.children.size() && i > n.children[c]->size) {
+                i -= n.children[c++]->size; }
+            if (auto right = insert(*n.children[c], i, bit)) {
+                n.children.insert(n.children.begin() + c + 1,
+                                  std::move(right)); }
+        }
+        return overfull(n) ? split(n) : nullptr;
+    }
+
+    static bool erase(node& n, size_type i)
+    {
+        if (n.leaf()) return leaf_erase(n, i);
+        const size_t c = child_at(n, i);
+        const bool bit = erase(*n.children[c], i);
+        n.size--;
+        n.ones -= bit;
+        if (underfull(*n.children[c])) rebalance(n, c);
+        return bit;
+    }
+
+    static int set(node& n, size_type i, bool bit)
+    {
+        int delta;
+        if (n.leaf()) {
+            auto& word = n.words[i / 64];
+            const bool old = (word >> (i % 64)) & 1;
+            word ^= uint64_t(old != bit) << (i % 64);
+            delta = int(bit) - int(old);
+        } else {
+            const size_t c = child_at(n, i);
+            delta = set(*n.children[c], i, bit);
+        }
+        n.ones += delta;
+        return delta;
+    }
+
+    template <class F>
+    static void for_each_leaf(const node& n, F& f)
+    {
+        if (n.leaf()) {
+            f(n);
+            return; }
+        for (const auto& child: n.children) for_each_leaf(*child, f);
+    }
+
+    void build(const sdsl::bit_vector& bits)
+    {
+        std::vector<std::unique_ptr<node>> level;
+        for (size_type begin = 0; begin < bits.size() || level.empty();
+             begin += leaf_build_bits) {
+            std::unique_ptr<node> leaf(new node());
+            const size_type end = std::min<size_type>(
+                bits.size(), begin + leaf_build_bits);
+            for (size_type pos = begin; pos < end; pos += 64) {
+                const unsigned len = std::min<size_type>(64, end - pos);
+                append_bits(*leaf, bits.get_int(pos, len), len); }
+            level.push_back(std::move(leaf));
+        }
+        while (level.size() > 1) {
+            std::vector<std::unique_ptr<node>> parents;
+            for (size_t c = 0; c < level.size(); c++) {
+                if (c % build_children == 0) parents.emplace_back(new node());
+                add_child(*parents.back(), std::move(level[c])); }
+            level.swap(parents);
+        }
+        m_root = std::move(level[0]);
+    }
+
+    void check_position(size_type i, size_type bound) const
+    {
+        if (i >= bound) throw std::out_of_range(std::to_string(i));
+    }
+
+public:
+    explicit dynamic_bit_vector(size_type size = 0, bool value = false)
+    {
+        build(sdsl::bit_vector(size, value));
+    }
+
+    explicit dynamic_bit_vector(const sdsl::bit_vector& bits) { build(bits); }
+
+    dynamic_bit_vector(dynamic_bit_vector&&) = default;
+    dynamic_bit_vector& operator=(dynamic_bit_vector&&) = default;
+
+    dynamic_bit_vector(const dynamic_bit_vector& other)
+    {
+        build(other.to_bit_vector());
+    }
+
+    size_type size() const { return m_root->size; }
+
+    size_type ones() const { return m_root->ones; }
+
+    bool operator[](size_type i) const
+    {
+        check_position(i, size());
+        const node* n = m_root.get();
+        while (!n->leaf()) n = n->children[child_at(*n, i)].get();
+        return (n->words[i / 64] >> (i % 64)) & 1;
+    }
+
+    // Number of `bit`s in [0..i)
+    size_type rank(size_type i, bool bit = true) const
+    {
+        check_position(i, size() + 1);
+        if (i == size()) return m_root->count(bit);
+        const size_type end = i;
+        size_type ones = 0;
+        const node* n = m_root.get();
+        while (!n->leaf()) {
+            size_t c = 0;
+            while (i >= n->children[c]->size) {
+                ones += n->children[c]->ones;
+                i -= n->children[c++]->size; }
+            n = n->children[c].get();
+        }
+        ones += leaf_rank(*n, i);
+        return bit ? ones : end - ones;
+    }
+
+    // Position of the k-th (1-based) `bit`
+    size_type select(size_type k, bool bit = true) const
+    {
+        if (k < 1 || k > m_root->count(bit)) {
+            throw std::out_of_range(std::to_string(k)); }
+        size_type position = 0;
+        const node* n = m_root.get();
+        while (!n->leaf()) {
+            size_t c = 0;
+            while (k > n->children[c]->count(bit)) {
+                k -= n->children[c]->count(bit);
+                position += n->children[c++]->size; }
+            n = n->children[c].get();
+        }
+        return position + leaf_select(*n, k, bit);
+    }
+
+    void set(size_type i, bool bit)
+    {
+        check_position(i, size());
+        set(*m_root, i, bit);
+    }
+
+    void insert(size_type i, bool bit)
+    {
+        check_position(i, size() + 1);
+        if (auto right = insert(*m_root, i, bit)) {
+            std::unique_ptr<node> root(new node());
+            add_child(*root, std::move(m_root));
+            add_child(*root, std::move(right));
+            m_root = std::move(root);
+        }
+    }
+
+    // Inserts `bits` before position i. Splicing rewrites every leaf once
+    // while separate insertions shift a leaf each, so the tree is rebuilt
+    // once there are at least as many bits as leaves (appends excepted,
+    // they shift nothing).
+    void insert(size_type i, const sdsl::bit_vector& bits)
+    {
+        check_position(i, size() + 1);
+        if (i == size() || bits.size() < size() / leaf_build_bits) {
+            for (size_type k = 0; k < bits.size(); k++) {
+                insert(i + k, bool(bits[k])); }
+            return; }
+
+        const auto old = to_bit_vector();
+        sdsl::bit_vector spliced(old.size() + bits.size());
+        auto copy = [&spliced] (const sdsl::bit_vector& from, size_type begin,
+                                size_type end, size_type to) {
+            for (size_type pos = begin; pos < end; pos += 64) {
+                const unsigned len = std::min<size_type>(64, end - pos);
+                spliced.set_int(to + pos - begin, from.get_int(pos, len),
+                                len); } };
+        copy(old, 0, i, 0);
+        copy(bits, 0, bits.size(), i);
+        copy(old, i, old.size(), i + bits.size());
+        build(spliced);
+    }
+
+    // Removes position i and returns its bit
+    bool erase(size_type i)
+    {
+        check_position(i, size());
+        const bool bit = erase(*m_root, i);
+        while (!m_root->leaf() && m_root->children.size() == 1) {
+            m_root = std::move(m_root->children[0]); }
+        return bit;
+    }
+
+    sdsl::bit_vector to_bit_vector() const
+    {
+        sdsl::bit_vector result(size());
+        size_type offset = 0;
+        auto copy = [&result, &offset] (const node& leaf) {
+            for (size_t w = 0; w < leaf.words.size(); w++) {
+                const unsigned len = std::min<size_type>(
+                    64, leaf.size - 64 * w);
+                result.set_int(offset, leaf.words[w], len);
+                offset += len; } };
+        for_each_leaf(*m_root, copy);
+        return result;
+    }
+
+    size_type size_in_bytes() const
+    {
+        size_type result = sizeof(*this);
+        auto add = [&result] (const node& leaf) {
+            result += sizeof(node) + 8 * leaf.words.capacity(); };
+        for_each_leaf(*m_root, add);
+        return result;
+    }
+};
+
+
+namespace locking
+{
+    template <>
+    struct is_mutable<dynamic_bit_vector>: std::true_type {};
+}  // namespace locking
+
+
+namespace detail
+{
+    inline sdsl::bit_vector bits_of(const py::iterable& bits)
+    {
+        std::vector<bool> values;
+        for (auto bit: bits) values.push_back(bit.cast<bool>());
+        sdsl::bit_vector result(values.size());
+        for (size_t i = 0; i < values.size(); i++) result[i] = values[i];
+        return result;
+    }
+
+
+    // Adds construction from a DynamicBitVector to a static bit vector
+    // class, which has a constructor from sdsl::bit_vector
+    class add_init_from_dynamic_functor
+    {
+    public:
+        template <class T>
+        decltype(auto) operator()(py::class_<T>& cls)
+        {
+            return cls.def(py::init(locking::reading(
+                [] (const dynamic_bit_vector& from) {
+                    return T(from.to_bit_vector()); })),
+                py::arg("v"),
+                py::prepend(),
+                py::call_guard<py::gil_scoped_release>());
+        }
+    };
+}  // namespace detail
+
+
+inline auto add_dynamic_bit_vector(py::module& m)
+{
+    typedef dynamic_bit_vector T;
+    typedef T::size_type size_type;
+
+    auto cls = py::class_<T>(m, "DynamicBitVector");
+
+    cls.def(py::init([] (size_type size, bool default_value) {
+                return T(size, default_value); }),
+            py::arg("size") = 0, py::arg("default_value") = false,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def(py::init(locking::reading([] (const sdsl::bit_vector& bits) {
+                return T(bits); })),
+            py::arg("bits"),
+            "Copy of a BitVector",
+            py::call_guard<py::gil_scoped_release>());
+    cls.def(py::init([] (const py::iterable& bits) {
+                return T(detail::bits_of(bits)); }),
+            py::arg("bits"),
+            "From an iterable of truth values");
+
+    add_sizes(cls);
+
+    cls.def_property_readonly(
+        "ones", locking::reading([] (const T& self) { return self.ones(); }),
+        "The number of set bits",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "size_in_bytes",
+        locking::reading([] (const T& self) { return self.size_in_bytes(); }),
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.def(
+        "__getitem__",
+        stats::timed(cls, "__getitem__", locking::reading(
+            [] (const T& self, int64_t i) {
+                if (i < 0) i += self.size();
+                if (i < 0) throw std::out_of_range(std::to_string(i));
+                return self[i]; })),
+        py::arg("i"),
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "__setitem__",
+        locking::writing([] (T& self, int64_t i, bool bit) {
+            if (i < 0) i += self.size();
+            if (i < 0) throw std::out_of_range(std::to_string(i));
+            self.set(i, bit); }),
+        py::arg("i"), py::arg("bit"),
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "set",
+        locking::writing([] (T& self, size_type i, bool bit) {
+            self.set(i, bit); }),
+        py::arg("i"), py::arg("bit"),
+        "Sets position i to `bit`.\nTime complexity: Order(log(n))",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "rank",
+        stats::timed(cls, "rank", locking::reading(
+            [] (const T& self, size_type i, bool bit) {
+                return self.rank(i, bit); })),
+        py::arg("i"), py::arg("bit") = true,
+        "Number of `bit`s in the prefix [0..i-1] (i in [0..size]).\n"
+        "Time complexity: Order(log(n))",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "select",
+        stats::timed(cls, "select", locking::reading(
+            [] (const T& self, size_type k, bool bit) {
+                return self.select(k, bit); })),
+        py::arg("k"), py::arg("bit") = true,
+        "Position of the k-th (1-based) `bit`.\n"
+        "Time complexity: Order(log(n))",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "insert",
+        locking::writing([] (T& self, size_type i, bool bit) {
+            self.insert(i, bit); }),
+        py::arg("i"), py::arg("bit"),
+        "Inserts `bit` before position i (i in [0..size]).\n"
+        "Time complexity: Order(log(n))",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "insert_many",
+        [] (T& self, size_type i, const sdsl::bit_vector& bits) {
+            py::gil_scoped_release release;
+            // one lock at a time: copy the batch first
+            const sdsl::bit_vector batch = locking::reading(
+                [] (const sdsl::bit_vector& from) { return from; })(bits);
+            locking::unique_guard<T> guard(self);
+            self.insert(i, batch); },
+        py::arg("i"), py::arg("bits"),
+        "Inserts a BitVector before position i; large batches rebuild the "
+        "tree in one pass.");
+    cls.def(
+        "insert_many",
+        [] (T& self, size_type i, const py::iterable& bits) {
+            const sdsl::bit_vector batch = detail::bits_of(bits);
+            py::gil_scoped_release release;
+            locking::unique_guard<T> guard(self);
+            self.insert(i, batch); },
+        py::arg("i"), py::arg("bits"),
+        "Inserts an iterable of truth values before position i.");
+    cls.def(
+        "append",
+        locking::writing([] (T& self, bool bit) {
+            self.insert(self.size(), bit); }),
+        py::arg("bit"),
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "erase",
+        locking::writing([] (T& self, size_type i) { return self.erase(i); }),
+        py::arg("i"),
+        "Removes position i and returns its bit.\n"
+        "Time complexity: Order(log(n))",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "to_bit_vector",
+        locking::reading([] (const T& self) { return self.to_bit_vector(); }),
+        "Static copy as a BitVector, e.g. to build compressed bit vectors "
+        "or rank/select supports from it",
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.def(py::pickle(
+        [] (const T& self) {
+            sdsl::bit_vector bits;
+            {
+                py::gil_scoped_release release;
+                locking::shared_guard<T> guard(self);
+                bits = self.to_bit_vector();
+            }
+            return py::make_tuple(std::move(bits)); },
+        [] (py::tuple state) {
+            return T(state[0].cast<const sdsl::bit_vector&>()); }));
+
+    cls.doc() = doc_dynamic_bit_vector;
+
+    return cls;
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include <pybind11/pybind11.h>
 
@@ -265,3 +266,7 @@ auto add_encoded_vectors(py::module& m)
 
     return std::tuple_cat(enc_classes, vlc_classes, dac_classes);
 }
+
+
+using encoded_vector_classes = decltype(
+    add_encoded_vectors(std::declval<py::module&>()));
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include <pybind11/pybind11.h>
 
@@ -10,9 +12,13 @@
 
 #include "calc.hpp"
 #include "io.hpp"
+#include "operations/enumeration.hpp"
 #include "operations/iteration.hpp"
 #include "operations/sizes.hpp"
 #include "docstrings.hpp"
+#include "types/bitvector_algebra.hpp"
+#include "types/intvector_builder.hpp"
+#include "util/locking.hpp"
 
 
 constexpr char sym_for_width(unsigned int width) {
@@ -61,52 +67,92 @@ inline auto add_int_init(py::module& m, const char* name)
 }
         
 
+// The codecs are in the optional pysdsl._archive module, which the method
+// imports on first use: int vectors do not link zstd and lz4
+template <class T>
+inline auto add_store_to_archive(py::class_<T>& cls)
+{
+    return cls.def(
+        "store_to_archive",
+        [] (py::object self, py::object file_name, py::object codec,
+            py::object level, py::object block_bytes, py::object threads) {
+            py::module::import("pysdsl._archive").attr("store_to_archive")(
+                self, file_name, codec, level, block_bytes, threads); },
+        py::arg("file_name"), py::arg("codec") = "zstd",
+        py::arg("level") = 3, py::arg("block_bytes") = 1 << 16,
+        py::arg("threads") = 0,
+        "Stores the vector cut into blocks of `block_bytes` compressed "
+        "independently with zstd (at `level`) or lz4, on `threads` threads; "
+        "open it with ArchivedIntVector");
+}
+
+
 template <class T, typename S = typename T::value_type, typename KEY_T>
 inline auto add_int_class(py::module& m, py::dict& dict, KEY_T key,
                           const char *name, const char *doc = nullptr)
 {
     auto cls = add_int_init<T>(m, name)
-        .def_property_readonly("width", static_cast<uint8_t(T::*)(void) const> (&T::width))
+        .def_property_readonly(
+            "width",
+            locking::reading([](const T& self) { return self.width(); }),
+            py::call_guard<py::gil_scoped_release>())
         .def_property_readonly("data",
                                static_cast<const uint64_t *(T::*)(void)const> (&T::data))
 
-        .def_property_readonly("bit_size", &T::bit_size,
-                               "The number of bits in the int_vector.")
+        .def_property_readonly(
+            "bit_size",
+            locking::reading([](const T& self) { return self.bit_size(); }),
+            "The number of bits in the int_vector.",
+            py::call_guard<py::gil_scoped_release>())
 
-        .def("resize", &T::resize,
-             "Resize the int_vector in terms of elements.")
-        .def("bit_resize", &T::bit_resize,
-             "Resize the int_vector in terms of bits.")
-        .def_property_readonly("capacity", &T::capacity, doc_capacity)
+        .def("resize",
+             locking::writing([](T &self, size_t size) {
+                 self.resize(size); }),
+             "Resize the int_vector in terms of elements.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("bit_resize",
+             locking::writing([](T &self, size_t size) {
+                 self.bit_resize(size); }),
+             "Resize the int_vector in terms of bits.",
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly(
+            "capacity",
+            locking::reading([](const T& self) { return self.capacity(); }),
+            doc_capacity,
+            py::call_guard<py::gil_scoped_release>())
 
         .def(
             "__setitem__",
-            [](T &self, size_t position, S value) {
+            locking::writing([](T &self, size_t position, S value) {
                 if (position >= self.size()) {
                     throw std::out_of_range(std::to_string(position)); }
-                self[position] = value; })
+                self[position] = value; }),
+            py::call_guard<py::gil_scoped_release>())
 
         .def("set_to_id",
-             [](T &self) { sdsl::util::set_to_id(self); },
+             locking::writing([](T &self) { sdsl::util::set_to_id(self); }),
              py::call_guard<py::gil_scoped_release>(),
              "Sets each entry of the vector at position `i` to value `i`")
         .def("set_to_value",
-             [](T &self, S value) { sdsl::util::set_to_value(self, value); },
+             locking::writing([](T &self, S value) {
+                 sdsl::util::set_to_value(self, value); }),
              py::arg("k"),
              doc_set_to_value,
              py::call_guard<py::gil_scoped_release>())
         .def("set_zero_bits",
-             [](T &self) { sdsl::util::_set_zero_bits(self); },
+             locking::writing([](T &self) {
+                 sdsl::util::_set_zero_bits(self); }),
              "Sets all bits of the int_vector to 0-bits.",
              py::call_guard<py::gil_scoped_release>())
         .def("set_one_bits",
-             [](T &self) { sdsl::util::_set_one_bits(self); },
+             locking::writing([](T &self) {
+                 sdsl::util::_set_one_bits(self); }),
              "Sets all bits of the int_vector to 1-bits.",
              py::call_guard<py::gil_scoped_release>())
         .def(
             "set_random_bits",
-            [](T &self, int seed) {
-                sdsl::util::set_random_bits(self, seed); },
+            locking::writing([](T &self, int seed) {
+                sdsl::util::set_random_bits(self, seed); }),
             py::arg_v(
                 "seed",
                 0,
@@ -129,42 +175,51 @@ inline auto add_int_class(py::module& m, py::dict& dict, KEY_T key,
         .def(
             "__imod__",
             [](T &self, uint64_t m) {
-                sdsl::util::mod(self, m);
+                {
+                    py::gil_scoped_release release;
+                    locking::unique_guard<T> lock(self);
+                    sdsl::util::mod(self, m);
+                }
                 return self; },
             py::is_operator())
 
         .def("cnt_one_bits",
-            [](const T &self) { return sdsl::util::cnt_one_bits(self); },
+            locking::reading([](const T &self) {
+                return sdsl::util::cnt_one_bits(self); }),
             "Number of set bits in vector",
             py::call_guard<py::gil_scoped_release>())
         .def("cnt_onezero_bits",
-             [](const T &self) { return sdsl::util::cnt_onezero_bits(self); },
+             locking::reading([](const T &self) {
+                 return sdsl::util::cnt_onezero_bits(self); }),
              "Number of occurrences of bit pattern `10` in vector",
              py::call_guard<py::gil_scoped_release>())
         .def("cnt_zeroone_bits",
-             [](const T &self) { return sdsl::util::cnt_zeroone_bits(self); },
+             locking::reading([](const T &self) {
+                 return sdsl::util::cnt_zeroone_bits(self); }),
              "Number of occurrences of bit pattern `01` in vector",
              py::call_guard<py::gil_scoped_release>())
 
         .def(
             "next_bit",
-            [](const T &self, size_t idx) {
+            locking::reading([](const T &self, size_t idx) {
                 if (idx >= self.bit_size()) {
                     throw std::out_of_range(std::to_string(idx)); }
-                return sdsl::util::next_bit(self, idx); },
+                return sdsl::util::next_bit(self, idx); }),
             py::arg("idx"),
             "Get the smallest position `i` >= `idx` where a bit is set",
             py::call_guard<py::gil_scoped_release>())
         .def(
             "prev_bit",
-            [](const T &self, size_t idx) {
+            locking::reading([](const T &self, size_t idx) {
                 if (idx >= self.bit_size()) {
                     throw std::out_of_range(std::to_string(idx)); }
-                return sdsl::util::prev_bit(self, idx); },
+                return sdsl::util::prev_bit(self, idx); }),
             py::arg("idx"),
             "Get the largest position `i` <= `idx` where a bit is set",
             py::call_guard<py::gil_scoped_release>());
 
+    add_int_vector_growth(cls);
+    add_store_to_archive(cls);
     add_sizes(cls);
     add_description(cls);
     add_serialization(cls);
@@ -215,27 +270,33 @@ struct add_int_vector_functor {
                     py::call_guard<py::gil_scoped_release>())
                 .def(
                     "expand_width",
-                    [](sdsl::int_vector<0> &self, size_t width) {
-                        sdsl::util::expand_width(self, width); },
+                    locking::writing(
+                        [](sdsl::int_vector<0> &self, size_t width) {
+                            sdsl::util::expand_width(self, width); }),
                     "Expands the integer width to new_width >= v.width().",
                     py::call_guard<py::gil_scoped_release>())
                 .def("bit_compress",
-                    [](sdsl::int_vector<0> &self) {
-                        sdsl::util::bit_compress(self); },
+                    locking::writing([](sdsl::int_vector<0> &self) {
+                        sdsl::util::bit_compress(self); }),
                     doc_bit_compress,
                     py::call_guard<py::gil_scoped_release>());
     }
 
     auto operator()(std::integral_constant<size_t, 1> t) {
-        return add_int_class<sdsl::int_vector<1>, bool>(
+        auto cls = add_int_class<sdsl::int_vector<1>, bool>(
                 m, int_vectors_dict, 1ul , "BitVector")
             .def(py::init(
                 [](size_t size, bool default_value) {
                     return sdsl::int_vector<1>(size, default_value, 1); }),
                 py::arg("size") = 0, py::arg("default_value") = false)
-            .def("flip", &sdsl::int_vector<1>::flip,
+            .def("flip",
+                 locking::writing([](sdsl::int_vector<1> &self) {
+                     self.flip(); }),
                  "Flip all bits of bit_vector",
                  py::call_guard<py::gil_scoped_release>());
+        add_bit_enumeration(m, cls, "BitVector");
+        add_bitvector_algebra(m, cls);
+        return cls;
     }
 };
 
@@ -273,3 +334,7 @@ inline auto add_int_vectors(py::module& m)
 
     return std::forward_as_tuple(iv, iv_as_params);
 }
+
+
+using int_vector_classes = std::decay_t<std::tuple_element_t<
+    0, decltype(add_int_vectors(std::declval<py::module&>()))>>;
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <pybind11/pybind11.h>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/util.hpp>
+
+#include "docstrings.hpp"
+#include "operations/batch.hpp"
+#include "operations/sizes.hpp"
+#include "util/bitpack.hpp"
+#include "util/locking.hpp"
+
+
+namespace py = pybind11;
+
+
+// Grows an sdsl::int_vector<> at the end. Capacity doubles when full, so
+// appends cost amortized O(1) reallocation; the vector is only shrunk to
+// its size (in place) when finished. The width grows when a value does
+// not fit, at least doubling.
+class int_vector_builder
+{
+public:
+    typedef uint64_t size_type;
+
+private:
+    // its size is the capacity of the builder
+    sdsl::int_vector<> m_vector;
+    size_type m_size = 0;
+    uint8_t m_width;
+
+    void reserve(size_type n)
+    {
+        if (n <= m_vector.size()) return;
+        m_vector.resize(std::max<size_type>(
+            n, std::max<size_type>(2 * m_vector.size(), 64)));
+    }
+
+    void fit(uint8_t bits)
+    {
+        if (bits <= m_vector.width()) return;
+        sdsl::util::expand_width(
+            m_vector, std::max<uint8_t>(
+                bits, std::min<unsigned>(64, 2 * m_vector.width())));
+    }
+
+public:
+    explicit int_vector_builder(uint8_t width = 64, size_type capacity = 0):
+        m_vector(capacity, 0, width),
+        m_width(width)
+    {}
+
+    size_type size() const { return m_size; }
+
+    size_type capacity() const { return m_vector.size(); }
+
+    uint8_t width() const { return m_vector.width(); }
+
+    void append(uint64_t value)
+    {
+        fit(detail::bits_needed(&value, 1));
+        reserve(m_size + 1);
+        m_vector[m_size++] = value;
+    }
+
+    void append(const uint64_t* values, size_type n)
+    {
+        fit(detail::bits_needed(values, n));
+        reserve(m_size + n);
+        detail::pack_values(m_vector.data(), m_size * m_vector.width(),
+                            values, n, m_vector.width());
+        m_size += n;
+    }
+
+    // Moves the built vector out and starts over empty
+    sdsl::int_vector<> finish(bool bit_compress)
+    {
+        m_vector.resize(m_size);
+        if (bit_compress) sdsl::util::bit_compress(m_vector);
+        sdsl::int_vector<> result(std::move(m_vector));
+        m_vector = sdsl::int_vector<>(0, 0, m_width);
+        m_size = 0;
+        return result;
+    }
+};
+
+
+namespace locking
+{
+    template <>
+    struct is_mutable<int_vector_builder>: std::true_type {};
+}  // namespace locking
+
+
+namespace detail
+{
+    // Appends n values to an int_vector with a single resize
+    template <class T>
+    inline void append_values(T& self, const uint64_t* values, size_t n)
+    {
+        if (bits_needed(values, n) > self.width()) {
+            throw std::invalid_argument(
+                "values do not fit in " + std::to_string(self.width()) +
+                " bits"); }
+        const auto size = self.size();
+        self.resize(size + n);
+        pack_values(self.data(), size * self.width(), values, n,
+                    self.width());
+    }
+}  // namespace detail
+
+
+// append/extend of int_vector classes
+template <class T>
+inline auto add_int_vector_growth(py::class_<T>& cls)
+{
+    cls.def(
+        "append",
+        locking::writing([] (T& self, uint64_t value) {
+            detail::append_values(self, &value, 1); }),
+        py::arg("value"),
+        "Appends a value. Every call reallocates: use extend or "
+        "IntVectorBuilder to append many values.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "extend",
+        [] (T& self, const input_array<uint64_t>& values) {
+            detail::check_1d(values, "values");
+            const uint64_t* data = values.data();
+            const size_t n = values.shape(0);
+            py::gil_scoped_release release;
+            locking::unique_guard<T> guard(self);
+            detail::append_values(self, data, n); },
+        py::arg("values"),
+        "Appends an array (or any buffer or sequence) of values with one "
+        "reallocation. Values should fit in the width of the vector.");
+    return cls;
+}
+
+
+inline auto add_int_vector_builder(py::module& m)
+{
+    typedef int_vector_builder T;
+
+    auto cls = py::class_<T>(m, "IntVectorBuilder");
+
+    cls.def(py::init<uint8_t, T::size_type>(),
+            py::arg("width") = 64, py::arg("capacity") = 0,
+            "Empty builder of an IntVector of `width` bits, with room for "
+            "`capacity` values.");
+
+    add_sizes(cls);
+
+    cls.def_property_readonly(
+        "capacity",
+        locking::reading([] (const T& self) { return self.capacity(); }),
+        "Number of values the builder holds without reallocating",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def_property_readonly(
+        "width",
+        locking::reading([] (const T& self) { return self.width(); }),
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "append",
+        locking::writing([] (T& self, uint64_t value) {
+            self.append(value); }),
+        py::arg("value"),
+        "Appends a value, amortized O(1)",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "extend",
+        [] (T& self, const input_array<uint64_t>& values) {
+            detail::check_1d(values, "values");
+            const uint64_t* data = values.data();
+            const size_t n = values.shape(0);
+            py::gil_scoped_release release;
+            locking::unique_guard<T> guard(self);
+            self.append(data, n); },
+        py::arg("values"),
+        "Appends an array (or any buffer or sequence) of values, packing "
+        "them a word at a time");
+    cls.def(
+        "finish",
+        locking::writing([] (T& self, bool bit_compress) {
+            return self.finish(bit_compress); }),
+        py::arg("bit_compress") = true,
+        "Returns the built IntVector without copying it (bit compressed "
+        "in place unless bit_compress = False) and empties the builder",
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.doc() = doc_int_vector_builder;
+
+    return cls;
+}
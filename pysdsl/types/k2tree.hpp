@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <sdsl/k2_tree.hpp>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+#include "docstrings.hpp"
+#include "io.hpp"
+#include "operations/batch.hpp"
+#include "util/parallel.hpp"
+
+
+namespace py = pybind11;
+
+
+// sdsl::k2_tree extended with a concurrent bulk constructor, the number of
+// nodes and range reporting. Edges are sorted by their k-ary Z-order key:
+// every level of the tree is then the sequence of distinct key prefixes,
+// so all levels can be emitted independently.
+template <uint8_t k>
+class k2_graph: public sdsl::k2_tree<k>
+{
+    static_assert(k == 2 || k == 4, "Z-order keys must fit 64 bits");
+
+    typedef sdsl::k2_tree<k> base;
+
+    static constexpr uint8_t digit_bits = k == 2 ? 1 : 2;
+
+public:
+    typedef typename base::idx_type idx_type;
+    typedef typename base::size_type size_type;
+
+    k2_graph() = default;
+
+    k2_graph(const uint64_t* src, const uint64_t* dst, size_t edges,
+             size_type nodes, size_t threads = 0): m_nodes(nodes)
+    {
+        if (nodes > (size_type(1) << 32)) {
+            throw std::invalid_argument("k2 tree supports up to 2**32 nodes"); }
+
+        uint16_t height = 1;
+        while ((size_type(1) << (digit_bits * height)) < nodes) height++;
+        this->k_k = k;
+        this->k_height = height;
+
+        std::vector<uint64_t> keys(edges);
+        parallel_for(edges, threads, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (src[i] >= nodes || dst[i] >= nodes) {
+                    throw std::out_of_range(
+                        "edge (" + std::to_string(src[i]) + ", " +
+                        std::to_string(dst[i]) + ") is out of range"); }
+                keys[i] = z_key(src[i], dst[i], height); }
+        });
+        parallel_sort(keys.begin(), keys.end(), threads);
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        if (keys.empty()) {
+            this->k_t = sdsl::bit_vector(0);
+            this->k_l = sdsl::bit_vector(0);
+            sdsl::util::init_support(this->k_t_rank, &this->k_t);
+            return; }
+
+        std::vector<sdsl::bit_vector> levels(height);
+        parallel_for_each_index(height, threads, [&] (size_t level) {
+            levels[level] = emit_level(keys, level, height); });
+
+        size_type t_size = 0;
+        for (uint16_t l = 0; l + 1 < height; l++) t_size += levels[l].size();
+
+        this->k_t = sdsl::bit_vector(t_size, 0);
+        size_type offset = 0;
+        for (uint16_t l = 0; l + 1 < height; l++) {
+            copy_bits(levels[l], this->k_t, offset);
+            offset += levels[l].size();
+            sdsl::util::clear(levels[l]); }
+        this->k_l = std::move(levels[height - 1]);
+        sdsl::util::init_support(this->k_t_rank, &this->k_t);
+    }
+
+    size_type size() const { return m_nodes; }
+
+    size_type edges() const { return sdsl::util::cnt_one_bits(this->k_l); }
+
+    // All edges (row, col) with row in [x1..x2] and col in [y1..y2]
+    void range(idx_type x1, idx_type x2, idx_type y1, idx_type y2,
+               std::vector<idx_type>& rows, std::vector<idx_type>& cols) const
+    {
+        if (this->k_l.size() == 0) return;
+        const size_type n = size_type(1) << (digit_bits * this->k_height);
+        range_rec(n, x1, x2, y1, y2, 0, 0, -1, rows, cols);
+    }
+
+    size_type serialize(std::ostream& out,
+                        sdsl::structure_tree_node* v = nullptr,
+                        std::string name = "") const
+    {
+        auto child = sdsl::structure_tree::add_child(
+            v, name, sdsl::util::class_name(*this));
+        size_type written_bytes = 0;
+        written_bytes += base::serialize(out, child, "k2_tree");
+        written_bytes += sdsl::write_member(m_nodes, out, child, "nodes");
+        sdsl::structure_tree::add_size(child, written_bytes);
+        return written_bytes;
+    }
+
+    void load(std::istream& in)
+    {
+        base::load(in);
+        sdsl::read_member(m_nodes, in);
+    }
+
+private:
+    static uint64_t z_key(uint64_t row, uint64_t col, uint16_t height)
+    {
+        uint64_t key = 0;
+        for (int d = height - 1; d >= 0; d--) {
+            const uint64_t r = (row >> (digit_bits * d)) & (k - 1);
+            const uint64_t c = (col >> (digit_bits * d)) & (k - 1);
+            key = (key << (2 * digit_bits)) | (r * k + c); }
+        return key;
+    }
+
+    // k*k bits for every distinct key prefix of `level` digits
+    static sdsl::bit_vector emit_level(const std::vector<uint64_t>& keys,
+                                       size_t level, uint16_t height)
+    {
+        const unsigned child_shift = 2 * digit_bits * (height - level - 1);
+        const unsigned parent_shift = child_shift + 2 * digit_bits;
+
+        size_type parents = 1;
+        for (size_t i = 1; level > 0 && i < keys.size(); i++) {
+            if ((keys[i] >> parent_shift) != (keys[i - 1] >> parent_shift)) {
+                parents++; }
+        }
+
+        sdsl::bit_vector bits(parents * k * k, 0);
+        size_type block = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (i > 0 && level > 0 &&
+                    (keys[i] >> parent_shift) != (keys[i - 1] >> parent_shift)) {
+                block++; }
+            bits[block * k * k + ((keys[i] >> child_shift) & (k * k - 1))] = 1;
+        }
+        return bits;
+    }
+
+    static void copy_bits(const sdsl::bit_vector& from, sdsl::bit_vector& to,
+                          size_type offset)
+    {
+        size_type i = 0;
+        for (; i + 64 <= from.size(); i += 64) {
+            to.set_int(offset + i, from.get_int(i, 64), 64); }
+        if (i < from.size()) {
+            const uint8_t len = from.size() - i;
+            to.set_int(offset + i, from.get_int(i, len), len); }
+    }
+
+    void range_rec(size_type n, idx_type p1, idx_type p2, idx_type q1,
+                   idx_type q2, idx_type dp, idx_type dq, int64_t x,
+                   std::vector<idx_type>& rows,
+                   std::vector<idx_type>& cols) const
+    {
+        const int64_t t_size = this->k_t.size();
+        if (x >= t_size) {
+            if (this->k_l[x - t_size]) {
+                rows.push_back(dp);
+                cols.push_back(dq); }
+            return; }
+        if (x >= 0 && !this->k_t[x]) return;
+
+        const int64_t y = x < 0 ? 0 : this->k_t_rank(x + 1) * k * k;
+        const size_type sub = n / k;
+        for (idx_type i = p1 / sub; i <= p2 / sub; i++) {
+            const idx_type p1_ = i == p1 / sub ? p1 % sub : 0;
+            const idx_type p2_ = i == p2 / sub ? p2 % sub : sub - 1;
+            for (idx_type j = q1 / sub; j <= q2 / sub; j++) {
+                const idx_type q1_ = j == q1 / sub ? q1 % sub : 0;
+                const idx_type q2_ = j == q2 / sub ? q2 % sub : sub - 1;
+                range_rec(sub, p1_, p2_, q1_, q2_, dp + sub * i, dq + sub * j,
+                          y + k * i + j, rows, cols);
+            }
+        }
+    }
+
+    size_type m_nodes = 0;
+};
+
+
+template <uint8_t k>
+inline auto add_k2_tree(py::module& m)
+{
+    typedef k2_graph<k> T;
+    typedef typename T::idx_type idx_type;
+
+    const auto name = "K2Tree" + std::to_string(k);
+
+    auto check_node = [] (const T& self, idx_type u) {
+        if (u >= self.size()) {
+            throw std::out_of_range(std::to_string(u)); }
+    };
+
+    auto cls = py::class_<T>(m, name.c_str())
+        .def(py::init())
+        .def(py::init(
+            [] (const input_array<>& src, const input_array<>& dst,
+                typename T::size_type nodes, size_t threads) {
+                detail::check_1d(src, "src");
+                detail::check_1d(dst, "dst");
+                if (src.shape(0) != dst.shape(0)) {
+                    throw std::invalid_argument("src and dst should have "
+                                                "equal length"); }
+                const uint64_t* s = src.data();
+                const uint64_t* d = dst.data();
+                const size_t edges = src.shape(0);
+
+                py::gil_scoped_release release;
+                if (nodes == 0) {
+                    for (size_t i = 0; i < edges; i++) {
+                        nodes = std::max<uint64_t>(nodes,
+                                                   std::max(s[i], d[i]) + 1); }
+                }
+                return T(s, d, edges, nodes, threads); }),
+            py::arg("src"), py::arg("dst"), py::arg("nodes") = 0,
+            py::arg("threads") = 0,
+            "Build from edge arrays `src` and `dst` on `threads` threads "
+            "(0 means all hardware threads). `nodes` defaults to the largest "
+            "node id plus one.")
+        .def_property_readonly("k", [] (const T&) { return k; })
+        .def_property_readonly("nodes", &T::size, "The number of nodes.")
+        .def_property_readonly("edges", &T::edges,
+                               "The number of distinct edges.")
+        .def(
+            "adj",
+            [check_node] (const T& self, idx_type u, idx_type v) {
+                check_node(self, u);
+                check_node(self, v);
+                return self.adj(u, v); },
+            py::arg("u"), py::arg("v"),
+            "Whether there is an edge from `u` to `v`.",
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "neighbors",
+            [check_node] (const T& self, idx_type u) {
+                check_node(self, u);
+                std::vector<idx_type> result;
+                {
+                    py::gil_scoped_release release;
+                    result = self.neigh(u);
+                }
+                return detail::to_numpy(result); },
+            py::arg("u"),
+            "Targets of all edges leaving `u` as numpy array.")
+        .def(
+            "reverse_neighbors",
+            [check_node] (const T& self, idx_type v) {
+                check_node(self, v);
+                std::vector<idx_type> result;
+                {
+                    py::gil_scoped_release release;
+                    result = self.reverse_neigh(v);
+                }
+                return detail::to_numpy(result); },
+            py::arg("v"),
+            "Sources of all edges entering `v` as numpy array.")
+        .def(
+            "neighbors_many",
+            [check_node] (const T& self, const input_array<>& us,
+                          size_t threads) {
+                detail::check_1d(us, "us");
+                const size_t n = us.shape(0);
+                const uint64_t* u = us.data();
+                for (size_t i = 0; i < n; i++) check_node(self, u[i]);
+
+                std::vector<std::vector<idx_type>> lists(n);
+                py::array_t<uint64_t> offsets(n + 1);
+                uint64_t* off = offsets.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    parallel_for_each_index(n, threads, [&] (size_t i) {
+                        lists[i] = self.neigh(u[i]); });
+                    off[0] = 0;
+                    for (size_t i = 0; i < n; i++) {
+                        off[i + 1] = off[i] + lists[i].size(); }
+                }
+                py::array_t<uint64_t> targets(off[n]);
+                uint64_t* out = targets.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    parallel_for_each_index(n, threads, [&] (size_t i) {
+                        std::copy(lists[i].begin(), lists[i].end(),
+                                  out + off[i]); });
+                }
+                return std::make_pair(offsets, targets); },
+            py::arg("us"), py::arg("threads") = 0,
+            "Neighbors of every node of `us` in CSR form: a pair of arrays "
+            "(offsets, targets) where the neighbors of us[i] are "
+            "targets[offsets[i]:offsets[i + 1]].")
+        .def(
+            "range",
+            [check_node] (const T& self, idx_type x1, idx_type x2,
+                          idx_type y1, idx_type y2) {
+                check_node(self, x2);
+                check_node(self, y2);
+                if (x1 > x2 || y1 > y2) {
+                    throw std::invalid_argument("empty range"); }
+                std::vector<idx_type> rows, cols;
+                {
+                    py::gil_scoped_release release;
+                    self.range(x1, x2, y1, y2, rows, cols);
+                }
+                return std::make_pair(detail::to_numpy(rows),
+                                      detail::to_numpy(cols)); },
+            py::arg("x1"), py::arg("x2"), py::arg("y1"), py::arg("y2"),
+            "All edges (u, v) with u in [x1..x2] and v in [y1..y2] as a pair "
+            "of numpy arrays (sources, targets).");
+
+    add_description(cls);
+    add_serialization(cls);
+
+    cls.doc() = doc_k2_tree;
+
+    m.attr("k2_trees").attr("__setitem__")(k, cls);
+
+    return cls;
+}
+
+
+inline auto add_k2_trees(py::module& m)
+{
+    m.attr("k2_trees") = py::dict();
+
+    auto classes = std::make_tuple(add_k2_tree<2>(m), add_k2_tree<4>(m));
+
+    m.attr("K2Tree") = m.attr("K2Tree2");
+
+    return classes;
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/io.hpp>
+#include <sdsl/suffix_arrays.hpp>
+
+#include "docstrings.hpp"
+#include "suffixarray_build.hpp"
+#include "util/parallel.hpp"
+
+
+namespace py = pybind11;
+
+
+// Texts indexed by independent suffix arrays of type T, one serialized
+// per file. Shards are loaded on first use (concurrent users wait for the
+// same load) and queries run on every shard concurrently. Positions are
+// global: the texts are numbered as if concatenated, shard after shard,
+// but occurrences never cross a shard boundary.
+template <class T>
+class sharded_csa
+{
+public:
+    typedef uint64_t size_type;
+    typedef typename T::string_type string_type;
+
+private:
+    std::vector<std::string> m_files;
+    // text lengths given up front (empty if unknown), checked on load
+    std::vector<size_type> m_lengths;
+    size_t m_threads;
+
+    mutable std::vector<std::unique_ptr<T>> m_shards;
+    mutable std::unique_ptr<std::once_flag[]> m_load;
+    mutable std::unique_ptr<std::atomic<bool>[]> m_loaded;
+
+    // start of every shard's text and the total length, known up front
+    // or once every shard is loaded
+    mutable std::vector<size_type> m_offsets;
+    std::unique_ptr<std::once_flag> m_measure;
+
+    void set_offsets(const std::vector<size_type>& lengths) const
+    {
+        m_offsets.assign(1, 0);
+        for (auto length: lengths) {
+            m_offsets.push_back(m_offsets.back() + length); }
+    }
+
+    const std::vector<size_type>& offsets() const
+    {
+        std::call_once(*m_measure, [this] () {
+            load();
+            std::vector<size_type> lengths;
+            for (const auto& csa: m_shards) {
+                lengths.push_back(csa->size() - 1); }
+            set_offsets(lengths); });
+        return m_offsets;
+    }
+
+public:
+    sharded_csa(std::vector<std::string> files,
+                const std::vector<size_type>& lengths, size_t threads):
+        m_files(std::move(files)),
+        m_lengths(lengths),
+        m_threads(threads),
+        m_shards(m_files.size()),
+        m_load(new std::once_flag[m_files.size()]),
+        m_loaded(new std::atomic<bool>[m_files.size()]),
+        m_measure(new std::once_flag())
+    {
+        for (size_t k = 0; k < m_files.size(); k++) m_loaded[k] = false;
+        if (lengths.empty() && !m_files.empty()) return;
+        if (lengths.size() != m_files.size()) {
+            throw std::invalid_argument(
+                "lengths should be given for every shard"); }
+        std::call_once(*m_measure, [&] () { set_offsets(lengths); });
+    }
+
+    // Builds an index of every text concurrently and stores it to the
+    // corresponding file
+    static sharded_csa build(const std::vector<string_type>& texts,
+                             std::vector<std::string> files, size_t threads)
+    {
+        if (texts.size() != files.size()) {
+            throw std::invalid_argument(
+                "there should be one file per text"); }
+        std::vector<size_type> lengths(texts.size());
+        parallel_for_each_index(texts.size(), threads, [&] (size_t k) {
+            const T csa = detail::in_memory_builder<T>::build(
+                texts[k].begin(), texts[k].end());
+            if (!sdsl::store_to_file(csa, files[k])) {
+                throw std::runtime_error("cannot store " + files[k]); }
+            lengths[k] = csa.size() - 1; });
+        return sharded_csa(std::move(files), lengths, threads);
+    }
+
+    size_t shards() const { return m_files.size(); }
+
+    const std::vector<std::string>& files() const { return m_files; }
+
+    size_t threads() const { return m_threads; }
+
+    size_type size() const { return offsets().back(); }
+
+    std::vector<size_type> lengths() const
+    {
+        const auto& starts = offsets();
+        std::vector<size_type> result;
+        for (size_t k = 0; k + 1 < starts.size(); k++) {
+            result.push_back(starts[k + 1] - starts[k]); }
+        return result;
+    }
+
+    bool loaded(size_t k) const { return m_loaded[k]; }
+
+    const T& shard(size_t k) const
+    {
+        std::call_once(m_load[k], [this, k] () {
+            std::unique_ptr<T> csa(new T());
+            if (!sdsl::load_from_file(*csa, m_files[k])) {
+                throw std::runtime_error("cannot load " + m_files[k]); }
+            // offsets were computed from the given lengths, a wrong one
+            // would shift every position and read past the shard
+            if (!m_lengths.empty() && csa->size() - 1 != m_lengths[k]) {
+                throw std::invalid_argument(
+                    m_files[k] + " holds a text of length " +
+                    std::to_string(csa->size() - 1) + ", not " +
+                    std::to_string(m_lengths[k])); }
+            m_shards[k] = std::move(csa);
+            m_loaded[k] = true; });
+        return *m_shards[k];
+    }
+
+    void load() const
+    {
+        parallel_for_each_index(shards(), m_threads, [this] (size_t k) {
+            shard(k); });
+    }
+
+    size_type count(const string_type& pattern) const
+    {
+        std::vector<size_type> counts(shards());
+        parallel_for_each_index(shards(), m_threads, [&] (size_t k) {
+            counts[k] = sdsl::count(shard(k), pattern); });
+        size_type result = 0;
+        for (auto c: counts) result += c;
+        return result;
+    }
+
+    // Global positions of the occurrences, sorted
+    sdsl::int_vector<64> locate(const string_type& pattern) const
+    {
+        const auto& starts = offsets();
+        std::vector<sdsl::int_vector<64>> found(shards());
+        parallel_for_each_index(shards(), m_threads, [&] (size_t k) {
+            found[k] = sdsl::locate(shard(k), pattern);
+            std::sort(found[k].begin(), found[k].end());
+            for (auto it = found[k].begin(); it != found[k].end(); ++it) {
+                *it = *it + starts[k]; } });
+        size_type total = 0;
+        for (const auto& part: found) total += part.size();
+        sdsl::int_vector<64> result(total);
+        auto out = result.begin();
+        for (const auto& part: found) {
+            out = std::copy(part.begin(), part.end(), out); }
+        return result;
+    }
+
+    // Global text [begin..end] (inclusive)
+    string_type extract(size_type begin, size_type end) const
+    {
+        const auto& starts = offsets();
+        if (end >= starts.back()) {
+            throw std::out_of_range(std::to_string(end)); }
+        if (begin > end) {
+            throw std::invalid_argument(
+                "begin should be less or equal than end"); }
+        // shards [first..last) hold the range
+        const size_t first = std::upper_bound(
+            starts.begin(), starts.end(), begin) - starts.begin() - 1;
+        const size_t last = std::upper_bound(
+            starts.begin(), starts.end(), end) - starts.begin();
+        std::vector<string_type> parts(last - first);
+        parallel_for_each_index(parts.size(), m_threads, [&] (size_t i) {
+            const size_t k = first + i;
+            if (starts[k] == starts[k + 1]) return;
+            const size_type from = std::max(begin, starts[k]) - starts[k];
+            const size_type to = std::min(end, starts[k + 1] - 1) - starts[k];
+            parts[i] = sdsl::extract(shard(k), from, to); });
+        string_type result;
+        result.resize(end - begin + 1);
+        auto out = result.begin();
+        for (const auto& part: parts) {
+            out = std::copy(part.begin(), part.end(), out); }
+        return result;
+    }
+};
+
+
+template <class T>
+inline auto add_sharded_csa_class(py::module& m, const std::string& name)
+{
+    typedef sharded_csa<T> S;
+    typedef typename S::size_type size_type;
+    typedef typename S::string_type string_type;
+
+    auto cls = py::class_<S>(m, ("ShardedSuffixArray" + name).c_str());
+
+    cls.def(py::init<std::vector<std::string>,
+                     const std::vector<size_type>&, size_t>(),
+            py::arg("files"), py::arg("lengths") = std::vector<size_type>(),
+            py::arg("threads") = 0,
+            "Shards stored to `files` by the suffix array class, loaded on "
+            "first use. Without the text `lengths` of the shards, every "
+            "shard is loaded as soon as global positions are needed.");
+    cls.def_static(
+        "build",
+        &S::build,
+        py::arg("texts"), py::arg("files"), py::arg("threads") = 0,
+        "Builds the index of every text concurrently on `threads` threads "
+        "(0: every hardware thread) and stores it to the corresponding file",
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.def_property_readonly("shards", &S::shards);
+    cls.def_property_readonly("files", &S::files);
+    cls.def_property_readonly("threads", &S::threads);
+    cls.def_property_readonly(
+        "lengths", &S::lengths,
+        "Text length of every shard",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def("__len__", &S::size, py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "loaded",
+        [] (const S& self, size_t k) {
+            if (k >= self.shards()) {
+                throw std::out_of_range(std::to_string(k)); }
+            return self.loaded(k); },
+        py::arg("shard"));
+    cls.def(
+        "shard",
+        [] (const S& self, size_t k) -> const T& {
+            if (k >= self.shards()) {
+                throw std::out_of_range(std::to_string(k)); }
+            return self.shard(k); },
+        py::arg("shard"),
+        "Suffix array of a shard (loaded if needed)",
+        py::return_value_policy::reference_internal,
+        py::call_guard<py::gil_scoped_release>());
+    cls.def("load", &S::load, "Loads every shard concurrently",
+            py::call_guard<py::gil_scoped_release>());
+
+    cls.def(
+        "count",
+        [] (const S& self, const string_type& pattern) {
+            return self.count(pattern); },
+        py::arg("pattern"),
+        "Total number of occurrences of a pattern in all shards",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "locate",
+        [] (const S& self, const string_type& pattern) {
+            return self.locate(pattern); },
+        py::arg("pattern"),
+        "Sorted global positions of the occurrences of a pattern",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "extract",
+        &S::extract,
+        py::arg("begin"), py::arg("end"),
+        "Global text [begin:end] (inclusive), which may span shards",
+        py::call_guard<py::gil_scoped_release>());
+
+    cls.def(py::pickle(
+        [] (const S& self) {
+            return py::make_tuple(self.files(), self.lengths(),
+                                  self.threads()); },
+        [] (py::tuple state) {
+            return S(state[0].cast<std::vector<std::string>>(),
+                     state[1].cast<std::vector<size_type>>(),
+                     state[2].cast<size_t>()); }));
+
+    cls.doc() = doc_sharded_csa;
+
+    m.attr("sharded_suffix_array").attr("__setitem__")(name, cls);
+
+    return cls;
+}
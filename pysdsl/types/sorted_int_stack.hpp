@@ -1,53 +1,345 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 
+#include <sdsl/bits.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/sd_vector.hpp>
 #include <sdsl/util.hpp>
 #include <sdsl/sorted_int_stack.hpp>
 
 #include "calc.hpp"
 #include "io.hpp"
+#include "operations/batch.hpp"
 #include "operations/iteration.hpp"
 #include "operations/sizes.hpp"
 #include "docstrings.hpp"
+#include "util/locking.hpp"
 
 
 namespace py = pybind11;
 
 
+namespace detail
+{
+    // sorted_int_stack keeps its state private. Its serialization is
+    // read instead, word by word as it is written: max_value, the top
+    // and the number of elements, then the blocks of the stack as an
+    // int_vector<64> (its length in bits, then the words).
+    enum stack_word: size_t
+    {
+        stack_max_value_word = 0,
+        stack_top_word = 1,
+        stack_size_word = 2,
+        stack_bits_word = 3,
+        stack_blocks_word = 4
+    };
+
+    // Element x is bit x % 63 of block x / 63 + 1, block 0 only holds a
+    // sentinel. An empty block right below a used one holds the
+    // previous top with bit 63 set instead of elements.
+    constexpr uint64_t stack_block_bits = 63;
+    constexpr uint64_t stack_pointer_bit = 1ULL << 63;
+
+    // Hands the words written to it to visit(index, word) and fails the
+    // stream once visit returns false
+    template <class Visit>
+    class word_streambuf: public std::streambuf
+    {
+    public:
+        explicit word_streambuf(Visit& visit): m_visit(visit) { reset(); }
+
+        // Visits the words left in the buffer
+        void finish() { consume(); }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (!consume()) return traits_type::eof();
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+    private:
+        static constexpr size_t buffer_words = 512;
+
+        Visit& m_visit;
+        uint64_t m_buffer[buffer_words];
+        size_t m_index = 0;
+        bool m_done = false;
+
+        void reset()
+        {
+            char* begin = reinterpret_cast<char*>(m_buffer);
+            setp(begin, begin + sizeof(m_buffer));
+        }
+
+        bool consume()
+        {
+            const size_t n = (pptr() - pbase()) / sizeof(uint64_t);
+            for (size_t i = 0; i < n && !m_done; i++) {
+                m_done = !m_visit(m_index++, m_buffer[i]); }
+            reset();
+            return !m_done;
+        }
+    };
+
+    template <class Visit>
+    inline void visit_stack_words(const sdsl::sorted_int_stack& stack,
+                                  Visit& visit)
+    {
+        word_streambuf<Visit> buffer(visit);
+        std::ostream out(&buffer);
+        stack.serialize(out);
+        buffer.finish();
+    }
+
+    inline void stack_layout_error(const std::string& what)
+    {
+        throw std::runtime_error(
+            "unexpected SortedIntStack serialization: " + what);
+    }
+
+    // The words before the blocks, checked against the stack before
+    // the blocks are trusted: max_value and the top have to fit in the
+    // blocks that follow
+    class stack_header
+    {
+    public:
+        explicit stack_header(const sdsl::sorted_int_stack& stack):
+            m_stack(stack) {}
+
+        // Keeps header word i, checks them all once the last is read
+        void read(size_t i, uint64_t word)
+        {
+            m_words[i] = word;
+            if (i + 1 < stack_blocks_word) return;
+            if (size() != m_stack.size()) {
+                stack_layout_error("size " + std::to_string(size())); }
+            if (m_words[stack_bits_word] % 64 != 0 ||
+                blocks() < max_value() / stack_block_bits + 2) {
+                stack_layout_error(
+                    std::to_string(blocks()) + " blocks for max_value " +
+                    std::to_string(max_value())); }
+            if (top() > max_value() + stack_block_bits) {
+                stack_layout_error("top " + std::to_string(top())); }
+        }
+
+        uint64_t max_value() const { return m_words[stack_max_value_word]; }
+        // bit of the top in the blocks, i.e. offset by block 0
+        uint64_t top() const { return m_words[stack_top_word]; }
+        uint64_t size() const { return m_words[stack_size_word]; }
+        uint64_t blocks() const { return m_words[stack_bits_word] / 64; }
+
+    private:
+        const sdsl::sorted_int_stack& m_stack;
+        uint64_t m_words[stack_blocks_word] = {};
+    };
+
+    // The largest value the stack takes
+    inline uint64_t stack_max_value(const sdsl::sorted_int_stack& stack)
+    {
+        stack_header header(stack);
+        auto visit = [&] (size_t i, uint64_t word) {
+            header.read(i, word);
+            return i + 1 < stack_blocks_word; };
+        visit_stack_words(stack, visit);
+        return header.max_value();
+    }
+
+    // Calls f with the elements in increasing order, decoded from the
+    // blocks of the stack as they are serialized: neither the stack nor
+    // its elements are copied. Throws if the number of elements decoded
+    // is not the size of the stack.
+    template <class F>
+    inline void for_each_stack_value(const sdsl::sorted_int_stack& stack,
+                                     F f)
+    {
+        stack_header header(stack);
+        uint64_t count = 0;
+        auto visit = [&] (size_t i, uint64_t word) {
+            if (i < stack_blocks_word) {
+                header.read(i, word);
+                return true; }
+            const uint64_t block = i - stack_blocks_word;
+            if (block > header.top() / stack_block_bits) return false;
+            if (block == 0 || (word & stack_pointer_bit)) return true;
+            const uint64_t base = (block - 1) * stack_block_bits;
+            for (; word; word &= word - 1, count++) {
+                f(base + sdsl::bits::lo(word)); }
+            return true; };
+        visit_stack_words(stack, visit);
+        if (count != stack.size()) {
+            stack_layout_error(std::to_string(count) + " elements decoded, "
+                               "the stack holds " +
+                               std::to_string(stack.size())); }
+    }
+
+    // Length of a bit vector of the elements, top + 1 unless given
+    inline uint64_t stack_universe(const sdsl::sorted_int_stack& stack,
+                                   uint64_t size)
+    {
+        if (stack.empty()) return size;
+        if (!size) return stack.top() + 1;
+        if (size <= stack.top()) {
+            throw std::invalid_argument(
+                "size should be greater than the top of the stack"); }
+        return size;
+    }
+
+    // The bits are set while decoding the blocks, in one pass
+    inline void from_stack(const sdsl::sorted_int_stack& stack,
+                           uint64_t size, sdsl::bit_vector& out)
+    {
+        out = sdsl::bit_vector(stack_universe(stack, size), 0);
+        for_each_stack_value(stack, [&] (uint64_t x) { out[x] = 1; });
+    }
+
+    // Elias-Fano parts written directly from the sorted elements
+    inline void from_stack(const sdsl::sorted_int_stack& stack,
+                           uint64_t size, sdsl::sd_vector<>& out)
+    {
+        sdsl::sd_vector_builder builder(stack_universe(stack, size),
+                                        stack.size());
+        for_each_stack_value(stack, [&] (uint64_t x) { builder.set(x); });
+        out = sdsl::sd_vector<>(builder);
+    }
+
+
+    // Adds construction from a SortedIntStack to BitVector or SDVector
+    class add_init_from_sorted_int_stack_functor
+    {
+    public:
+        template <class T>
+        decltype(auto) operator()(py::class_<T>& cls)
+        {
+            return cls.def(py::init(locking::reading(
+                [] (const sdsl::sorted_int_stack& stack, uint64_t size) {
+                    T result;
+                    from_stack(stack, size, result);
+                    return result; })),
+                py::arg("stack"), py::arg("size") = 0,
+                py::prepend(),
+                "Bits set at the elements of a SortedIntStack, without "
+                "pushing them through Python (size = 0: top + 1)",
+                py::call_guard<py::gil_scoped_release>());
+        }
+    };
+}  // namespace detail
+
+
 inline auto add_sorted_int_stack(py::module& m)
 {
     using Stack = sdsl::sorted_int_stack;
 
     auto cls = py::class_<Stack>(m, "SortedIntStack")
-        .def("empty", &Stack::empty, "Checks whether the stack is empty.")
-        .def("top", [](const Stack& self) {
+        .def("empty",
+             locking::reading([](const Stack& self) { return self.empty(); }),
+             "Checks whether the stack is empty.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("top", locking::reading([](const Stack& self) {
             if (self.size() > 0u)
                 return self.top();
             throw py::index_error("top from empty stack");
-        }, "Returns the topmost element of the stack.")
-        .def("pop", [](Stack& self) {
+        }), "Returns the topmost element of the stack.",
+        py::call_guard<py::gil_scoped_release>())
+        .def("pop", locking::writing([](Stack& self) {
             if (self.size() == 0u)
                 throw py::index_error("pop from empty stack");
             auto ans = self.top(); 
             self.pop(); 
             return ans;
-        }, "Removes the topmost element from the stack and returns its copy. Not thread safe.")
-        .def("push", [](Stack& self, const Stack::size_type& x) {
+        }), "Removes the topmost element from the stack and returns its copy.",
+        py::call_guard<py::gil_scoped_release>())
+        .def("push", locking::writing([](Stack& self, const Stack::size_type& x) {
             if (self.empty() || self.top() < x)
                 self.push(x);
             else
                 throw py::value_error("elements have to be pushed in strictly increasing order");
-        }, "Adds new element to the top of the stack."
-           "(n.b. it has to be not less than the stored ones). Not thread safe.")
+        }), "Adds new element to the top of the stack."
+           "(n.b. it has to be not less than the stored ones).",
+        py::call_guard<py::gil_scoped_release>())
         .def(py::init([](Stack::size_type x) {
             return Stack(x);
         }), py::arg("max_value"),
         "Creates a stack which can store integers not greater than max_value.");
 
+    cls.def(
+        "push_many",
+        [] (Stack& self, const input_array<uint64_t>& values) {
+            detail::check_1d(values, "values");
+            const uint64_t* data = values.data();
+            const size_t n = values.shape(0);
+            py::gil_scoped_release release;
+            locking::unique_guard<Stack> guard(self);
+            if (!detail::strictly_increasing(data, n) ||
+                (n && !self.empty() && self.top() >= data[0])) {
+                throw py::value_error(
+                    "elements have to be pushed in strictly increasing "
+                    "order"); }
+            if (n && data[n - 1] > detail::stack_max_value(self)) {
+                throw py::value_error(
+                    "elements should not be greater than max_value"); }
+            for (size_t i = 0; i < n; i++) self.push(data[i]); },
+        py::arg("values"),
+        "Pushes a sorted array (or any buffer or sequence) of elements, "
+        "greater than the top and not greater than max_value. Both are "
+        "checked for the whole array first: nothing is pushed if it "
+        "fails.");
+    cls.def(
+        "pop_many",
+        [] (Stack& self, size_t k) {
+            std::vector<uint64_t> values;
+            {
+                py::gil_scoped_release release;
+                locking::unique_guard<Stack> guard(self);
+                if (k > self.size()) {
+                    throw py::index_error("pop from empty stack"); }
+                values.resize(k);
+                for (auto& value: values) {
+                    value = self.top();
+                    self.pop();
+                }
+            }
+            return detail::to_numpy(values); },
+        py::arg("k"),
+        "Removes the k topmost elements and returns them in the order pop "
+        "would (decreasing) as a numpy array");
+    cls.def(
+        "to_numpy",
+        [] (const Stack& self) {
+            // decoded straight into the buffer the array takes over
+            std::unique_ptr<std::vector<uint64_t>> values(
+                new std::vector<uint64_t>());
+            {
+                py::gil_scoped_release release;
+                locking::shared_guard<Stack> guard(self);
+                values->reserve(self.size());
+                detail::for_each_stack_value(
+                    self, [&] (uint64_t x) { values->push_back(x); });
+            }
+            const auto data = values->data();
+            const auto n = values->size();
+            py::capsule owner(values.get(), [] (void* p) {
+                delete static_cast<std::vector<uint64_t>*>(p); });
+            values.release();
+            return py::array_t<uint64_t>(n, data, owner); },
+        "Elements in increasing order as a numpy array, the stack is left "
+        "unchanged");
+
 
     cls.doc() = doc_sorted_int_stack;
 
@@ -13,6 +13,11 @@
 #include "docstrings.hpp"
 #include "io.hpp"
 #include "calc.hpp"
+#include "sharded_suffixarray.hpp"
+#include "suffixarray_build.hpp"
+#include "suffixarray_merge.hpp"
+#include "util/aio.hpp"
+#include "util/stats.hpp"
 
 namespace py = pybind11;
 
@@ -31,6 +36,20 @@ inline auto add_csa_member_type(py::module& m,
 }
 
 
+namespace detail
+{
+    // Instrumented pattern queries count the characters of the pattern
+    struct pattern_length
+    {
+        template <class T, class String>
+        uint64_t operator()(const T&, const String& pattern) const
+        {
+            return pattern.size();
+        }
+    };
+}  // namespace detail
+
+
 template <class T>
 inline
 auto add_csa_class(py::module& m, std::string&& name, const char* doc = nullptr)
@@ -81,13 +100,18 @@ auto add_csa_class(py::module& m, std::string&& name, const char* doc = nullptr)
 
     cls.def(
         "extract",
-        [] (const T& self, typename T::size_type begin,
-            typename T::size_type end) {
-            if (end >= detail::size(self)) {
-                throw std::out_of_range(std::to_string(end)); }
-            if (begin >= end) {
-                throw std::invalid_argument("begin should be less than end"); }
-            return sdsl::extract(self, begin, end); },
+        stats::timed(cls, "extract",
+            [] (const T& self, typename T::size_type begin,
+                typename T::size_type end) {
+                if (end >= detail::size(self)) {
+                    throw std::out_of_range(std::to_string(end)); }
+                if (begin >= end) {
+                    throw std::invalid_argument(
+                        "begin should be less than end"); }
+                return sdsl::extract(self, begin, end); },
+            [] (const T&, typename T::size_type begin,
+                typename T::size_type end) -> uint64_t {
+                return end > begin ? end - begin + 1 : 0; }),
         py::arg("begin"),
         py::arg("end"),
         "Reconstructs the subarray T[begin:end] of the original array T\n"
@@ -100,15 +124,19 @@ auto add_csa_class(py::module& m, std::string&& name, const char* doc = nullptr)
     );
     cls.def(
         "count",
-        [] (const T& self, const typename T::string_type& pattern) {
-            return sdsl::count(self, pattern); },
+        stats::timed(cls, "count",
+            [] (const T& self, const typename T::string_type& pattern) {
+                return sdsl::count(self, pattern); },
+            detail::pattern_length()),
         py::arg("pattern"),
         "Counts the number of occurrences of a pattern in a CSA",
         py::call_guard<py::gil_scoped_release>());
     cls.def(
         "locate",
-        [] (const T& self, const typename T::string_type& pattern) {
-            return sdsl::locate(self, pattern); },
+        stats::timed(cls, "locate",
+            [] (const T& self, const typename T::string_type& pattern) {
+                return sdsl::locate(self, pattern); },
+            detail::pattern_length()),
         py::arg("pattern"),
         "Calculates all occurrences of a pattern in a CSA\n"
         "Time complexity:"
@@ -118,13 +146,72 @@ auto add_csa_class(py::module& m, std::string&& name, const char* doc = nullptr)
     cls.def(py::init(
         [] (const typename T::string_type& data)
         {
-            T self;
-            sdsl::construct_im(self, data,
-                               sizeof(typename T::string_type::value_type));
-            return self;
+            return detail::in_memory_builder<T>::build(data.begin(),
+                                                       data.end());
         }
     ));
 
+    cls.def(
+        "count_async",
+        [] (py::object self, const typename T::string_type& pattern) {
+            const T& csa = self.cast<const T&>();
+            return aio::submit([&csa, pattern] () {
+                return sdsl::count(csa, pattern); }, self); },
+        py::arg("pattern"),
+        "Awaitable count(pattern), runs on the pysdsl worker pool "
+        "(see pysdsl.aio)");
+    cls.def(
+        "locate_async",
+        [] (py::object self, const typename T::string_type& pattern) {
+            const T& csa = self.cast<const T&>();
+            return aio::submit([&csa, pattern] () {
+                return sdsl::locate(csa, pattern); }, self); },
+        py::arg("pattern"),
+        "Awaitable locate(pattern), runs on the pysdsl worker pool "
+        "(see pysdsl.aio)");
+    cls.def_static(
+        "build_async",
+        [] (const typename T::string_type& data) {
+            return aio::submit([data] () {
+                return detail::in_memory_builder<T>::build(data.begin(),
+                                                           data.end()); }); },
+        py::arg("data"),
+        "Awaitable constructor, builds on the pysdsl worker pool "
+        "(see pysdsl.aio)");
+    cls.def_static(
+        "merge",
+        [] (const T& a, const T& b, size_t threads, py::object tmp_dir) {
+            // the system's temporary directory unless given
+            const std::string dir = tmp_dir.is_none() ?
+                py::module::import("tempfile").attr("gettempdir")()
+                    .cast<std::string>() :
+                tmp_dir.cast<std::string>();
+            py::gil_scoped_release release;
+            return detail::merge_csa(a, b, threads, dir); },
+        py::arg("a"), py::arg("b"), py::arg("threads") = 0,
+        py::arg("tmp_dir") = py::none(),
+        "Index of the text of `a`, symbol 1 and the text of `b`, built from "
+        "both indexes without sorting suffixes again (symbol 1 should occur "
+        "in neither text). Intermediate text, suffix array and BWT are "
+        "streamed to files in `tmp_dir` (None: the system's temporary "
+        "directory), so memory holds the gap array, one block and the "
+        "result. '@' keeps them in sdsl's RAM file system instead: faster, "
+        "but the peak then includes the whole n log n bit suffix array. "
+        "threads = 0 uses every hardware thread.");
+
+    cls.def_static(
+        "construct_im",
+        [] (const typename T::string_type& data) {
+            T result;
+            sdsl::construct_im(result, data,
+                               sizeof(typename T::string_type::value_type));
+            return result; },
+        py::arg("data"),
+        "Build with sdsl::construct_im, i.e. through a serialized copy of "
+        "`data` in sdsl's RAM file system. Kept for comparison, the "
+        "constructors write the text into the construction cache directly.",
+        py::call_guard<py::gil_scoped_release>());
+
     add_sizes(cls);
     add_description(cls);
     add_serialization(cls);
@@ -152,5 +239,12 @@ inline auto add_csa(py::module& m)
         add_csa_class<sdsl::csa_wt<>>(m, "WaveletTree", doc_csa_wt),
         add_csa_class<sdsl::csa_wt_int<>>(m, "WaveletTreeInt", doc_csa_wt));
 
+    m.attr("sharded_suffix_array") = py::dict();
+    add_sharded_csa_class<sdsl::csa_bitcompressed<>>(m, "Bitcompressed");
+    add_sharded_csa_class<sdsl::csa_sada<>>(m, "Sadakane");
+    add_sharded_csa_class<sdsl::csa_sada_int<>>(m, "SadakaneInt");
+    add_sharded_csa_class<sdsl::csa_wt<>>(m, "WaveletTree");
+    add_sharded_csa_class<sdsl::csa_wt_int<>>(m, "WaveletTreeInt");
+
     return csa_classes;
 }
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/config.hpp>
+#include <sdsl/construct.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/io.hpp>
+#include <sdsl/suffix_arrays.hpp>
+#include <sdsl/util.hpp>
+
+#include "operations/creation.hpp"
+#include "util/cache.hpp"
+
+
+// Building CSAs from a text in memory.
+//
+// sdsl::construct_im serializes the input into sdsl's RAM file system,
+// parses it back into the text, appends the terminator and stores the text
+// once more as the first file of the construction cache. Here the text is
+// written from the source values straight into the cache (KEY_TEXT), and
+// the suffix array, the BWT and the index are built from the cache as
+// sdsl::construct does: the serialized input and the parsed copy are
+// skipped. The suffix array and BWT still go through the cache in RAM, as
+// sdsl's constructors read them from there.
+namespace detail
+{
+    inline uint64_t csa_symbol(char c) { return uint8_t(c); }
+
+    template <class V>
+    inline uint64_t csa_symbol(V v) { return uint64_t(v); }
+
+
+    template <class T>
+    struct csa_in_memory_builder
+    {
+        static constexpr bool enabled = true;
+
+        template <class It>
+        static T build(It first, It last)
+        {
+            constexpr uint8_t width = T::alphabet_type::int_width;
+            typedef sdsl::key_trait<width> keys;
+
+            uint64_t n = 0, max_symbol = 1;
+            for (It it = first; it != last; ++it, n++) {
+                const uint64_t c = csa_symbol(*it);
+                if (c == 0) {
+                    throw std::invalid_argument(
+                        "text should not contain the symbol 0"); }
+                if (width == 8 && c > 255) {
+                    throw std::invalid_argument(
+                        "symbols of a byte text should be less than 256"); }
+                max_symbol = std::max(max_symbol, c);
+            }
+
+            sdsl::cache_config config(true, "@", unique_file_id());
+            cache_cleanup cleanup(config, {keys::KEY_TEXT, sdsl::conf::KEY_SA,
+                                           keys::KEY_BWT});
+            {
+                sdsl::int_vector<width> text(
+                    n + 1, 0, width ? width : sdsl::bits::hi(max_symbol) + 1);
+                uint64_t i = 0;
+                for (It it = first; it != last; ++it) {
+                    text[i++] = csa_symbol(*it); }
+                sdsl::store_to_cache(text, keys::KEY_TEXT, config);
+            }
+            sdsl::register_cache_file(keys::KEY_TEXT, config);
+            sdsl::construct_sa<width>(config);
+            sdsl::register_cache_file(sdsl::conf::KEY_SA, config);
+            sdsl::construct_bwt<width>(config);
+            sdsl::register_cache_file(keys::KEY_BWT, config);
+
+            return T(config);
+        }
+    };
+
+
+    template <>
+    struct in_memory_builder<sdsl::csa_bitcompressed<>>:
+        csa_in_memory_builder<sdsl::csa_bitcompressed<>> {};
+
+    template <>
+    struct in_memory_builder<sdsl::csa_sada<>>:
+        csa_in_memory_builder<sdsl::csa_sada<>> {};
+
+    template <>
+    struct in_memory_builder<sdsl::csa_sada_int<>>:
+        csa_in_memory_builder<sdsl::csa_sada_int<>> {};
+
+    template <>
+    struct in_memory_builder<sdsl::csa_wt<>>:
+        csa_in_memory_builder<sdsl::csa_wt<>> {};
+
+    template <>
+    struct in_memory_builder<sdsl::csa_wt_int<>>:
+        csa_in_memory_builder<sdsl::csa_wt_int<>> {};
+}  // namespace detail
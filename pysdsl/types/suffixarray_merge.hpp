@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sdsl/config.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/int_vector_buffer.hpp>
+#include <sdsl/io.hpp>
+#include <sdsl/suffix_arrays.hpp>
+#include <sdsl/util.hpp>
+
+#include "util/cache.hpp"
+#include "util/parallel.hpp"
+
+
+// Merging the suffix arrays of texts A and B into the suffix array of
+// A 1 B (1 separates the texts and must occur in neither of them).
+//
+// The suffixes of A keep their relative order in the merged text because
+// the separator is smaller than any character of A, just like A's
+// terminator; the same holds for B. So only the interleaving is computed:
+// the gap array, whose entry r counts the suffixes of B preceded by
+// exactly r suffixes of A. It is filled by one backward pass over B,
+// which maps every suffix of B to its rank among A's suffixes with a
+// backward search step in A (Ferragina, Gagie, Manzini). The merged
+// suffix array, BWT and text are then streamed block by block (entries of
+// a block are looked up on many threads) into sdsl's construction cache,
+// from which the index is built as by sdsl::construct: no suffix is
+// sorted again and memory holds the gap array and one block.
+namespace detail
+{
+    template <class T>
+    inline bool has_separator(const T& csa)
+    {
+        // comp2char is sorted and comp 0 is the terminator
+        return csa.sigma > 1 && csa.comp2char[1] == 1;
+    }
+
+
+    // Number of suffixes of `csa` smaller than the suffix cX, where X is
+    // preceded by r of them. Characters missing from csa's alphabet are
+    // placed between their neighbours.
+    template <class T>
+    inline uint64_t backward_step(const T& csa, uint64_t r, uint64_t c)
+    {
+        uint64_t lo = 0, hi = csa.sigma;
+        while (lo < hi) {
+            const uint64_t mid = (lo + hi) / 2;
+            if (csa.comp2char[mid] < c) lo = mid + 1; else hi = mid; }
+        if (lo < csa.sigma && csa.comp2char[lo] == c) {
+            return csa.C[lo] + csa.bwt.rank(r, c); }
+        return csa.C[lo];
+    }
+
+
+    template <class T>
+    inline sdsl::int_vector<> gap_array(const T& a, const T& b)
+    {
+        sdsl::int_vector<> gaps(a.size() + 1, 0,
+                                sdsl::bits::hi(b.size()) + 1);
+        // B's terminator is the smallest suffix of the merged text
+        uint64_t r = 0, p = 0;
+        gaps[0] = 1;
+        for (uint64_t j = 1; j < b.size(); j++) {
+            r = backward_step(a, r, b.bwt[p]);
+            p = b.lf[p];
+            gaps[r] = gaps[r] + 1;
+        }
+        return gaps;
+    }
+
+
+    constexpr uint64_t merge_block = 1 << 20;
+
+
+    template <class T, class Buffer>
+    inline void append_text(Buffer& out, const T& csa, size_t threads)
+    {
+        const uint64_t length = csa.size() - 1;
+        threads = resolve_threads(threads);
+        std::vector<typename T::string_type> parts(threads);
+        for (uint64_t begin = 0; begin < length;
+             begin += merge_block * threads) {
+            parallel_for_each_index(threads, threads, [&] (size_t t) {
+                const uint64_t first = begin + t * merge_block;
+                const uint64_t last = std::min(length, first + merge_block);
+                parts[t] = first < last ?
+                    sdsl::extract(csa, first, last - 1) :
+                    typename T::string_type(); });
+            for (const auto& part: parts) {
+                for (auto c: part) out.push_back(uint64_t(
+                    static_cast<typename T::char_type>(c))); }
+        }
+    }
+
+
+    template <class T>
+    inline T merge_csa(const T& a, const T& b, size_t threads,
+                       const std::string& dir)
+    {
+        constexpr uint8_t width = T::alphabet_type::int_width;
+        typedef sdsl::key_trait<width> keys;
+
+        if (has_separator(a) || has_separator(b)) {
+            throw std::invalid_argument(
+                "texts should not contain the separator symbol 1"); }
+
+        const uint64_t n = a.size() + b.size();
+        const uint64_t a_length = a.size() - 1;
+        const uint64_t max_symbol = std::max<uint64_t>(
+            {a.comp2char[a.sigma - 1], b.comp2char[b.sigma - 1], 1});
+        const uint8_t symbol_width = width ? width :
+                                     sdsl::bits::hi(max_symbol) + 1;
+
+        const auto gaps = gap_array(a, b);
+
+        sdsl::cache_config config(true, dir, unique_file_id());
+        cache_cleanup cleanup(config, {keys::KEY_TEXT, sdsl::conf::KEY_SA,
+                                       keys::KEY_BWT});
+        {
+            sdsl::int_vector_buffer<width> text(
+                sdsl::cache_file_name(keys::KEY_TEXT, config), std::ios::out,
+                merge_block, symbol_width);
+            append_text(text, a, threads);
+            text.push_back(1);
+            append_text(text, b, threads);
+            text.push_back(0);
+        }
+        sdsl::register_cache_file(keys::KEY_TEXT, config);
+        {
+            sdsl::int_vector_buffer<> sa(
+                sdsl::cache_file_name(sdsl::conf::KEY_SA, config),
+                std::ios::out, merge_block, sdsl::bits::hi(n) + 1);
+            sdsl::int_vector_buffer<width> bwt(
+                sdsl::cache_file_name(keys::KEY_BWT, config), std::ios::out,
+                merge_block, symbol_width);
+
+            // (from b, rank in a or b) of every merged rank of a block
+            std::vector<std::pair<bool, uint64_t>> sources;
+            std::vector<uint64_t> sa_block, bwt_block;
+            uint64_t r = 0, q = 0, pending = gaps[0];
+            while (r < a.size() || pending) {
+                sources.clear();
+                while (sources.size() < merge_block &&
+                       (r < a.size() || pending)) {
+                    if (pending) {
+                        sources.emplace_back(true, q++);
+                        pending--;
+                    } else {
+                        sources.emplace_back(false, r++);
+                        pending = gaps[r]; }
+                }
+                sa_block.resize(sources.size());
+                bwt_block.resize(sources.size());
+                parallel_for(sources.size(), threads,
+                             [&] (size_t begin, size_t end) {
+                    for (size_t k = begin; k < end; k++) {
+                        const uint64_t rank = sources[k].second;
+                        if (sources[k].first) {
+                            sa_block[k] = b[rank] + a_length + 1;
+                            // B starts after the separator
+                            const uint64_t c = b.bwt[rank];
+                            bwt_block[k] = c ? c : 1;
+                        } else {
+                            sa_block[k] = a[rank];
+                            bwt_block[k] = a.bwt[rank]; }
+                    }
+                });
+                for (size_t k = 0; k < sources.size(); k++) {
+                    sa.push_back(sa_block[k]);
+                    bwt.push_back(bwt_block[k]); }
+            }
+        }
+        sdsl::register_cache_file(sdsl::conf::KEY_SA, config);
+        sdsl::register_cache_file(keys::KEY_BWT, config);
+
+        return T(config);
+    }
+}  // namespace detail
@@ -0,0 +1,579 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <sdsl/bp_support.hpp>
+#include <sdsl/rank_support.hpp>
+#include <sdsl/select_support.hpp>
+#include <sdsl/util.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include "docstrings.hpp"
+#include "io.hpp"
+#include "operations/batch.hpp"
+#include "operations/sizes.hpp"
+#include "util/locking.hpp"
+
+
+namespace py = pybind11;
+
+
+namespace detail
+{
+    // A single tree: the excess only returns to 0 at the last position,
+    // forests like ()() are rejected
+    inline void check_balanced(const sdsl::bit_vector& bp)
+    {
+        int64_t excess = 0;
+        for (size_t i = 0; i < bp.size(); i++) {
+            excess += bp[i] ? 1 : -1;
+            if (excess < 0) {
+                throw std::invalid_argument(
+                    "parentheses are not balanced at " + std::to_string(i)); }
+            if (excess == 0 && i + 1 < bp.size()) {
+                throw std::invalid_argument(
+                    "the root closes at " + std::to_string(i) +
+                    ", before the end of the parentheses"); }
+        }
+        if (excess != 0) {
+            throw std::invalid_argument("parentheses are not balanced"); }
+    }
+
+    // Whether a balanced parentheses support has level_anc(i, d)
+    template <class T, class = void>
+    struct has_level_anc: std::false_type {};
+
+    template <class T>
+    struct has_level_anc<T, decltype(void(
+        std::declval<const T&>().level_anc(0, 0)))>: std::true_type {};
+}  // namespace detail
+
+
+// Ordinal tree in balanced parentheses representation.
+// A node is identified by the position of its opening parenthesis.
+// The bit vector is kept on the heap so the support's pointer to it stays
+// valid when the tree is moved around.
+template <class t_bps>
+class bp_tree
+{
+public:
+    typedef sdsl::bit_vector::size_type size_type;
+    typedef bool value_type;
+
+    bp_tree(): m_bp(new sdsl::bit_vector()) {}
+
+    explicit bp_tree(const sdsl::bit_vector& bp):
+        m_bp(new sdsl::bit_vector(bp))
+    {
+        detail::check_balanced(*m_bp);
+        m_bps = t_bps(m_bp.get());
+    }
+
+    bp_tree(const bp_tree& other): m_bp(new sdsl::bit_vector(*other.m_bp)) {
+        m_bps = t_bps(m_bp.get()); }
+
+    bp_tree(bp_tree&& other) = default;
+    bp_tree& operator=(bp_tree&& other) = default;
+
+    bp_tree& operator=(const bp_tree& other)
+    {
+        if (this != &other) {
+            *m_bp = *other.m_bp;
+            m_bps = t_bps(m_bp.get()); }
+        return *this;
+    }
+
+    size_type size() const { return m_bp->size(); }
+    bool operator[](size_type i) const { return (*m_bp)[i]; }
+    const sdsl::bit_vector& bp() const { return *m_bp; }
+    const t_bps& bps() const { return m_bps; }
+
+    size_type nodes() const { return size() / 2; }
+    size_type root() const { return 0; }
+
+    bool is_node(size_type v) const { return v < size() && (*m_bp)[v]; }
+
+    size_type find_close(size_type i) const { return m_bps.find_close(i); }
+    size_type find_open(size_type i) const { return m_bps.find_open(i); }
+    size_type enclose(size_type i) const { return m_bps.enclose(i); }
+    size_type excess(size_type i) const { return m_bps.excess(i); }
+
+    bool is_leaf(size_type v) const { return !(*m_bp)[v + 1]; }
+
+    size_type parent(size_type v) const { return m_bps.enclose(v); }
+
+    size_type depth(size_type v) const { return m_bps.excess(v) - 1; }
+
+    size_type first_child(size_type v) const {
+        return is_leaf(v) ? size() : v + 1; }
+
+    size_type next_sibling(size_type v) const
+    {
+        const size_type next = m_bps.find_close(v) + 1;
+        return (next < size() && (*m_bp)[next]) ? next : size();
+    }
+
+    size_type subtree_size(size_type v) const {
+        return (m_bps.find_close(v) - v + 1) / 2; }
+
+    size_type lca(size_type v, size_type w) const
+    {
+        if (v > w) std::swap(v, w);
+        if (v == w || m_bps.find_close(v) > w) return v;
+        return m_bps.double_enclose(v, w);
+    }
+
+    // The ancestor of `v` which is `d` levels above it (d = 0 is v itself)
+    size_type level_ancestor(size_type v, size_type d) const
+    {
+        if (d == 0 || v >= size()) return v;
+        return level_ancestor(v, d, detail::has_level_anc<t_bps>());
+    }
+
+    size_type serialize(std::ostream& out,
+                        sdsl::structure_tree_node* v = nullptr,
+                        std::string name = "") const
+    {
+        auto child = sdsl::structure_tree::add_child(
+            v, name, sdsl::util::class_name(*this));
+        size_type written_bytes = 0;
+        written_bytes += m_bp->serialize(out, child, "bp");
+        written_bytes += m_bps.serialize(out, child, "bps");
+        sdsl::structure_tree::add_size(child, written_bytes);
+        return written_bytes;
+    }
+
+    void load(std::istream& in)
+    {
+        m_bp->load(in);
+        m_bps.load(in, m_bp.get());
+    }
+
+private:
+    // bp_support_sada answers by its range min-max tree
+    size_type level_ancestor(size_type v, size_type d, std::true_type) const {
+        return m_bps.level_anc(v, d); }
+
+    size_type level_ancestor(size_type v, size_type d,
+                             std::false_type) const
+    {
+        for (; d > 0 && v < size(); d--) {
+            v = m_bps.enclose(v); }
+        return v;
+    }
+
+    std::unique_ptr<sdsl::bit_vector> m_bp;
+    t_bps m_bps;
+};
+
+
+// Ordinal tree in level-order unary degree sequence representation:
+// "10" followed by the degree of every node in BFS order written in unary
+// (`d` ones and a zero), 2n + 1 bits in total. A node is identified by the position of the 1-bit
+// which refers to it, the root is at position 0.
+class louds_bv_tree
+{
+public:
+    typedef sdsl::bit_vector::size_type size_type;
+    typedef bool value_type;
+
+    louds_bv_tree(): m_bv(new sdsl::bit_vector()) {}
+
+    explicit louds_bv_tree(const sdsl::bit_vector& bv):
+        m_bv(new sdsl::bit_vector(bv))
+    {
+        if (m_bv->size() < 2 || !(*m_bv)[0] || (*m_bv)[1]) {
+            throw std::invalid_argument("LOUDS sequence should start "
+                                        "with '10'"); }
+        init_supports();
+        if (m_rank(m_bv->size()) * 2 + 1 != m_bv->size()) {
+            throw std::invalid_argument("LOUDS sequence of n nodes should "
+                                        "contain n ones and n + 1 zeros"); }
+    }
+
+    louds_bv_tree(const louds_bv_tree& other):
+        m_bv(new sdsl::bit_vector(*other.m_bv)) { init_supports(); }
+
+    louds_bv_tree(louds_bv_tree&& other) = default;
+    louds_bv_tree& operator=(louds_bv_tree&& other) = default;
+
+    louds_bv_tree& operator=(const louds_bv_tree& other)
+    {
+        if (this != &other) {
+            *m_bv = *other.m_bv;
+            init_supports(); }
+        return *this;
+    }
+
+    size_type size() const { return m_bv->size(); }
+    bool operator[](size_type i) const { return (*m_bv)[i]; }
+    const sdsl::bit_vector& bv() const { return *m_bv; }
+
+    size_type nodes() const { return size() / 2; }
+    size_type root() const { return 0; }
+
+    bool is_node(size_type v) const { return v < size() && (*m_bv)[v]; }
+
+    // BFS rank of the node in [0..nodes)
+    size_type id(size_type v) const { return m_rank(v); }
+
+    // Inverse of `id`
+    size_type node(size_type id) const { return m_select1(id + 1); }
+
+    // Position of the first 1-bit of the unary degree of node `v`
+    size_type children_begin(size_type v) const {
+        return m_select0(m_rank(v + 1)) + 1; }
+
+    bool is_leaf(size_type v) const { return !(*m_bv)[children_begin(v)]; }
+
+    size_type degree(size_type v) const
+    {
+        const size_type begin = children_begin(v);
+        return m_select0(m_rank(v + 1) + 1) - begin;
+    }
+
+    size_type first_child(size_type v) const
+    {
+        const size_type child = children_begin(v);
+        return (*m_bv)[child] ? child : size();
+    }
+
+    // The `i`-th child of `v` (1-based)
+    size_type child(size_type v, size_type i) const {
+        return (i >= 1 && i <= degree(v)) ? children_begin(v) + i - 1 : size(); }
+
+    size_type next_sibling(size_type v) const {
+        return (v + 1 < size() && (*m_bv)[v + 1]) ? v + 1 : size(); }
+
+    size_type parent(size_type v) const
+    {
+        if (v == 0) return size();
+        return m_select1(v + 1 - m_rank(v + 1));
+    }
+
+    size_type serialize(std::ostream& out,
+                        sdsl::structure_tree_node* v = nullptr,
+                        std::string name = "") const
+    {
+        auto child = sdsl::structure_tree::add_child(
+            v, name, sdsl::util::class_name(*this));
+        size_type written_bytes = 0;
+        written_bytes += m_bv->serialize(out, child, "bv");
+        written_bytes += m_rank.serialize(out, child, "rank");
+        written_bytes += m_select1.serialize(out, child, "select1");
+        written_bytes += m_select0.serialize(out, child, "select0");
+        sdsl::structure_tree::add_size(child, written_bytes);
+        return written_bytes;
+    }
+
+    void load(std::istream& in)
+    {
+        m_bv->load(in);
+        m_rank.load(in, m_bv.get());
+        m_select1.load(in, m_bv.get());
+        m_select0.load(in, m_bv.get());
+    }
+
+private:
+    void init_supports()
+    {
+        sdsl::util::init_support(m_rank, m_bv.get());
+        sdsl::util::init_support(m_select1, m_bv.get());
+        sdsl::util::init_support(m_select0, m_bv.get());
+    }
+
+    std::unique_ptr<sdsl::bit_vector> m_bv;
+    sdsl::rank_support_v5<1, 1> m_rank;
+    sdsl::select_support_mcl<1, 1> m_select1;
+    sdsl::select_support_mcl<0, 1> m_select0;
+};
+
+
+namespace detail
+{
+    template <class T>
+    inline void check_node(const T& self, typename T::size_type v)
+    {
+        if (!self.is_node(v)) {
+            throw std::out_of_range(std::to_string(v) + " is not a node"); }
+    }
+}  // namespace detail
+
+
+template <class T>
+inline auto add_tree_class(py::module& m, const std::string& name,
+                           const char* doc = nullptr)
+{
+    typedef typename T::size_type size_type;
+
+    auto cls = py::class_<T>(m, name.c_str())
+        .def(py::init())
+        .def(py::init(locking::reading(
+                 [] (const sdsl::bit_vector& bv) { return T(bv); })),
+             py::arg("bv"),
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("nodes", &T::nodes,
+                               "The number of nodes in the tree.")
+        .def_property_readonly("root", &T::root, "The root node.")
+        .def(
+            "is_leaf",
+            [] (const T& self, size_type v) {
+                detail::check_node(self, v);
+                return self.is_leaf(v); },
+            py::arg("v"),
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "parent",
+            [] (const T& self, size_type v) {
+                detail::check_node(self, v);
+                return self.parent(v); },
+            py::arg("v"),
+            "Parent of node `v` or `size` for the root.",
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "first_child",
+            [] (const T& self, size_type v) {
+                detail::check_node(self, v);
+                return self.first_child(v); },
+            py::arg("v"),
+            "The first child of node `v` or `size` for a leaf.",
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "next_sibling",
+            [] (const T& self, size_type v) {
+                detail::check_node(self, v);
+                return self.next_sibling(v); },
+            py::arg("v"),
+            "The next sibling of node `v` or `size` if `v` is the last child.",
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "parent_many",
+            [] (const T& self, const input_array<>& vs) {
+                return map_array(vs, [&self] (uint64_t v) {
+                    detail::check_node(self, v);
+                    return self.parent(v); }, "vs"); },
+            py::arg("vs"),
+            "Parents of all nodes of `vs` as numpy array.")
+        .def(
+            "first_child_many",
+            [] (const T& self, const input_array<>& vs) {
+                return map_array(vs, [&self] (uint64_t v) {
+                    detail::check_node(self, v);
+                    return self.first_child(v); }, "vs"); },
+            py::arg("vs"),
+            "First children of all nodes of `vs` as numpy array.")
+        .def(
+            "next_sibling_many",
+            [] (const T& self, const input_array<>& vs) {
+                return map_array(vs, [&self] (uint64_t v) {
+                    detail::check_node(self, v);
+                    return self.next_sibling(v); }, "vs"); },
+            py::arg("vs"),
+            "Next siblings of all nodes of `vs` as numpy array.");
+
+    add_sizes(cls);
+    add_description(cls);
+    add_serialization(cls);
+    add_to_string(cls);
+
+    if (doc) cls.doc() = doc;
+
+    m.attr("succinct_trees").attr("__setitem__")(name, cls);
+
+    return cls;
+}
+
+
+template <class t_bps>
+inline auto add_bp_tree(py::module& m, const std::string& suffix,
+                        const char* doc_bps = nullptr)
+{
+    typedef bp_tree<t_bps> T;
+    typedef typename T::size_type size_type;
+
+    auto cls = add_tree_class<T>(m, "BPTree" + suffix, doc_bp_tree);
+
+    cls.def(
+        "find_close",
+        [] (const T& self, size_type i) {
+            detail::check_node(self, i);
+            return self.find_close(i); },
+        py::arg("i"),
+        "Position of the closing parenthesis matching the opening one at `i`.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "find_open",
+        [] (const T& self, size_type i) {
+            if (i >= self.size() || self[i]) {
+                throw std::out_of_range(std::to_string(i) +
+                                        " is not a closing parenthesis"); }
+            return self.find_open(i); },
+        py::arg("i"),
+        "Position of the opening parenthesis matching the closing one at `i`.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "enclose",
+        [] (const T& self, size_type i) {
+            detail::check_node(self, i);
+            return self.enclose(i); },
+        py::arg("i"),
+        "Position of the opening parenthesis of the closest pair enclosing "
+        "`i` or `size` if there is none.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "excess",
+        [] (const T& self, size_type i) {
+            if (i >= self.size()) {
+                throw std::out_of_range(std::to_string(i)); }
+            return self.excess(i); },
+        py::arg("i"),
+        "Number of opening minus number of closing parentheses in [0..i].",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "depth",
+        [] (const T& self, size_type v) {
+            detail::check_node(self, v);
+            return self.depth(v); },
+        py::arg("v"), "Depth of node `v`, the root has depth 0.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "subtree_size",
+        [] (const T& self, size_type v) {
+            detail::check_node(self, v);
+            return self.subtree_size(v); },
+        py::arg("v"), "Number of nodes in the subtree rooted at `v`.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "lca",
+        [] (const T& self, size_type v, size_type w) {
+            detail::check_node(self, v);
+            detail::check_node(self, w);
+            return self.lca(v, w); },
+        py::arg("v"), py::arg("w"),
+        "Lowest common ancestor of nodes `v` and `w`.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "level_ancestor",
+        [] (const T& self, size_type v, size_type d) {
+            detail::check_node(self, v);
+            if (d > self.depth(v)) {
+                throw std::out_of_range(std::to_string(d) +
+                                        " is greater than depth of node"); }
+            return self.level_ancestor(v, d); },
+        py::arg("v"), py::arg("d"),
+        "Ancestor of node `v` which is `d` levels above it.\n"
+        "Time complexity: Order(log(n)) with the support of Sadakane, "
+        "Order(d) otherwise",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "find_close_many",
+        [] (const T& self, const input_array<>& vs) {
+            return map_array(vs, [&self] (uint64_t v) {
+                detail::check_node(self, v);
+                return self.find_close(v); }, "vs"); },
+        py::arg("vs"),
+        "Closing parentheses of all nodes of `vs` as numpy array.");
+    cls.def(
+        "enclose_many",
+        [] (const T& self, const input_array<>& vs) {
+            return map_array(vs, [&self] (uint64_t v) {
+                detail::check_node(self, v);
+                return self.enclose(v); }, "vs"); },
+        py::arg("vs"),
+        "Enclosing opening parentheses of all nodes of `vs` (`size` if "
+        "there is none) as numpy array.");
+    cls.def(
+        "subtree_size_many",
+        [] (const T& self, const input_array<>& vs) {
+            return map_array(vs, [&self] (uint64_t v) {
+                detail::check_node(self, v);
+                return self.subtree_size(v); }, "vs"); },
+        py::arg("vs"),
+        "Subtree sizes of all nodes of `vs` as numpy array.");
+    cls.def(
+        "lca_many",
+        [] (const T& self, const input_array<>& vs, const input_array<>& ws) {
+            return map_arrays(vs, ws, [&self] (uint64_t v, uint64_t w) {
+                detail::check_node(self, v);
+                detail::check_node(self, w);
+                return self.lca(v, w); }); },
+        py::arg("vs"), py::arg("ws"),
+        "Lowest common ancestors of the pairs of nodes (vs[i], ws[i]) as "
+        "numpy array.");
+    cls.def_property_readonly(
+        "bp", [] (const T& self) { return self.bp(); },
+        "Balanced parentheses sequence of the tree.");
+
+    if (doc_bps) {
+        cls.doc() = std::string(doc_bp_tree) + "\n\n" + doc_bps; }
+
+    return cls;
+}
+
+
+inline auto add_louds_tree(py::module& m)
+{
+    typedef louds_bv_tree T;
+    typedef T::size_type size_type;
+
+    auto cls = add_tree_class<T>(m, "LoudsTree", doc_louds_tree);
+
+    cls.def(
+        "degree",
+        [] (const T& self, size_type v) {
+            detail::check_node(self, v);
+            return self.degree(v); },
+        py::arg("v"), "Number of children of node `v`.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "child",
+        [] (const T& self, size_type v, size_type i) {
+            detail::check_node(self, v);
+            return self.child(v, i); },
+        py::arg("v"), py::arg("i"),
+        "The `i`-th child (1-based) of node `v` or `size` if there is none.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "id",
+        [] (const T& self, size_type v) {
+            detail::check_node(self, v);
+            return self.id(v); },
+        py::arg("v"), "Level-order rank of node `v` in [0..nodes).",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "node",
+        [] (const T& self, size_type id) {
+            if (id >= self.nodes()) {
+                throw std::out_of_range(std::to_string(id)); }
+            return self.node(id); },
+        py::arg("id"), "Node with level-order rank `id`.",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def_property_readonly(
+        "bv", [] (const T& self) { return self.bv(); },
+        "LOUDS sequence of the tree.");
+
+    return cls;
+}
+
+
+inline auto add_trees(py::module& m)
+{
+    m.attr("succinct_trees") = py::dict();
+
+    auto trees = std::make_tuple(
+        add_bp_tree<sdsl::bp_support_sada<>>(m, "Sada", doc_bp_support_sada),
+        add_bp_tree<sdsl::bp_support_g<>>(m, "G", doc_bp_support_g),
+        add_bp_tree<sdsl::bp_support_gg<>>(m, "GG", doc_bp_support_gg),
+        add_louds_tree(m));
+
+    m.attr("BPTree") = m.attr("BPTreeSada");
+
+    return trees;
+}
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -15,6 +20,12 @@
 #include "calc.hpp"
 #include "docstrings.hpp"
 #include "io.hpp"
+#include "operations/batch.hpp"
+#include "types/wavelet_build.hpp"
+#include "util/aio.hpp"
+#include "util/locking.hpp"
+#include "util/parallel.hpp"
+#include "util/stats.hpp"
 
 
 namespace py = pybind11;
@@ -28,6 +39,77 @@ template <class T, bool /* enable */ = sdsl::has_node_type<T>::value>
 class add_traversable_functor;
 
 
+namespace detail
+{
+    // Length of the equally long one-dimensional query arrays
+    inline size_t batch_length(
+        std::initializer_list<const input_array<uint64_t>*> arrays)
+    {
+        for (auto arr: arrays) check_1d(*arr, "query arrays");
+        const size_t n = (*arrays.begin())->shape(0);
+        for (auto arr: arrays) {
+            if (size_t(arr->shape(0)) != n) {
+                throw std::invalid_argument(
+                    "query arrays should have equal length"); }
+        }
+        return n;
+    }
+
+    // Runs f(i) for the queries i in [0..n) ordered by their left bound:
+    // every thread gets a contiguous run of that order, so the queries of
+    // a thread descend to neighbouring positions on every level and share
+    // the cached blocks of its bit vectors and rank supports. Results are
+    // written by i, i.e. in input order.
+    template <class F>
+    inline void run_by_left_bound(const uint64_t* lb, size_t n,
+                                  size_t threads, F f)
+    {
+        if (std::is_sorted(lb, lb + n)) {
+            parallel_for_each_index(n, threads, f);
+            return; }
+
+        std::vector<std::pair<uint64_t, size_t>> order(n);
+        for (size_t i = 0; i < n; i++) order[i] = std::make_pair(lb[i], i);
+        parallel_sort(order.begin(), order.end(), threads);
+        parallel_for_each_index(n, threads, [&] (size_t k) {
+            f(order[k].second); });
+    }
+
+    template <class T>
+    inline void check_quantile(const T& self, uint64_t lb, uint64_t rb,
+                               uint64_t q)
+    {
+        if (rb >= self.size()) {
+            throw std::out_of_range(std::to_string(rb)); }
+        if (lb > rb) {
+            throw std::invalid_argument("lb should be less or equal than rb"); }
+        if (q > rb - lb) {
+            throw std::invalid_argument("q should be less than rb - lb + 1"); }
+    }
+
+    // Number of values of wt[lb..rb] in [vlb..vrb]: the range minus the
+    // values smaller than the first symbol of the alphabet >= vlb and
+    // greater than the last symbol <= vrb
+    template <class T>
+    inline uint64_t lex_range_count(const T& self, uint64_t lb, uint64_t rb,
+                                    uint64_t vlb, uint64_t vrb)
+    {
+        typedef typename T::value_type value_type;
+        const uint64_t top = std::numeric_limits<value_type>::max();
+        if (vlb > top) return 0;
+        const auto first = sdsl::symbol_gte(self, value_type(vlb));
+        const auto last = sdsl::symbol_lte(
+            self, value_type(std::min(vrb, top)));
+        if (!std::get<0>(first) || !std::get<0>(last) ||
+            std::get<1>(first) > std::get<1>(last)) {
+            return 0; }
+        const auto smaller = self.lex_count(lb, rb + 1, std::get<1>(first));
+        const auto greater = self.lex_count(lb, rb + 1, std::get<1>(last));
+        return rb + 1 - lb - std::get<1>(smaller) - std::get<2>(greater);
+    }
+}  // namespace detail
+
+
 template <class T>
 class add_lex_functor<T, false>
 {
@@ -93,7 +175,8 @@ public:
                 return std::get<1>(result); },
             py::arg("c"),
             "Returns for a symbol c the previous smaller or equal symbol in "
-            "the WT");
+            "the WT",
+            py::call_guard<py::gil_scoped_release>());
         cls.def(
             "symbol_gte",
             [] (const T& self, typename T::value_type c) {
@@ -102,7 +185,8 @@ public:
                     throw std::runtime_error("Symbol not found"); }
                 return std::get<1>(result); },
             py::arg("c"),
-            "Returns for a symbol c the next larger or equal symbol in the WT");
+            "Returns for a symbol c the next larger or equal symbol in the WT",
+            py::call_guard<py::gil_scoped_release>());
         cls.def(
             "restricted_unique_range_values",
             [] (const T& self, size_type x_i, size_type x_j, value_type y_i,
@@ -114,6 +198,133 @@ public:
             "return all unique y values occuring in [x_i, x_j] "
             "in ascending order.",
             py::call_guard<py::gil_scoped_release>());
+
+        cls.def(
+            "quantile_many",
+            [] (const T& self, const input_array<uint64_t>& lb,
+                const input_array<uint64_t>& rb,
+                const input_array<uint64_t>& q, size_t threads) {
+                const size_t n = detail::batch_length({&lb, &rb, &q});
+                const uint64_t* l = lb.data();
+                const uint64_t* r = rb.data();
+                const uint64_t* k = q.data();
+                for (size_t i = 0; i < n; i++) {
+                    detail::check_quantile(self, l[i], r[i], k[i]); }
+
+                py::array_t<uint64_t> values(n);
+                py::array_t<uint64_t> freqs(n);
+                uint64_t* v = values.mutable_data();
+                uint64_t* f = freqs.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    detail::run_by_left_bound(l, n, threads, [&] (size_t i) {
+                        const auto found = sdsl::quantile_freq(
+                            self, l[i], r[i], k[i]);
+                        v[i] = found.first;
+                        f[i] = found.second; });
+                }
+                return std::make_pair(values, freqs); },
+            py::arg("lb"), py::arg("rb"), py::arg("q"), py::arg("threads") = 0,
+            "quantile_freq for every (lb[i], rb[i], q[i]) of three numpy "
+            "arrays, on `threads` threads (0 means all hardware threads). "
+            "Returns the numpy arrays (values, frequencies).");
+        cls.def(
+            "range_median_many",
+            [] (const T& self, const input_array<uint64_t>& lb,
+                const input_array<uint64_t>& rb, size_t threads) {
+                const size_t n = detail::batch_length({&lb, &rb});
+                const uint64_t* l = lb.data();
+                const uint64_t* r = rb.data();
+                for (size_t i = 0; i < n; i++) {
+                    detail::check_quantile(self, l[i], r[i], 0); }
+
+                py::array_t<uint64_t> result(n);
+                uint64_t* out = result.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    detail::run_by_left_bound(l, n, threads, [&] (size_t i) {
+                        out[i] = sdsl::quantile_freq(
+                            self, l[i], r[i], (r[i] - l[i]) / 2).first; });
+                }
+                return result; },
+            py::arg("lb"), py::arg("rb"), py::arg("threads") = 0,
+            "Median of wt[lb[i]..rb[i]] for every i, the lower one for ranges "
+            "of even length, on `threads` threads (0 means all hardware "
+            "threads).");
+        cls.def(
+            "lex_count_many",
+            [] (const T& self, const input_array<uint64_t>& i_arr,
+                const input_array<uint64_t>& j_arr,
+                const input_array<uint64_t>& c_arr, size_t threads) {
+                const size_t n = detail::batch_length({&i_arr, &j_arr,
+                                                       &c_arr});
+                const uint64_t* i_ = i_arr.data();
+                const uint64_t* j_ = j_arr.data();
+                const uint64_t* c_ = c_arr.data();
+                const uint64_t top = std::numeric_limits<value_type>::max();
+                for (size_t k = 0; k < n; k++) {
+                    if (j_[k] > self.size()) {
+                        throw std::out_of_range(std::to_string(j_[k])); }
+                    if (i_[k] > j_[k]) {
+                        throw std::invalid_argument(
+                            "i should be less or equal than j"); }
+                    if (c_[k] > top) {
+                        throw std::invalid_argument(
+                            std::to_string(c_[k]) + " is not a symbol"); }
+                }
+
+                py::array_t<uint64_t> ranks(n);
+                py::array_t<uint64_t> smaller(n);
+                py::array_t<uint64_t> greater(n);
+                uint64_t* r = ranks.mutable_data();
+                uint64_t* s = smaller.mutable_data();
+                uint64_t* g = greater.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    detail::run_by_left_bound(i_, n, threads, [&] (size_t k) {
+                        const auto counts = self.lex_count(
+                            i_[k], j_[k], value_type(c_[k]));
+                        r[k] = std::get<0>(counts);
+                        s[k] = std::get<1>(counts);
+                        g[k] = std::get<2>(counts); });
+                }
+                return std::make_tuple(ranks, smaller, greater); },
+            py::arg("i"), py::arg("j"), py::arg("c"), py::arg("threads") = 0,
+            "lex_count for every (i[k], j[k], c[k]) of three numpy arrays, "
+            "j exclusive, on `threads` threads (0 means all hardware "
+            "threads). Returns the numpy arrays (rank(i, c), smaller than c, "
+            "greater than c).");
+        cls.def(
+            "range_count_many",
+            [] (const T& self, const input_array<uint64_t>& lb,
+                const input_array<uint64_t>& rb,
+                const input_array<uint64_t>& vlb,
+                const input_array<uint64_t>& vrb, size_t threads) {
+                const size_t n = detail::batch_length({&lb, &rb, &vlb, &vrb});
+                const uint64_t* l = lb.data();
+                const uint64_t* r = rb.data();
+                const uint64_t* vl = vlb.data();
+                const uint64_t* vr = vrb.data();
+                for (size_t i = 0; i < n; i++) {
+                    detail::check_quantile(self, l[i], r[i], 0);
+                    if (vl[i] > vr[i]) {
+                        throw std::invalid_argument(
+                            "vlb should be less or equal than vrb"); }
+                }
+
+                py::array_t<uint64_t> result(n);
+                uint64_t* out = result.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    detail::run_by_left_bound(l, n, threads, [&] (size_t i) {
+                        out[i] = detail::lex_range_count(
+                            self, l[i], r[i], vl[i], vr[i]); });
+                }
+                return result; },
+            py::arg("lb"), py::arg("rb"), py::arg("vlb"), py::arg("vrb"),
+            py::arg("threads") = 0,
+            "Number of values in [vlb[i]..vrb[i]] in wt[lb[i]..rb[i]] for "
+            "every i, on `threads` threads (0 means all hardware threads).");
         return cls;
     }
 };
@@ -146,21 +357,27 @@ public:
         }
         catch(std::runtime_error& /* ignore */) {}
 
-        cls.def("root_node", &T::root);
-        cls.def("node_is_leaf", &T::is_leaf);
+        cls.def("root_node", &T::root,
+                py::call_guard<py::gil_scoped_release>());
+        cls.def("node_is_leaf", &T::is_leaf,
+                py::call_guard<py::gil_scoped_release>());
         cls.def(
             "node_empty",
             [] (const T& self, const t_node& node)
-            { return self.empty(node); });
+            { return self.empty(node); },
+            py::call_guard<py::gil_scoped_release>());
         cls.def(
             "node_size",
             [] (const T& self, const t_node& node)
-            { return self.size(node); });
-        cls.def("node_sym", &T::sym);
+            { return self.size(node); },
+            py::call_guard<py::gil_scoped_release>());
+        cls.def("node_sym", &T::sym,
+                py::call_guard<py::gil_scoped_release>());
         cls.def(
             "node_expand",
             [] (const T& self, const t_node& node)
-            { return self.expand(node); });
+            { return self.expand(node); },
+            py::call_guard<py::gil_scoped_release>());
         cls.def(
             "node_expand_ranges",
             [] (const T& self, const t_node& node,
@@ -168,29 +385,38 @@ public:
             {
                 return self.expand(node, ranges);
             },
-            py::arg("node"), py::arg("ranges"));
+            py::arg("node"), py::arg("ranges"),
+            py::call_guard<py::gil_scoped_release>());
         cls.def(
             "node_bit_vec",
             [] (const T& self, const t_node& node) {
-                auto bit_vec = self.bit_vec(node);
+                // the iterator needs the GIL, the bits are read without
+                sdsl::bit_vector bits;
+                {
+                    py::gil_scoped_release release;
+                    auto bit_vec = self.bit_vec(node);
+                    bits.resize(bit_vec.size());
+                    std::copy(detail::cbegin(bit_vec), detail::cend(bit_vec),
+                              bits.begin());
+                }
+                const auto size = bits.size();
                 return std::make_pair(
-                    bit_vec.size(),
-                    py::make_iterator(
-                        detail::cbegin(bit_vec),
-                        detail::cend(bit_vec))); });
+                    size, py::cast(std::move(bits)).attr("__iter__")()); });
         cls.def(
             "node_seq",
             [] (const T& self, const t_node& node) {
                 auto seq = self.seq(node);
                 sdsl::int_vector<> s(seq.size());
                 std::copy(seq.begin(), seq.end(), s.begin());
-                return s; } );
+                return s; },
+            py::call_guard<py::gil_scoped_release>());
 
         cls.def(
             "intersect",
             [] (const T& self, std::vector<sdsl::range_type> ranges, size_t t) {
                 return sdsl::intersect(self, ranges, t); },
             py::arg("ranges"), py::arg("t") = 0,
+            py::call_guard<py::gil_scoped_release>(),
             "Intersection of elements in "
             "WT[s₀, e₀], WT[s₁, e₁], ...,WT[sₖ,eₖ]\n"
             "\tranges: The ranges.\n\tt: Threshold in how many distinct ranges "
@@ -217,12 +443,305 @@ public:
 
                 return std::make_tuple(k, cs, rank_c_i, rank_c_j); },
             py::arg("i"), py::arg("j"),
-            "For each symbol c in wt[i..j - 1] get rank(i, c) and rank(j, c).");
+            "For each symbol c in wt[i..j - 1] get rank(i, c) and rank(j, c).",
+            py::call_guard<py::gil_scoped_release>());
         return cls;
     }
 };
 
 
+namespace detail
+{
+    template <class T>
+    inline void check_range_2d(const T& self, typename T::size_type lb,
+                               typename T::size_type rb,
+                               typename T::value_type vlb,
+                               typename T::value_type vrb)
+    {
+        if (rb >= self.size()) {
+            throw std::out_of_range(std::to_string(rb)); }
+        if (lb > rb) {
+            throw std::invalid_argument("lb should be less or equal than rb"); }
+        if (vlb > vrb) {
+            throw std::invalid_argument("vlb should be less or equal "
+                                        "than vrb"); }
+    }
+
+
+    // Calls report(index, value) for the points of wt[lb..rb] with values
+    // in [vlb..vrb], ordered by value, while it returns true. Descends
+    // into the nodes whose value intervals meet [vlb..vrb] as sdsl's
+    // range_search_2d does, but hands out every point as it is found
+    // instead of collecting them into a vector first. The k-th position
+    // of the leaf of c is the (k + 1)-th occurrence of c.
+    template <class T, class F>
+    inline bool for_each_point_2d(const T& wt,
+                                  const typename T::node_type& v,
+                                  const sdsl::range_type& r,
+                                  uint64_t vlb, uint64_t vrb, F& report)
+    {
+        if (sdsl::empty(r)) return true;
+        const uint32_t height = wt.max_level - v.level;
+        const uint64_t lo = height < 64 ? uint64_t(wt.sym(v)) << height : 0;
+        const uint64_t hi = lo | sdsl::bits::lo_set[height];
+        if (hi < vlb || lo > vrb) return true;
+
+        if (wt.is_leaf(v)) {
+            const auto c = wt.sym(v);
+            for (auto k = std::get<0>(r); k <= std::get<1>(r); k++) {
+                if (!report(wt.select(k + 1, c), c)) return false; }
+            return true;
+        }
+        const auto children = wt.expand(v);
+        const auto ranges = wt.expand(v, r);
+        return for_each_point_2d(wt, children[0], ranges[0], vlb, vrb,
+                                 report) &&
+               for_each_point_2d(wt, children[1], ranges[1], vlb, vrb,
+                                 report);
+    }
+
+
+    // Reports points of wt[lb..rb] with values in [vlb..vrb] slice by slice
+    // of the index range, so that memory used by every step is bounded
+    // by the number of points of the slice. Concurrent calls of next are
+    // serialized by a mutex.
+    template <class T>
+    class range_search_2d_slicer
+    {
+    public:
+        typedef typename T::size_type size_type;
+        typedef typename T::value_type value_type;
+
+        range_search_2d_slicer(const T& wt, size_type lb, size_type rb,
+                               value_type vlb, value_type vrb,
+                               size_type slice):
+            m_wt(wt), m_next(lb), m_rb(rb), m_vlb(vlb), m_vrb(vrb),
+            m_slice(std::max<size_type>(slice, 1)), m_done(false),
+            m_mutex(new std::mutex())
+        {}
+
+        // Appends points of the next non-empty slice, ordered by value
+        void next(std::vector<uint64_t>& indices,
+                  std::vector<uint64_t>& values)
+        {
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            auto append = [&] (uint64_t index, uint64_t value) {
+                indices.push_back(index);
+                values.push_back(value);
+                return true; };
+            const size_t found = indices.size();
+            while (!m_done && indices.size() == found) {
+                const size_type rb = m_rb - m_next < m_slice ?
+                    m_rb : m_next + m_slice - 1;
+                for_each_point_2d(m_wt, m_wt.root(),
+                                  sdsl::range_type{m_next, rb}, m_vlb,
+                                  m_vrb, append);
+                m_done = rb == m_rb;
+                m_next = rb + 1;
+            }
+        }
+
+    private:
+        const T& m_wt;
+        size_type m_next;
+        size_type m_rb;
+        value_type m_vlb;
+        value_type m_vrb;
+        size_type m_slice;
+        bool m_done;
+        std::unique_ptr<std::mutex> m_mutex;
+    };
+
+
+    // Arguments of rank_many, checked with the GIL held before the
+    // queries run: positions up to the size, values representable in the
+    // alphabet (256 would become 0 on byte trees)
+    template <typename T>
+    void check_rank_many(const T& wt, size_t n, const uint64_t* positions,
+                         const uint64_t* values)
+    {
+        typedef typename T::value_type value_type;
+        for (size_t k = 0; k < n; k++) {
+            if (positions[k] > wt.size()) {
+                throw std::out_of_range(std::to_string(positions[k])); }
+            if (values[k] > std::numeric_limits<value_type>::max()) {
+                throw std::invalid_argument(
+                    "symbol " + std::to_string(values[k]) +
+                    " is out of the alphabet"); }
+        }
+    }
+
+    // rank(positions[k], values[k]) for k in [0..n-1] into out, after
+    // check_rank_many; must be called without the GIL
+    template <typename T>
+    void rank_many(const T& wt, size_t n, const uint64_t* positions,
+                   const uint64_t* values, uint64_t* out)
+    {
+        for (size_t k = 0; k < n; k++) {
+            out[k] = wt.rank(positions[k], values[k]); }
+    }
+}  // namespace detail
+
+
+template <class T>
+auto add_range_search_2d(py::class_<T>& cls)
+{
+    typedef typename T::size_type size_type;
+    typedef typename T::value_type value_type;
+    typedef detail::range_search_2d_slicer<T> slicer;
+
+    py::class_<slicer>(cls, "RangeSearch2dIterator")
+        .def("__iter__", [] (slicer& self) -> slicer& { return self; })
+        .def(
+            "__next__",
+            [] (slicer& self) {
+                std::vector<uint64_t> indices, values;
+                {
+                    py::gil_scoped_release release;
+                    self.next(indices, values);
+                }
+                if (indices.empty()) throw py::stop_iteration();
+                return std::make_pair(detail::to_numpy(indices),
+                                      detail::to_numpy(values)); });
+
+    cls.def(
+        "range_search_2d",
+        [] (const T& self, size_type lb, size_type rb,
+            value_type vlb, value_type vrb, bool report, size_type limit)
+        {
+            detail::check_range_2d(self, lb, rb, vlb, vrb);
+
+            size_type count;
+            {
+                py::gil_scoped_release release;
+                count = self.range_search_2d(lb, rb, vlb, vrb, false).first;
+            }
+            // the arrays are sized by the count and filled in place
+            const size_type n = !report ? 0 :
+                                limit ? std::min(limit, count) : count;
+            py::array_t<uint64_t> indices(n);
+            py::array_t<uint64_t> values(n);
+            uint64_t* index_out = indices.mutable_data();
+            uint64_t* value_out = values.mutable_data();
+            if (n) {
+                py::gil_scoped_release release;
+                size_type k = 0;
+                auto fill = [&] (uint64_t index, uint64_t value) {
+                    index_out[k] = index;
+                    value_out[k] = value;
+                    return ++k < n; };
+                detail::for_each_point_2d(self, self.root(),
+                                          sdsl::range_type{lb, rb}, vlb, vrb,
+                                          fill);
+            }
+            return std::make_tuple(count, indices, values);
+        },
+        py::arg("lb"), py::arg("rb"), py::arg("vlb"), py::arg("vrb"),
+        py::arg("report") = true, py::arg("limit") = 0,
+        "searches points in the index interval [lb..rb] and "
+        "value interval [vlb..vrb].\n"
+        "\tlb: Left bound of index interval (inclusive)\n"
+        "\trb: Right bound of index interval (inclusive)\n"
+        "\tvlb: Left bound of value interval (inclusive)\n"
+        "\tvrb: Right bound of value interval (inclusive)\n"
+        "\treport: Should the matching points be returned?\n"
+        "\tlimit: Maximal number of points to return (0 means no limit)\n"
+        "returns tuple (number of found points, indices, values) where "
+        "indices and values are numpy arrays ordered by value, empty when "
+        "report = false.");
+    cls.def(
+        "range_search_2d_iter",
+        [] (const T& self, size_type lb, size_type rb,
+            value_type vlb, value_type vrb, size_type chunk_size) {
+            detail::check_range_2d(self, lb, rb, vlb, vrb);
+            return slicer(self, lb, rb, vlb, vrb, chunk_size); },
+        py::arg("lb"), py::arg("rb"), py::arg("vlb"), py::arg("vrb"),
+        py::arg("chunk_size") = 1 << 20,
+        "Iterates over points of range_search_2d in chunks: yields pairs "
+        "(indices, values) of numpy arrays for consecutive slices of "
+        "`chunk_size` positions of the index interval which contain points.",
+        py::keep_alive<0, 1>());
+    cls.def(
+        "range_count_2d",
+        [] (const T& self, size_type lb, size_type rb,
+            value_type vlb, value_type vrb) {
+            detail::check_range_2d(self, lb, rb, vlb, vrb);
+            return self.range_search_2d(lb, rb, vlb, vrb, false).first; },
+        py::arg("lb"), py::arg("rb"), py::arg("vlb"), py::arg("vrb"),
+        "Number of points in the index interval [lb..rb] and value "
+        "interval [vlb..vrb].",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        "range_count_2d_many",
+        [] (const T& self, const input_array<uint64_t>& rects, size_t threads)
+        {
+            if (rects.ndim() != 2 || rects.shape(1) != 4) {
+                throw std::invalid_argument("rects should have shape (n, 4)"); }
+            const size_t n = rects.shape(0);
+            const uint64_t* r = rects.data();
+            for (size_t i = 0; i < n; i++) {
+                detail::check_range_2d(self, r[4 * i], r[4 * i + 1],
+                                       r[4 * i + 2], r[4 * i + 3]); }
+
+            py::array_t<uint64_t> result(n);
+            uint64_t* out = result.mutable_data();
+            {
+                py::gil_scoped_release release;
+                parallel_for_each_index(n, threads, [&] (size_t i) {
+                    out[i] = self.range_search_2d(
+                        r[4 * i], r[4 * i + 1], r[4 * i + 2], r[4 * i + 3],
+                        false).first; });
+            }
+            return result;
+        },
+        py::arg("rects"), py::arg("threads") = 0,
+        "Counts points for every row (lb, rb, vlb, vrb) of `rects` "
+        "on `threads` threads (0 means all hardware threads) without "
+        "reporting them.");
+
+    return cls;
+}
+
+
+template <class Builder, class T>
+auto add_parallel_build(py::class_<T>& cls)
+{
+    cls.def(
+        py::init(locking::reading(
+            [] (const sdsl::int_vector<>& v, size_t threads) {
+                return detail::parallel_build<Builder>(
+                    v.size(), [&v] (size_t i) -> uint64_t { return v[i]; },
+                    threads); })),
+        py::arg("v"), py::arg("threads"),
+        "Build level by level on `threads` threads (0 means all hardware "
+        "threads).",
+        py::call_guard<py::gil_scoped_release>());
+    cls.def(
+        py::init([] (const input_array<uint64_t>& v, size_t threads) {
+            detail::check_1d(v, "v");
+            const uint64_t* data = v.data();
+            py::gil_scoped_release release;
+            return detail::parallel_build<Builder>(
+                v.shape(0), [data] (size_t i) { return data[i]; },
+                threads); }),
+        py::arg("v"), py::arg("threads"),
+        "Build from a numpy array level by level on `threads` threads "
+        "(0 means all hardware threads).");
+    cls.def_static(
+        "construct_im",
+        locking::reading([] (const sdsl::int_vector<>& v) {
+            T result;
+            sdsl::construct_im(result, v);
+            return result; }),
+        py::arg("v"),
+        "Build with sdsl::construct_im, i.e. through a serialized copy of "
+        "`v` in sdsl's RAM file system. Kept for comparison, the "
+        "constructors build from memory directly.",
+        py::call_guard<py::gil_scoped_release>());
+    return cls;
+}
+
+
 template <class T>
 auto add_wavelet_specific(py::class_<T>& cls) { return cls; }
 
@@ -231,8 +750,6 @@ template <class... T>
 auto add_wavelet_specific(py::class_<sdsl::wt_int<T...>>& cls)
 {
     typedef sdsl::wt_int<T...> base_cls;
-    typedef typename base_cls::size_type size_type;
-    typedef typename base_cls::value_type value_type;
 
     cls.def_property_readonly(
         "tree",
@@ -250,25 +767,19 @@ auto add_wavelet_specific(py::class_<sdsl::wt_int<T...>>& cls)
         "get_max_level",
         [] (const base_cls& self) { return self.max_level; },
         "Maximal level of the wavelet tree.");
-    cls.def(
-        "range_search_2d",
-        [] (const base_cls& self, size_type lb, size_type rb,
-            value_type vlb, value_type vrb, bool report=true)
-        {
-            return self.range_search_2d(lb, rb, vlb, vrb, report);
-        },
-        py::arg("lb"), py::arg("rb"), py::arg("vlb"), py::arg("vrb"),
-        py::arg("report"),
-        "searches points in the index interval [lb..rb] and "
-        "value interval [vlb..vrb].\n"
-        "\tlb: Left bound of index interval (inclusive)\n"
-        "\trb: Right bound of index interval (inclusive)\n"
-        "\tvlb: Left bound of value interval (inclusive)\n"
-        "\tvrb: Right bound of value interval (inclusive)\n"
-        "\treport: Should the matching points be returned?\n"
-        "returns pair (number of found points, vector of points), "
-        "the vector is empty when report = false.",
-        py::call_guard<py::gil_scoped_release>());
+
+    add_range_search_2d(cls);
+    add_parallel_build<wt_int_parallel_builder<T...>>(cls);
+
+    return cls;
+}
+
+
+template <class... T>
+auto add_wavelet_specific(py::class_<sdsl::wm_int<T...>>& cls)
+{
+    add_range_search_2d(cls);
+    add_parallel_build<wm_int_parallel_builder<T...>>(cls);
 
     return cls;
 }
@@ -278,8 +789,8 @@ template <class T>
 inline auto add_wavelet_class(py::module& m, const std::string&& name,
                               const char* doc= nullptr)
 {
-    auto cls = py::class_<T>(m, name.c_str())
-        .def_property_readonly(
+    auto cls = py::class_<T>(m, name.c_str());
+    cls.def_property_readonly(
             "sigma",
             [] (const T& self) { return self.sigma; },
             "Effective alphabet size of the wavelet tree")
@@ -319,13 +830,14 @@ inline auto add_wavelet_class(py::module& m, const std::string&& name,
             "Construct from space-separated human-readable string")
         .def(
             "rank",
-            [] (const T& self, typename T::size_type i,
-                typename T::value_type c)
-            {
-                if (i > self.size()) {
-                    throw std::out_of_range(std::to_string(i)); }
-                return self.rank(i, c);
-            },
+            stats::timed(cls, "rank",
+                [] (const T& self, typename T::size_type i,
+                    typename T::value_type c)
+                {
+                    if (i > self.size()) {
+                        throw std::out_of_range(std::to_string(i)); }
+                    return self.rank(i, c);
+                }),
             "Calculates how many values c are in the prefix [0..i-1] of the "
             "supported vector (i in [0..size]).\nTime complexity: "
             "Order(log(|Sigma|))",
@@ -333,10 +845,11 @@ inline auto add_wavelet_class(py::module& m, const std::string&& name,
             py::call_guard<py::gil_scoped_release>())
         .def(
             "inverse_select",
-            [] (const T& self, typename T::size_type i) {
-                if (i >= self.size()) {
-                    throw std::out_of_range(std::to_string(i)); }
-                return self.inverse_select(i); },
+            stats::timed(cls, "inverse_select",
+                [] (const T& self, typename T::size_type i) {
+                    if (i >= self.size()) {
+                        throw std::out_of_range(std::to_string(i)); }
+                    return self.inverse_select(i); }),
             py::arg("i"),
             "Calculates how many occurrences of value wt[i] are in the prefix"
             "[0..i-1] of the original sequence, returns pair "
@@ -344,21 +857,68 @@ inline auto add_wavelet_class(py::module& m, const std::string&& name,
             py::call_guard<py::gil_scoped_release>())
         .def(
             "select",
-            [] (const T& self, typename T::size_type i,
-                typename T::value_type c)
-            {
-                if (i < 1 || i >= self.size()) {
-                    throw std::out_of_range(std::to_string(i)); }
-                if (i > self.rank(self.size(), c)) {
-                    throw std::invalid_argument(
-                        std::to_string(i) + " is greater than rank(" +
-                        std::to_string(i) + ", " + std::to_string(c) + ")"); }
-                return self.select(i, c); },
+            stats::timed(cls, "select",
+                [] (const T& self, typename T::size_type i,
+                    typename T::value_type c)
+                {
+                    if (i < 1 || i >= self.size()) {
+                        throw std::out_of_range(std::to_string(i)); }
+                    if (i > self.rank(self.size(), c)) {
+                        throw std::invalid_argument(
+                            std::to_string(i) + " is greater than rank(" +
+                            std::to_string(i) + ", " + std::to_string(c) +
+                            ")"); }
+                    return self.select(i, c); }),
             py::arg("i"), py::arg("c"),
             "Calculates the i-th occurrence of the value c in the supported "
             "vector.\nTime complexity: Order(log(|Sigma|))",
             py::call_guard<py::gil_scoped_release>());
 
+    cls.def(
+        "rank_many",
+        [] (const T& self, const input_array<uint64_t>& i,
+            const input_array<uint64_t>& c) {
+            detail::check_1d(i, "i");
+            detail::check_1d(c, "c");
+            if (i.shape(0) != c.shape(0)) {
+                throw std::invalid_argument(
+                    "arrays should have equal length"); }
+            const size_t n = i.shape(0);
+            detail::check_rank_many(self, n, i.data(), c.data());
+            py::array_t<uint64_t> result(n);
+            uint64_t* out = result.mutable_data();
+            {
+                py::gil_scoped_release release;
+                detail::rank_many(self, n, i.data(), c.data(), out);
+            }
+            return result; },
+        py::arg("i"), py::arg("c"),
+        "rank(i[k], c[k]) for every k, i and c are arrays of equal length");
+    cls.def(
+        "rank_many_async",
+        [] (py::object self, const input_array<uint64_t>& i,
+            const input_array<uint64_t>& c) {
+            detail::check_1d(i, "i");
+            detail::check_1d(c, "c");
+            if (i.shape(0) != c.shape(0)) {
+                throw std::invalid_argument(
+                    "arrays should have equal length"); }
+            const T& wt = self.cast<const T&>();
+            const size_t n = i.shape(0);
+            const uint64_t* positions = i.data();
+            const uint64_t* values = c.data();
+            detail::check_rank_many(wt, n, positions, values);
+            return aio::submit(
+                [&wt, n, positions, values] () {
+                    std::vector<uint64_t> result(n);
+                    detail::rank_many(wt, n, positions, values,
+                                      result.data());
+                    return result; },
+                py::make_tuple(self, i, c)); },
+        py::arg("i"), py::arg("c"),
+        "Awaitable rank_many(i, c), runs on the pysdsl worker pool "
+        "(see pysdsl.aio)");
+
     add_wavelet_specific(cls);
 
     add_lex_functor<T>()(cls);
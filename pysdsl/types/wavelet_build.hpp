@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <sdsl/bits.hpp>
+#include <sdsl/wavelet_trees.hpp>
+
+#include "operations/creation.hpp"
+#include "util/parallel.hpp"
+
+
+namespace detail
+{
+    // Chunk bounds of [0..n) such that every bound except 0 and n falls on
+    // a 64-bit word boundary of a bit vector in which position 0 lies at
+    // bit `offset`: threads never write to the same word.
+    inline std::vector<size_t> aligned_bounds(uint64_t offset, size_t n,
+                                              size_t threads)
+    {
+        std::vector<size_t> bounds{0};
+        const size_t chunk = std::max<size_t>(64, (n + threads - 1) / threads);
+        for (size_t pos = chunk; pos < n; pos += chunk) {
+            const size_t aligned = ((offset + pos + 63) / 64) * 64 - offset;
+            if (aligned > bounds.back() && aligned < n) {
+                bounds.push_back(aligned); }
+        }
+        bounds.push_back(n);
+        return bounds;
+    }
+
+
+    // Builds the concatenated level bit vectors of a wavelet tree
+    // (`matrix` = false) or a wavelet matrix (`matrix` = true) over `values`
+    // and returns the number of zeros on every level.
+    //
+    // Every level is processed by all threads: each writes the level bits of
+    // its chunk, then the zero counts of 64-bit words are prefix-summed, and
+    // finally each thread scatters its chunk into the stable partition of
+    // the level using those offsets. For a wavelet tree the partition is
+    // done within each node, i.e. within each run of equal value prefixes.
+    template <class V>
+    inline std::vector<uint64_t> build_levels(std::vector<V>& values,
+                                              uint32_t max_level, bool matrix,
+                                              sdsl::bit_vector& tree,
+                                              size_t threads)
+    {
+        threads = resolve_threads(threads);
+
+        const size_t n = values.size();
+        const size_t words = (n + 63) / 64;
+
+        tree = sdsl::bit_vector(n * max_level, 0);
+        std::vector<V> next(n);
+        std::vector<uint64_t> zero_cnt(max_level);
+        std::vector<uint64_t> word_zeros(words + 1);
+
+        for (uint32_t l = 0; l < max_level; l++) {
+            const uint64_t offset = uint64_t(l) * n;
+            const uint32_t b = max_level - 1 - l;
+
+            const auto bounds = aligned_bounds(offset, n, threads);
+            parallel_for_each_index(bounds.size() - 1, threads, [&] (size_t c) {
+                for (size_t i = bounds[c]; i < bounds[c + 1]; i++) {
+                    if ((values[i] >> b) & 1) tree[offset + i] = 1; }
+            });
+
+            parallel_for_each_index(words, threads, [&] (size_t w) {
+                const uint8_t len = std::min<size_t>(64, n - 64 * w);
+                word_zeros[w + 1] = len - sdsl::bits::cnt(
+                    tree.get_int(offset + 64 * w, len)); });
+            word_zeros[0] = 0;
+            std::partial_sum(word_zeros.begin(), word_zeros.end(),
+                             word_zeros.begin());
+            zero_cnt[l] = word_zeros[words];
+
+            auto zeros_before = [&] (size_t i) -> uint64_t {
+                const size_t w = i / 64;
+                const uint8_t r = i % 64;
+                return word_zeros[w] + r -
+                    (r ? sdsl::bits::cnt(tree.get_int(offset + 64 * w, r)) : 0);
+            };
+            auto prefix = [&] (uint64_t v) -> uint64_t {
+                return (matrix || l == 0) ? 0 : v >> (b + 1); };
+
+            parallel_for(n, threads, [&] (size_t begin, size_t end) {
+                size_t i = begin;
+                while (i < end) {
+                    const uint64_t p = prefix(values[i]);
+                    size_t s = 0, e = n;
+                    if (!matrix) {
+                        s = std::lower_bound(
+                                values.begin(), values.begin() + i, p,
+                                [&] (V v, uint64_t q) {
+                                    return prefix(v) < q; }) - values.begin();
+                        e = std::upper_bound(
+                                values.begin() + i, values.end(), p,
+                                [&] (uint64_t q, V v) {
+                                    return q < prefix(v); }) - values.begin();
+                    }
+                    const uint64_t zs = zeros_before(s);
+                    const uint64_t ze = zeros_before(e);
+                    uint64_t z = zeros_before(i);
+                    for (const size_t stop = std::min(e, end); i < stop; i++) {
+                        if ((values[i] >> b) & 1) {
+                            next[s + (ze - zs) + (i - s) - (z - zs)] = values[i];
+                        } else {
+                            next[s + z - zs] = values[i];
+                            z++; }
+                    }
+                }
+            });
+            values.swap(next);
+        }
+        return zero_cnt;
+    }
+
+
+    // Values are grouped after build_levels, so distinct ones are counted
+    // by comparing neighbours
+    template <class V>
+    inline uint64_t count_distinct(const std::vector<V>& grouped)
+    {
+        uint64_t distinct = grouped.empty() ? 0 : 1;
+        for (size_t i = 1; i < grouped.size(); i++) {
+            distinct += grouped[i] != grouped[i - 1]; }
+        return distinct;
+    }
+
+
+    // Number of bits needed for the largest of `n` values read by `get`
+    template <class Get>
+    inline uint32_t levels_for(size_t n, Get get, size_t threads)
+    {
+        std::vector<uint64_t> maxima(resolve_threads(threads), 1);
+        parallel_for_each_index(maxima.size(), maxima.size(), [&] (size_t t) {
+            const size_t end = n * (t + 1) / maxima.size();
+            for (size_t i = n * t / maxima.size(); i < end; i++) {
+                maxima[t] = std::max<uint64_t>(maxima[t], get(i)); }
+        });
+        return sdsl::bits::hi(*std::max_element(maxima.begin(),
+                                                maxima.end())) + 1;
+    }
+
+
+    // Calls `f` with a value of the narrowest unsigned type of at least
+    // `bits` bits
+    template <class F>
+    inline decltype(auto) with_value_type(uint32_t bits, F f)
+    {
+        if (bits <= 8) return f(uint8_t());
+        if (bits <= 16) return f(uint16_t());
+        if (bits <= 32) return f(uint32_t());
+        return f(uint64_t());
+    }
+
+
+    // Builds with `Builder` from `n` values read by thread-safe `get`.
+    // The values are copied once into a plain array of the narrowest type,
+    // no temporary file image is created.
+    template <class Builder, class Get>
+    inline typename Builder::base_type parallel_build(size_t n, Get get,
+                                                      size_t threads)
+    {
+        const uint32_t max_level = n ? levels_for(n, get, threads) : 0;
+        return with_value_type(max_level, [&] (auto zero) {
+            std::vector<decltype(zero)> values(n);
+            parallel_for(n, threads, [&] (size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) values[i] = get(i); });
+            return Builder::build(std::move(values), max_level, threads);
+        });
+    }
+
+
+    // Same as parallel_build for sequences which can only be read
+    // sequentially
+    template <class Builder, class It>
+    inline typename Builder::base_type sequential_build(It first, It last)
+    {
+        uint64_t x = 1;
+        size_t n = 0;
+        for (auto it = first; it != last; ++it, ++n) {
+            x = std::max<uint64_t>(x, *it); }
+        const uint32_t max_level = n ? sdsl::bits::hi(x) + 1 : 0;
+        return with_value_type(max_level, [&] (auto zero) {
+            std::vector<decltype(zero)> values;
+            values.reserve(n);
+            for (auto it = first; it != last; ++it) values.push_back(*it);
+            return Builder::build(std::move(values), max_level, 1);
+        });
+    }
+}  // namespace detail
+
+
+// Builds sdsl::wt_int level by level on many threads. Derives from the
+// sdsl class only to fill its members; the result is moved into a plain
+// wt_int by `build`.
+template <class... T>
+class wt_int_parallel_builder: public sdsl::wt_int<T...>
+{
+    typedef sdsl::wt_int<T...> base;
+
+    void init_supports(size_t threads)
+    {
+        parallel_for_each_index(3, threads, [this] (size_t which) {
+            if (which == 0) {
+                sdsl::util::init_support(this->m_tree_rank, &this->m_tree);
+            } else if (which == 1) {
+                sdsl::util::init_support(this->m_tree_select1, &this->m_tree);
+            } else {
+                sdsl::util::init_support(this->m_tree_select0, &this->m_tree); }
+        });
+    }
+
+public:
+    typedef base base_type;
+
+    template <class V>
+    static base build(std::vector<V> values, uint32_t max_level,
+                      size_t threads)
+    {
+        wt_int_parallel_builder self;
+        self.m_size = values.size();
+        if (self.m_size == 0) return base(std::move(self));
+
+        self.m_max_level = max_level;
+        self.init_buffers(self.m_max_level);
+
+        sdsl::bit_vector tree;
+        detail::build_levels(values, self.m_max_level, false, tree, threads);
+        self.m_sigma = detail::count_distinct(values);
+        sdsl::util::assign(self.m_tree, tree);
+        self.init_supports(threads);
+
+        return base(std::move(self));
+    }
+};
+
+
+// Same as wt_int_parallel_builder for sdsl::wm_int
+template <class... T>
+class wm_int_parallel_builder: public sdsl::wm_int<T...>
+{
+    typedef sdsl::wm_int<T...> base;
+
+    void init_supports(size_t threads)
+    {
+        parallel_for_each_index(3, threads, [this] (size_t which) {
+            if (which == 0) {
+                sdsl::util::init_support(this->m_tree_rank, &this->m_tree);
+            } else if (which == 1) {
+                sdsl::util::init_support(this->m_tree_select1, &this->m_tree);
+            } else {
+                sdsl::util::init_support(this->m_tree_select0, &this->m_tree); }
+        });
+    }
+
+public:
+    typedef base base_type;
+
+    template <class V>
+    static base build(std::vector<V> values, uint32_t max_level,
+                      size_t threads)
+    {
+        wm_int_parallel_builder self;
+        self.m_size = values.size();
+        if (self.m_size == 0) return base(std::move(self));
+
+        self.m_max_level = max_level;
+
+        sdsl::bit_vector tree;
+        auto zero_cnt = detail::build_levels(values, self.m_max_level, true,
+                                             tree, threads);
+        self.m_sigma = detail::count_distinct(values);
+        sdsl::util::assign(self.m_tree, tree);
+        self.init_supports(threads);
+
+        self.m_zero_cnt = sdsl::int_vector<64>(self.m_max_level, 0);
+        self.m_rank_level = sdsl::int_vector<64>(self.m_max_level, 0);
+        for (uint32_t k = 0; k < self.m_max_level; k++) {
+            self.m_zero_cnt[k] = zero_cnt[k];
+            self.m_rank_level[k] = self.m_tree_rank(k * self.m_size); }
+
+        return base(std::move(self));
+    }
+};
+
+
+namespace detail
+{
+    template <class... T>
+    struct in_memory_builder<sdsl::wt_int<T...>>
+    {
+        static constexpr bool enabled = true;
+
+        template <class It>
+        static sdsl::wt_int<T...> build(It first, It last) {
+            return sequential_build<wt_int_parallel_builder<T...>>(first,
+                                                                   last); }
+    };
+
+    template <class... T>
+    struct in_memory_builder<sdsl::wm_int<T...>>
+    {
+        static constexpr bool enabled = true;
+
+        template <class It>
+        static sdsl::wm_int<T...> build(It first, It last) {
+            return sequential_build<wm_int_parallel_builder<T...>>(first,
+                                                                   last); }
+    };
+}  // namespace detail
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+
+#include "operations/batch.hpp"
+
+
+namespace py = pybind11;
+
+
+// Awaitable calls (pysdsl.aio).
+//
+// A `*_async` method packs its work into a job and hands it to
+// pysdsl.aio.submit, which returns an asyncio future. The job runs on the
+// worker pool of the pysdsl._async extension without the GIL; its result is
+// converted to a Python object on the event loop thread. Jobs hold their
+// Python objects (the queried structure, input arrays) until they are
+// released on the event loop thread, so workers never touch refcounts.
+namespace aio
+{
+    template <class T>
+    inline py::object to_python(T&& value)
+    {
+        return py::cast(std::forward<T>(value));
+    }
+
+    template <class T>
+    inline py::object to_python(std::vector<T>&& values)
+    {
+        return ::detail::to_numpy(values);
+    }
+
+
+    // Shared between extension modules: only called through its vtable
+    class job
+    {
+    private:
+        std::exception_ptr m_error;
+    protected:
+        virtual void run() = 0;
+        virtual py::object result() = 0;
+    public:
+        virtual ~job() = default;
+
+        // On a worker, without the GIL
+        void execute() noexcept
+        {
+            try {
+                run();
+            } catch (...) {
+                m_error = std::current_exception(); }
+        }
+
+        // On the event loop thread with the GIL held: the value of the
+        // call, or rethrows its exception
+        py::object finish()
+        {
+            if (m_error) std::rethrow_exception(m_error);
+            return result();
+        }
+    };
+
+
+    template <class F>
+    class call_job: public job
+    {
+    private:
+        typedef typename std::decay<
+            decltype(std::declval<F&>()())>::type value_type;
+
+        F m_f;
+        py::object m_owners;
+        std::unique_ptr<value_type> m_value;
+    protected:
+        void run() override { m_value.reset(new value_type(m_f())); }
+
+        py::object result() override
+        {
+            return to_python(std::move(*m_value));
+        }
+    public:
+        call_job(F f, py::object owners):
+            m_f(std::move(f)), m_owners(std::move(owners))
+        {}
+    };
+
+
+    // Runs `f()` on the pysdsl worker pool and returns an asyncio future of
+    // its result; `owners` are kept alive until the future is resolved
+    template <class F>
+    py::object submit(F f, py::object owners = py::none())
+    {
+        auto* holder = new std::shared_ptr<job>(
+            std::make_shared<call_job<F>>(std::move(f), std::move(owners)));
+        py::capsule capsule(holder, +[] (void* p) {
+            delete static_cast<std::shared_ptr<job>*>(p); });
+        return py::module::import("pysdsl.aio").attr("submit")(capsule);
+    }
+}  // namespace aio
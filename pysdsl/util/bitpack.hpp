@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sdsl/bits.hpp>
+
+
+namespace detail
+{
+    // Number of bits needed to store the largest of n values (at least 1)
+    inline uint8_t bits_needed(const uint64_t* values, size_t n)
+    {
+        uint64_t all = 0;
+        for (size_t i = 0; i < n; i++) all |= values[i];
+        return all ? sdsl::bits::hi(all) + 1 : 1;
+    }
+
+
+    // Writes n values of `width` bits each into the bit array `data`
+    // starting at bit `offset`. Values are combined into whole 64-bit
+    // words in a register, so every word of the destination is stored
+    // once; bits below `offset` are kept, bits above the last value are
+    // zeroed within its word. Values must fit in `width` bits.
+    inline void pack_values(uint64_t* data, uint64_t offset,
+                            const uint64_t* values, size_t n, uint8_t width)
+    {
+        if (n == 0) return;
+        uint64_t* out = data + offset / 64;
+        unsigned filled = offset % 64;
+        uint64_t word = filled ? *out & (~uint64_t(0) >> (64 - filled)) : 0;
+        for (size_t i = 0; i < n; i++) {
+            const uint64_t value = values[i];
+            word |= value << filled;
+            filled += width;
+            if (filled >= 64) {
+                *out++ = word;
+                filled -= 64;
+                word = filled ? value >> (width - filled) : 0;
+            }
+        }
+        if (filled) *out = word;
+    }
+}  // namespace detail
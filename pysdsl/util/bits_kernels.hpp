@@ -0,0 +1,640 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sdsl/bits.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PYSDSL_X86_KERNELS 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+
+// Word-array versions of sdsl::bits functions. Every function has a
+// portable kernel (the sdsl routine in a loop) and, on x86-64, kernels
+// compiled for wider instruction sets with target attributes; the best
+// one supported by the running CPU is picked on first use, so the module
+// itself is built for the baseline architecture.
+namespace bits_kernels
+{
+    typedef void (*unary_kernel)(const uint64_t*, uint64_t*, size_t);
+    typedef void (*binary_kernel)(const uint64_t*, const uint64_t*,
+                                  uint64_t*, size_t);
+    typedef uint64_t (*word_kernel)(uint64_t, uint32_t);
+    typedef uint64_t (*count_kernel)(const uint64_t*, size_t);
+    typedef uint64_t (*pair_count_kernel)(const uint64_t*, const uint64_t*,
+                                          size_t);
+    // Writes the positions of the set bits of in[0..n), the first bit of
+    // in[0] being at `base`, and returns their number. `out` should have
+    // room for ones_slack more positions.
+    typedef size_t (*ones_kernel)(const uint64_t*, size_t, uint64_t,
+                                  uint64_t*);
+
+    constexpr size_t ones_slack = 8;
+
+    // Word-wise operations between two bit arrays; op_andnot is a & ~b
+    enum bitwise_op { op_and, op_or, op_xor, op_andnot };
+
+    template <class K>
+    struct kernel
+    {
+        K run;
+        const char* name;
+    };
+
+
+    inline void cnt_generic(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) out[i] = sdsl::bits::cnt(in[i]);
+    }
+
+    inline void hi_generic(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) out[i] = sdsl::bits::hi(in[i]);
+    }
+
+    inline void lo_generic(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) out[i] = sdsl::bits::lo(in[i]);
+    }
+
+    inline void rev_generic(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) out[i] = sdsl::bits::rev(in[i]);
+    }
+
+    inline uint64_t sel_word_generic(uint64_t x, uint32_t i)
+    {
+        return sdsl::bits::sel(x, i);
+    }
+
+    inline uint64_t popcount_generic(const uint64_t* in, size_t n)
+    {
+        uint64_t result = 0;
+        for (size_t i = 0; i < n; i++) result += sdsl::bits::cnt(in[i]);
+        return result;
+    }
+
+    inline size_t ones_generic(const uint64_t* in, size_t n, uint64_t base,
+                               uint64_t* out)
+    {
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++) {
+            for (uint64_t x = in[i]; x; x &= x - 1) {
+                out[k++] = base + 64 * i + sdsl::bits::lo(x); } }
+        return k;
+    }
+
+    template <bitwise_op op>
+    inline uint64_t combine_word(uint64_t a, uint64_t b)
+    {
+        switch (op) {
+            case op_and: return a & b;
+            case op_or: return a | b;
+            case op_xor: return a ^ b;
+            default: return a & ~b;
+        }
+    }
+
+    // out may be a (in place)
+    template <bitwise_op op>
+    inline void combine_generic(const uint64_t* a, const uint64_t* b,
+                                uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) out[i] = combine_word<op>(a[i], b[i]);
+    }
+
+    template <bitwise_op op>
+    inline uint64_t combine_count_generic(const uint64_t* a,
+                                          const uint64_t* b, size_t n)
+    {
+        uint64_t result = 0;
+        for (size_t i = 0; i < n; i++) {
+            result += sdsl::bits::cnt(combine_word<op>(a[i], b[i])); }
+        return result;
+    }
+
+    // i[k] in [1..64]
+    inline void sel_generic(const uint64_t* in, const uint64_t* i,
+                            uint64_t* out, size_t n)
+    {
+        for (size_t k = 0; k < n; k++) {
+            out[k] = sdsl::bits::sel(in[k], uint32_t(i[k])); }
+    }
+
+
+#ifdef PYSDSL_X86_KERNELS
+    __attribute__((target("popcnt")))
+    inline void cnt_popcnt(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) out[i] = __builtin_popcountll(in[i]);
+    }
+
+    // Nibble lookups with vpshufb, summed per word with vpsadbw
+    __attribute__((target("avx2")))
+    inline __m256i popcount_avx2(__m256i v)
+    {
+        const __m256i table = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        const __m256i bytes = _mm256_add_epi8(
+            _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble)),
+            _mm256_shuffle_epi8(
+                table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+        return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    inline void cnt_avx2(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(out + i),
+                popcount_avx2(_mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(in + i))));
+        }
+        for (; i < n; i++) out[i] = __builtin_popcountll(in[i]);
+    }
+
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    inline void cnt_avx512(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_si512(
+                out + i, _mm512_popcnt_epi64(_mm512_loadu_si512(in + i))); }
+        if (i < n) {
+            const __mmask8 mask = (1u << (n - i)) - 1;
+            _mm512_mask_storeu_epi64(
+                out + i, mask,
+                _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(mask, in + i)));
+        }
+    }
+
+    __attribute__((target("popcnt")))
+    inline uint64_t popcount_popcnt(const uint64_t* in, size_t n)
+    {
+        uint64_t result = 0;
+        for (size_t i = 0; i < n; i++) result += __builtin_popcountll(in[i]);
+        return result;
+    }
+
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    inline uint64_t popcount_avx512(const uint64_t* in, size_t n)
+    {
+        __m512i sum = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            sum = _mm512_add_epi64(
+                sum, _mm512_popcnt_epi64(_mm512_loadu_si512(in + i))); }
+        if (i < n) {
+            const __mmask8 mask = (1u << (n - i)) - 1;
+            sum = _mm512_add_epi64(
+                sum,
+                _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(mask, in + i)));
+        }
+        return _mm512_reduce_add_epi64(sum);
+    }
+
+    template <bitwise_op op>
+    __attribute__((target("avx2")))
+    inline __m256i combine_vector_avx2(__m256i a, __m256i b)
+    {
+        switch (op) {
+            case op_and: return _mm256_and_si256(a, b);
+            case op_or: return _mm256_or_si256(a, b);
+            case op_xor: return _mm256_xor_si256(a, b);
+            default: return _mm256_andnot_si256(b, a);
+        }
+    }
+
+    template <bitwise_op op>
+    __attribute__((target("avx2")))
+    inline void combine_avx2(const uint64_t* a, const uint64_t* b,
+                             uint64_t* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(out + i),
+                combine_vector_avx2<op>(
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(a + i)),
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(b + i))));
+        }
+        for (; i < n; i++) out[i] = combine_word<op>(a[i], b[i]);
+    }
+
+    template <bitwise_op op>
+    __attribute__((target("avx512f")))
+    inline __m512i combine_vector_avx512(__m512i a, __m512i b)
+    {
+        switch (op) {
+            case op_and: return _mm512_and_si512(a, b);
+            case op_or: return _mm512_or_si512(a, b);
+            case op_xor: return _mm512_xor_si512(a, b);
+            default: return _mm512_andnot_si512(b, a);
+        }
+    }
+
+    template <bitwise_op op>
+    __attribute__((target("avx512f")))
+    inline void combine_avx512(const uint64_t* a, const uint64_t* b,
+                               uint64_t* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_si512(
+                out + i,
+                combine_vector_avx512<op>(_mm512_loadu_si512(a + i),
+                                          _mm512_loadu_si512(b + i))); }
+        if (i < n) {
+            const __mmask8 mask = (1u << (n - i)) - 1;
+            _mm512_mask_storeu_epi64(
+                out + i, mask,
+                combine_vector_avx512<op>(
+                    _mm512_maskz_loadu_epi64(mask, a + i),
+                    _mm512_maskz_loadu_epi64(mask, b + i)));
+        }
+    }
+
+    template <bitwise_op op>
+    __attribute__((target("popcnt")))
+    inline uint64_t combine_count_popcnt(const uint64_t* a,
+                                         const uint64_t* b, size_t n)
+    {
+        uint64_t result = 0;
+        for (size_t i = 0; i < n; i++) {
+            result += __builtin_popcountll(combine_word<op>(a[i], b[i])); }
+        return result;
+    }
+
+    template <bitwise_op op>
+    __attribute__((target("avx2,popcnt")))
+    inline uint64_t combine_count_avx2(const uint64_t* a, const uint64_t* b,
+                                       size_t n)
+    {
+        __m256i sum = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            sum = _mm256_add_epi64(
+                sum, popcount_avx2(combine_vector_avx2<op>(
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(a + i)),
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(b + i)))));
+        }
+        uint64_t result = _mm256_extract_epi64(sum, 0) +
+                          _mm256_extract_epi64(sum, 1) +
+                          _mm256_extract_epi64(sum, 2) +
+                          _mm256_extract_epi64(sum, 3);
+        for (; i < n; i++) {
+            result += __builtin_popcountll(combine_word<op>(a[i], b[i])); }
+        return result;
+    }
+
+    template <bitwise_op op>
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    inline uint64_t combine_count_avx512(const uint64_t* a,
+                                         const uint64_t* b, size_t n)
+    {
+        __m512i sum = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            sum = _mm512_add_epi64(
+                sum, _mm512_popcnt_epi64(combine_vector_avx512<op>(
+                    _mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))));
+        }
+        if (i < n) {
+            const __mmask8 mask = (1u << (n - i)) - 1;
+            sum = _mm512_add_epi64(
+                sum, _mm512_popcnt_epi64(combine_vector_avx512<op>(
+                    _mm512_maskz_loadu_epi64(mask, a + i),
+                    _mm512_maskz_loadu_epi64(mask, b + i))));
+        }
+        return _mm512_reduce_add_epi64(sum);
+    }
+
+    // tzcnt for the lowest set bit, blsr to clear it
+    __attribute__((target("bmi")))
+    inline size_t ones_bmi(const uint64_t* in, size_t n, uint64_t base,
+                           uint64_t* out)
+    {
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++) {
+            for (uint64_t x = in[i]; x; x = _blsr_u64(x)) {
+                out[k++] = base + 64 * i + _tzcnt_u64(x); } }
+        return k;
+    }
+
+    // Every byte of a word picks its set positions out of eight
+    // consecutive ones with vpcompressq; the store writes all eight lanes,
+    // hence ones_slack
+    __attribute__((target("avx512f,popcnt")))
+    inline size_t ones_avx512(const uint64_t* in, size_t n, uint64_t base,
+                              uint64_t* out)
+    {
+        const __m512i step = _mm512_set1_epi64(8);
+        __m512i positions = _mm512_add_epi64(
+            _mm512_set1_epi64(base), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++) {
+            const uint64_t x = in[i];
+            if (!x) {
+                positions = _mm512_add_epi64(positions,
+                                             _mm512_set1_epi64(64));
+                continue;
+            }
+            for (unsigned b = 0; b < 64; b += 8) {
+                const __mmask8 mask = __mmask8(x >> b);
+                if (mask) {
+                    _mm512_storeu_si512(
+                        out + k, _mm512_maskz_compress_epi64(mask, positions));
+                    k += __builtin_popcount(mask);
+                }
+                positions = _mm512_add_epi64(positions, step);
+            }
+        }
+        return k;
+    }
+
+    // lzcnt is its own feature (ABM), not part of BMI1
+    __attribute__((target("lzcnt")))
+    inline void hi_lzcnt(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = in[i] ? 63 - _lzcnt_u64(in[i]) : 0; }
+    }
+
+    __attribute__((target("bmi")))
+    inline void lo_bmi(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = in[i] ? _tzcnt_u64(in[i]) : 0; }
+    }
+
+    // Bytes reversed within each word by vpshufb, then the bits of every
+    // byte by two nibble lookups
+    __attribute__((target("avx2")))
+    inline void rev_avx2(const uint64_t* in, uint64_t* out, size_t n)
+    {
+        const __m256i bytes = _mm256_setr_epi8(
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        // reversed nibble, in the low and in the high half of a byte
+        const __m256i low = _mm256_setr_epi8(
+            0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
+            0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf,
+            0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
+            0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf);
+        const __m256i high = _mm256_slli_epi16(low, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256i v = _mm256_shuffle_epi8(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)),
+                bytes);
+            const __m256i r = _mm256_or_si256(
+                _mm256_shuffle_epi8(high, _mm256_and_si256(v, nibble)),
+                _mm256_shuffle_epi8(
+                    low, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+        }
+        for (; i < n; i++) out[i] = sdsl::bits::rev(in[i]);
+    }
+
+    // The i-th set bit is where PDEP deposits bit i - 1 of a mask
+    __attribute__((target("bmi,bmi2")))
+    inline uint64_t sel_word_bmi2(uint64_t x, uint32_t i)
+    {
+        return _tzcnt_u64(_pdep_u64(uint64_t(1) << (i - 1), x));
+    }
+
+    __attribute__((target("bmi,bmi2")))
+    inline void sel_bmi2(const uint64_t* in, const uint64_t* i,
+                         uint64_t* out, size_t n)
+    {
+        for (size_t k = 0; k < n; k++) {
+            out[k] = _tzcnt_u64(_pdep_u64(uint64_t(1) << (i[k] - 1), in[k]));
+        }
+    }
+
+    // AMD family 17h (Zen, Zen 2) and Hygon's family 18h derivative
+    // implement PDEP in microcode, at tens to hundreds of cycles: slower
+    // than the table-driven select
+    inline bool slow_pdep()
+    {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) return false;
+        // "AuthenticAMD" and "HygonGenuine" in ebx, edx, ecx
+        const bool amd = ebx == 0x68747541 && edx == 0x69746e65 &&
+                         ecx == 0x444d4163;
+        const bool hygon = ebx == 0x6f677948 && edx == 0x6e65476e &&
+                           ecx == 0x656e6975;
+        if (!(amd || hygon) || !__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return false; }
+        unsigned family = (eax >> 8) & 0xf;
+        if (family == 0xf) family += (eax >> 20) & 0xff;
+        return family == 0x17 || family == 0x18;
+    }
+
+    inline bool fast_pdep()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("bmi2") && !slow_pdep();
+    }
+
+    // LZCNT/ABM flag of the extended features, which not every compiler's
+    // __builtin_cpu_supports knows
+    inline bool has_lzcnt()
+    {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx)) return false;
+        return ecx & (1u << 5);
+    }
+#endif
+
+
+    inline kernel<unary_kernel> pick_cnt()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512vpopcntdq")) {
+            return {cnt_avx512, "avx512vpopcntdq"}; }
+        if (__builtin_cpu_supports("avx2")) return {cnt_avx2, "avx2"};
+        if (__builtin_cpu_supports("popcnt")) return {cnt_popcnt, "popcnt"};
+#endif
+        return {cnt_generic, "generic"};
+    }
+
+    inline kernel<unary_kernel> pick_hi()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        if (has_lzcnt()) return {hi_lzcnt, "lzcnt"};
+#endif
+        return {hi_generic, "generic"};
+    }
+
+    inline kernel<unary_kernel> pick_lo()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("bmi")) return {lo_bmi, "tzcnt"};
+#endif
+        return {lo_generic, "generic"};
+    }
+
+    inline kernel<unary_kernel> pick_rev()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return {rev_avx2, "avx2"};
+#endif
+        return {rev_generic, "generic"};
+    }
+
+    inline kernel<count_kernel> pick_popcount()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512vpopcntdq")) {
+            return {popcount_avx512, "avx512vpopcntdq"}; }
+        if (__builtin_cpu_supports("popcnt")) {
+            return {popcount_popcnt, "popcnt"}; }
+#endif
+        return {popcount_generic, "generic"};
+    }
+
+    inline kernel<ones_kernel> pick_ones()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return {ones_avx512, "avx512f"}; }
+        if (__builtin_cpu_supports("bmi")) return {ones_bmi, "tzcnt"};
+#endif
+        return {ones_generic, "generic"};
+    }
+
+    template <bitwise_op op>
+    inline kernel<binary_kernel> pick_combine()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return {combine_avx512<op>, "avx512f"}; }
+        if (__builtin_cpu_supports("avx2")) return {combine_avx2<op>, "avx2"};
+#endif
+        return {combine_generic<op>, "generic"};
+    }
+
+    template <bitwise_op op>
+    inline kernel<pair_count_kernel> pick_combine_count()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512vpopcntdq")) {
+            return {combine_count_avx512<op>, "avx512vpopcntdq"}; }
+        if (__builtin_cpu_supports("avx2")) {
+            return {combine_count_avx2<op>, "avx2"}; }
+        if (__builtin_cpu_supports("popcnt")) {
+            return {combine_count_popcnt<op>, "popcnt"}; }
+#endif
+        return {combine_count_generic<op>, "generic"};
+    }
+
+    inline kernel<binary_kernel> pick_sel()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        if (fast_pdep()) return {sel_bmi2, "bmi2"};
+#endif
+        return {sel_generic, "generic"};
+    }
+
+    inline kernel<word_kernel> pick_sel_word()
+    {
+#ifdef PYSDSL_X86_KERNELS
+        if (fast_pdep()) return {sel_word_bmi2, "bmi2"};
+#endif
+        return {sel_word_generic, "generic"};
+    }
+
+
+    // chosen once per process
+    inline const kernel<unary_kernel>& cnt()
+    {
+        static const auto k = pick_cnt();
+        return k;
+    }
+
+    inline const kernel<unary_kernel>& hi()
+    {
+        static const auto k = pick_hi();
+        return k;
+    }
+
+    inline const kernel<unary_kernel>& lo()
+    {
+        static const auto k = pick_lo();
+        return k;
+    }
+
+    inline const kernel<unary_kernel>& rev()
+    {
+        static const auto k = pick_rev();
+        return k;
+    }
+
+    // Number of set bits of a word array
+    inline const kernel<count_kernel>& popcount()
+    {
+        static const auto k = pick_popcount();
+        return k;
+    }
+
+    inline const kernel<ones_kernel>& ones()
+    {
+        static const auto k = pick_ones();
+        return k;
+    }
+
+    // out[i] = a[i] op b[i]
+    template <bitwise_op op>
+    inline const kernel<binary_kernel>& combine()
+    {
+        static const auto k = pick_combine<op>();
+        return k;
+    }
+
+    // Number of set bits of a[i] op b[i], without storing them
+    template <bitwise_op op>
+    inline const kernel<pair_count_kernel>& combine_count()
+    {
+        static const auto k = pick_combine_count<op>();
+        return k;
+    }
+
+    inline const kernel<binary_kernel>& sel()
+    {
+        static const auto k = pick_sel();
+        return k;
+    }
+
+    inline const kernel<word_kernel>& sel_word()
+    {
+        static const auto k = pick_sel_word();
+        return k;
+    }
+
+    // Position of the i-th (i in [1..64]) set bit of x, as sdsl::bits::sel
+    // but with PDEP where it is fast
+    inline uint64_t select(uint64_t x, uint32_t i)
+    {
+        return sel_word().run(x, i);
+    }
+}  // namespace bits_kernels
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sdsl/config.hpp>
+#include <sdsl/io.hpp>
+#include <sdsl/util.hpp>
+
+
+namespace detail
+{
+    // Prefix of temporary and construction cache files, unique within the
+    // process. sdsl::util::id() is a plain counter, so builds running on
+    // several threads could be handed the same name and overwrite each
+    // other's files.
+    inline std::string unique_file_id()
+    {
+        static std::atomic<uint64_t> counter(0);
+        return sdsl::util::to_string(sdsl::util::pid()) + "_pysdsl_" +
+               sdsl::util::to_string(counter++);
+    }
+
+
+    // Removes the files of a construction cache when going out of scope,
+    // so that a failed build leaves nothing behind: the files registered
+    // in the cache and those of `keys`, which may have been written
+    // before an error kept them from being registered.
+    class cache_cleanup
+    {
+        sdsl::cache_config& m_config;
+        std::vector<std::string> m_keys;
+
+    public:
+        cache_cleanup(sdsl::cache_config& config,
+                      std::vector<std::string> keys):
+            m_config(config), m_keys(std::move(keys)) {}
+
+        cache_cleanup(const cache_cleanup&) = delete;
+        cache_cleanup& operator=(const cache_cleanup&) = delete;
+
+        ~cache_cleanup()
+        {
+            for (const auto& key: m_keys) {
+                sdsl::remove(sdsl::cache_file_name(key, m_config)); }
+            sdsl::util::delete_all_files(m_config.file_map);
+        }
+    };
+}  // namespace detail
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/sorted_int_stack.hpp>
+
+#include "util/signature.hpp"
+
+
+namespace py = pybind11;
+
+
+#if defined(Py_GIL_DISABLED) && \
+    (PYBIND11_VERSION_MAJOR < 2 || \
+     (PYBIND11_VERSION_MAJOR == 2 && PYBIND11_VERSION_MINOR < 13))
+#error "free-threaded Python needs pybind11 2.13 or newer"
+#endif
+
+
+// Thread safety of the bindings.
+//
+// Queries of immutable structures (compressed vectors, wavelet trees,
+// suffix arrays, ...) run without the GIL and without locks: any number of
+// threads may query a shared object. Structures with mutating methods (int
+// and bit vectors, sorted int stacks) are guarded by a reader/writer lock
+// per object: queries take it shared, mutating methods exclusively. Code
+// holding a lock never acquires the GIL, so threads waiting for a lock with
+// the GIL held can not deadlock.
+namespace locking
+{
+    // Structures with mutating methods bound
+    template <class T>
+    struct is_mutable: std::false_type {};
+
+    template <uint8_t width>
+    struct is_mutable<sdsl::int_vector<width>>: std::true_type {};
+
+    template <>
+    struct is_mutable<sdsl::sorted_int_stack>: std::true_type {};
+
+
+    // Locks are striped by object address: objects sharing a stripe only
+    // contend. A call holds a single stripe, except for multi_guard which
+    // takes several at once in table order.
+    struct lock_table
+    {
+        static constexpr size_t stripes = 1024;
+
+        std::shared_timed_mutex locks[stripes];
+
+        std::shared_timed_mutex& of(const void* object)
+        {
+            const auto address = reinterpret_cast<uintptr_t>(object);
+            return locks[((address >> 4) * 0x9E3779B97F4A7C15ull) >> 54];
+        }
+    };
+
+
+    // Shared by all extension modules through the pysdsl package, the
+    // first module to ask creates it. Must first be called with the GIL
+    // held, which binding does.
+    inline lock_table& table()
+    {
+        static lock_table* instance = [] {
+            py::object package = py::module::import("pysdsl").attr(
+                "__dict__");
+            py::object table = package.attr("setdefault")(
+                "_object_locks",
+                py::capsule(new lock_table(), "pysdsl._object_locks"));
+            return static_cast<lock_table*>(
+                py::reinterpret_borrow<py::capsule>(table)); }();
+        return *instance;
+    }
+
+
+    template <class T, bool = is_mutable<T>::value>
+    class shared_guard
+    {
+    public:
+        explicit shared_guard(const T&) {}
+    };
+
+    template <class T>
+    class shared_guard<T, true>
+    {
+    private:
+        std::shared_lock<std::shared_timed_mutex> m_lock;
+    public:
+        explicit shared_guard(const T& object): m_lock(table().of(&object)) {}
+    };
+
+
+    template <class T, bool = is_mutable<T>::value>
+    class unique_guard
+    {
+    public:
+        explicit unique_guard(const T&) {}
+    };
+
+    template <class T>
+    class unique_guard<T, true>
+    {
+    private:
+        std::unique_lock<std::shared_timed_mutex> m_lock;
+    public:
+        explicit unique_guard(const T& object): m_lock(table().of(&object)) {}
+    };
+
+
+    // Locks of several objects of type T for operations between them:
+    // `objects` shared and `exclusive` (if any) exclusively. A stripe
+    // shared by several of them is taken once, exclusively if any of its
+    // objects is the exclusive one.
+    template <class T>
+    class multi_guard
+    {
+    private:
+        std::vector<std::pair<std::shared_timed_mutex*, bool>> m_locks;
+
+    public:
+        explicit multi_guard(const std::vector<const T*>& objects,
+                             const T* exclusive = nullptr)
+        {
+            if (!is_mutable<T>::value) return;
+            for (auto object: objects) {
+                m_locks.emplace_back(&table().of(object), false); }
+            if (exclusive) {
+                m_locks.emplace_back(&table().of(exclusive), true); }
+            // exclusive entries first within a stripe, kept by unique
+            std::sort(m_locks.begin(), m_locks.end(),
+                      [] (const std::pair<std::shared_timed_mutex*, bool>& a,
+                          const std::pair<std::shared_timed_mutex*, bool>& b) {
+                          return a.first < b.first ||
+                                 (a.first == b.first && a.second > b.second);
+                      });
+            m_locks.erase(
+                std::unique(
+                    m_locks.begin(), m_locks.end(),
+                    [] (const std::pair<std::shared_timed_mutex*, bool>& a,
+                        const std::pair<std::shared_timed_mutex*, bool>& b) {
+                        return a.first == b.first; }),
+                m_locks.end());
+            for (auto& lock: m_locks) {
+                if (lock.second) lock.first->lock();
+                else lock.first->lock_shared();
+            }
+        }
+
+        multi_guard(const multi_guard&) = delete;
+        multi_guard& operator=(const multi_guard&) = delete;
+
+        ~multi_guard()
+        {
+            for (auto it = m_locks.rbegin(); it != m_locks.rend(); ++it) {
+                if (it->second) it->first->unlock();
+                else it->first->unlock_shared();
+            }
+        }
+    };
+
+
+    namespace detail
+    {
+        template <template <class, bool> class Guard, class F, class R,
+                  class Self, class... Args>
+        auto guarded(F&& f, R (*)(Self, Args...))
+        {
+            typedef typename std::decay<Self>::type T;
+            if (is_mutable<T>::value) table();
+            return [f] (Self self, Args... args) -> R {
+                Guard<T, is_mutable<T>::value> guard(self);
+                return f(std::forward<Self>(self),
+                         std::forward<Args>(args)...); };
+        }
+    }  // namespace detail
+
+
+    // Wraps the lambda `f`, whose first argument is the object, so that it
+    // holds the object's lock shared. Bind it with the GIL released so that
+    // other threads run while it waits.
+    template <class F>
+    auto reading(F&& f)
+    {
+        return detail::guarded<shared_guard>(
+            std::forward<F>(f),
+            static_cast<::detail::call_signature_t<F>*>(nullptr));
+    }
+
+    // Same as reading(f) for mutating methods, which hold the lock
+    // exclusively
+    template <class F>
+    auto writing(F&& f)
+    {
+        return detail::guarded<unique_guard>(
+            std::forward<F>(f),
+            static_cast<::detail::call_signature_t<F>*>(nullptr));
+    }
+
+
+    // Declares an extension module safe to use without the GIL on
+    // free-threaded Python
+    inline void gil_not_used(py::module& m)
+    {
+#ifdef Py_GIL_DISABLED
+        PyUnstable_Module_SetGIL(m.ptr(), Py_MOD_GIL_NOT_USED);
+#else
+        (void) m;
+#endif
+    }
+}  // namespace locking
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace detail
+{
+    inline size_t resolve_threads(size_t threads)
+    {
+        if (threads > 0) return threads;
+        const size_t hw = std::thread::hardware_concurrency();
+        return hw > 0 ? hw : 1;
+    }
+}  // namespace detail
+
+
+// Splits [0..n) into at most `threads` contiguous chunks and calls
+// `f(begin, end)` for each of them on its own thread (threads = 0 means
+// one per hardware thread). The first exception thrown by a worker is
+// rethrown in the calling thread after all workers have finished.
+template <class F>
+inline void parallel_for(size_t n, size_t threads, F f)
+{
+    threads = std::min(detail::resolve_threads(threads), std::max<size_t>(n, 1));
+    if (threads <= 1) {
+        f(size_t(0), n);
+        return; }
+
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(threads);
+    const size_t chunk = (n + threads - 1) / threads;
+
+    for (size_t t = 0; t < threads; t++) {
+        const size_t begin = std::min(n, t * chunk);
+        const size_t end = std::min(n, begin + chunk);
+        workers.emplace_back([&f, &errors, t, begin, end] () {
+            try {
+                f(begin, end);
+            } catch (...) {
+                errors[t] = std::current_exception(); }
+        });
+    }
+    for (auto& worker: workers) worker.join();
+    for (auto& error: errors) {
+        if (error) std::rethrow_exception(error); }
+}
+
+
+// Calls `f(i)` for every i in [0..n) on up to `threads` threads
+template <class F>
+inline void parallel_for_each_index(size_t n, size_t threads, F f)
+{
+    parallel_for(n, threads, [&f] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) f(i); });
+}
+
+
+// Sorts [first, last) by sorting contiguous chunks concurrently and
+// merging them pairwise
+template <class It>
+inline void parallel_sort(It first, It last, size_t threads)
+{
+    const size_t n = std::distance(first, last);
+    threads = detail::resolve_threads(threads);
+    if (threads <= 1 || n < (1u << 16)) {
+        std::sort(first, last);
+        return; }
+
+    const size_t chunk = (n + threads - 1) / threads;
+    std::vector<size_t> bounds;
+    for (size_t b = 0; b < n; b += chunk) bounds.push_back(b);
+    bounds.push_back(n);
+
+    parallel_for_each_index(bounds.size() - 1, threads, [&] (size_t i) {
+        std::sort(first + bounds[i], first + bounds[i + 1]); });
+
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        const size_t pairs = (bounds.size() - 1) / 2;
+        parallel_for_each_index(pairs, threads, [&] (size_t i) {
+            std::inplace_merge(first + bounds[2 * i],
+                               first + bounds[2 * i + 1],
+                               first + bounds[2 * i + 2]); });
+        for (size_t i = 0; i < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]); }
+        if (merged.back() != n) merged.push_back(n);
+        bounds.swap(merged);
+    }
+}
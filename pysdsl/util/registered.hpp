@@ -0,0 +1,31 @@
+#pragma once
+
+#include <tuple>
+
+#include <pybind11/pybind11.h>
+
+
+namespace py = pybind11;
+
+
+// Python class already bound for T by another pysdsl extension module.
+// Lets a family module add cross-family constructors and methods to
+// classes it does not own.
+template <class T>
+inline py::class_<T> registered_class() {
+    return py::reinterpret_borrow<py::class_<T>>(py::type::of<T>()); }
+
+
+namespace detail
+{
+    template <class... T>
+    inline auto registered_classes(const std::tuple<py::class_<T>...>*) {
+        return std::make_tuple(registered_class<T>()...); }
+}  // namespace detail
+
+
+// Same tuple of classes as the add_* function of a family returned,
+// e.g. registered_classes<int_vector_classes>()
+template <class Classes>
+inline auto registered_classes() {
+    return detail::registered_classes(static_cast<Classes*>(nullptr)); }
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <type_traits>
+
+
+namespace detail
+{
+    // Function type R(Args...) of the call operator of a lambda, so that a
+    // wrapper can be bound by pybind11 with the same arguments
+    template <class F>
+    struct call_signature: call_signature<decltype(&F::operator())> {};
+
+    template <class C, class R, class... Args>
+    struct call_signature<R (C::*)(Args...) const>
+    {
+        typedef R type(Args...);
+    };
+
+    template <class F>
+    using call_signature_t = typename call_signature<
+        typename std::decay<F>::type>::type;
+}  // namespace detail
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include <pybind11/pybind11.h>
+
+#include "util/signature.hpp"
+
+
+namespace py = pybind11;
+
+
+// Opt-in instrumentation of hot methods (pysdsl.stats).
+//
+// Counters live in the pysdsl._stats extension and are shared with every
+// family module through a capsule. Each thread writes only its own
+// counters, so recording a call takes no locks and no atomic
+// read-modify-write; when instrumentation is disabled a wrapped method
+// costs one relaxed load of the `enabled` flag.
+namespace stats
+{
+    // Log-linear (HDR-style) latency buckets: values below 8 ns are exact,
+    // above that every power of two is split into 8 sub-buckets, so a
+    // bucket bound is within 12.5% of any value in it.
+    constexpr unsigned sub_bucket_bits = 3;
+    constexpr size_t sub_buckets = 1 << sub_bucket_bits;
+    constexpr size_t histogram_buckets = (64 - sub_bucket_bits + 1) *
+                                         sub_buckets;
+
+    inline unsigned highest_bit(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        unsigned result = 0;
+        while (value >>= 1) result++;
+        return result;
+#endif
+    }
+
+    inline size_t bucket(uint64_t ns)
+    {
+        if (ns < sub_buckets) return ns;
+        const unsigned magnitude = highest_bit(ns);
+        const size_t sub = (ns >> (magnitude - sub_bucket_bits)) &
+                           (sub_buckets - 1);
+        return (magnitude - sub_bucket_bits + 1) * sub_buckets + sub;
+    }
+
+    inline uint64_t bucket_lower_bound(size_t index)
+    {
+        if (index < sub_buckets) return index;
+        const unsigned magnitude = index / sub_buckets + sub_bucket_bits - 1;
+        return (sub_buckets + index % sub_buckets) <<
+               (magnitude - sub_bucket_bits);
+    }
+
+
+    // Counters of one method in one thread. Only the owning thread writes
+    // them (reset() aside), other threads read them for snapshots.
+    struct method_counters
+    {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> elements{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+        std::atomic<uint64_t> histogram[histogram_buckets] = {};
+
+        static void add(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value,
+                          std::memory_order_relaxed);
+        }
+
+        void record(uint64_t ns, uint64_t count)
+        {
+            add(calls, 1);
+            add(elements, count);
+            add(total_ns, ns);
+            add(histogram[bucket(ns)], 1);
+            if (ns > max_ns.load(std::memory_order_relaxed)) {
+                max_ns.store(ns, std::memory_order_relaxed); }
+        }
+    };
+
+
+    // Shared between extension modules: plain data and function pointers
+    // only, defined in _stats.cpp
+    struct registry
+    {
+        std::atomic<bool> enabled{false};
+        // id of a method name, the same name always gets the same id
+        size_t (*method_id)(const char* name);
+        // counters of the method in the calling thread
+        method_counters* (*counters)(size_t id);
+    };
+
+
+    // Registry of the pysdsl._stats module, attached once per extension
+    // module when its first method is instrumented
+    inline registry*& current()
+    {
+        static registry* instance = nullptr;
+        return instance;
+    }
+
+    inline size_t method_id(const std::string& name)
+    {
+        if (!current()) {
+            auto capsule = py::module::import("pysdsl._stats").attr(
+                "_registry");
+            current() = static_cast<registry*>(
+                py::reinterpret_borrow<py::capsule>(capsule)); }
+        return current()->method_id(name.c_str());
+    }
+
+    inline bool enabled()
+    {
+        return current()->enabled.load(std::memory_order_relaxed);
+    }
+
+
+    class scoped_timer
+    {
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        method_counters* m_counters;
+        uint64_t m_elements;
+        clock::time_point m_start;
+    public:
+        scoped_timer(size_t id, uint64_t elements):
+            m_counters(current()->counters(id)),
+            m_elements(elements),
+            m_start(clock::now())
+        {}
+        ~scoped_timer()
+        {
+            const auto ns = std::chrono::duration_cast<
+                std::chrono::nanoseconds>(clock::now() - m_start).count();
+            m_counters->record(ns, m_elements);
+        }
+    };
+
+
+    // Number of elements a call touches: one by default, the whole
+    // sequence for scans
+    struct one_element
+    {
+        template <class... Args>
+        uint64_t operator()(const Args&...) const { return 1; }
+    };
+
+    struct whole_sequence
+    {
+        template <class Sequence, class... Args>
+        uint64_t operator()(const Sequence& self, const Args&...) const
+        {
+            return self.size();
+        }
+    };
+
+
+    namespace detail
+    {
+        template <class F, class Elements, class R, class... Args>
+        auto timed(size_t id, F&& f, Elements elements, R (*)(Args...))
+        {
+            return [id, f, elements] (Args... args) -> R {
+                if (!enabled()) return f(std::forward<Args>(args)...);
+                scoped_timer timer(id, elements(args...));
+                return f(std::forward<Args>(args)...); };
+        }
+    }  // namespace detail
+
+
+    // Wraps the lambda `f` bound as `cls.<method>` so that its calls are
+    // counted when instrumentation is enabled
+    template <class F, class Elements = one_element>
+    auto timed(const py::handle& cls, const std::string& method, F&& f,
+               Elements elements = Elements())
+    {
+        const auto name = py::str(cls.attr("__name__")).cast<std::string>();
+        return detail::timed(method_id(name + "." + method),
+                             std::forward<F>(f), elements,
+                             static_cast<::detail::call_signature_t<F>*>(
+                                 nullptr));
+    }
+}  // namespace stats
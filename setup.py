@@ -52,7 +52,7 @@ class BuildExt(build_ext):
     """A custom build extension for adding compiler-specific options."""
     c_opts = {
         'msvc': ['/EHsc'],
-        'unix': ['-O3'],
+        'unix': ['-O3', '-pthread'],
     }
 
     if sys.platform == 'darwin':
@@ -78,6 +78,13 @@ class BuildExt(build_ext):
         build_ext.build_extensions(self)
 
 
+# Extension modules with bindings of one family of structures each, see
+# pysdsl/__init__.py for how they are loaded
+FAMILIES = ['_vectors', '_bitvectors', '_encoded', '_wavelet', '_csa',
+            '_trees']
+
+
+
 EXT_MODULES = [
     Extension(
         'pysdsl/bits',
@@ -85,18 +92,15 @@ EXT_MODULES = [
         include_dirs=[
             # Path to pybind11 headers
             get_pybind_include(),
-            get_pybind_include(user=True)
+            get_pybind_include(user=True),
+            "pysdsl/",
         ],
         language='c++',
         libraries=['sdsl'],
     ),
     Extension(
-        (
-            'pysdsl/pysdsl'
-            if sys.version_info.major == 2
-            else 'pysdsl/__init__'
-        ),
-        ['pysdsl/__init__.cpp'],
+        'pysdsl/_memory_monitor',
+        ['pysdsl/_memory_monitor.cpp'],
         include_dirs=[
             # Path to pybind11 headers
             get_pybind_include(),
@@ -104,19 +108,65 @@ EXT_MODULES = [
             "pysdsl/",
         ],
         language='c++',
-        libraries=['sdsl', 'divsufsort', 'divsufsort64'],
+        libraries=['sdsl'],
     ),
+    # counters of pysdsl.stats, shared by all family modules
     Extension(
-        'pysdsl/_memory_monitor',
-        ['pysdsl/_memory_monitor.cpp'],
+        'pysdsl/_stats',
+        ['pysdsl/_stats.cpp'],
+        include_dirs=[
+            # Path to pybind11 headers
+            get_pybind_include(),
+            get_pybind_include(user=True),
+            "pysdsl/",
+        ],
+        language='c++',
+        libraries=['sdsl'],
+    ),
+    # worker pool and completion queues of pysdsl.aio
+    Extension(
+        'pysdsl/_async',
+        ['pysdsl/_async.cpp'],
         include_dirs=[
             # Path to pybind11 headers
             get_pybind_include(),
-            get_pybind_include(user=True)
+            get_pybind_include(user=True),
+            "pysdsl/",
         ],
         language='c++',
         libraries=['sdsl'],
     ),
+] + [
+    Extension(
+        'pysdsl/' + name,
+        ['pysdsl/%s.cpp' % name],
+        include_dirs=[
+            # Path to pybind11 headers
+            get_pybind_include(),
+            get_pybind_include(user=True),
+            "pysdsl/",
+        ],
+        language='c++',
+        libraries=['sdsl', 'divsufsort', 'divsufsort64'],
+    )
+    # _bench holds native query loops for pysdsl.bench
+    for name in FAMILIES + ['_bench']
+] + [
+    # block compression of pysdsl.ArchivedIntVector, skipped without zstd
+    # and lz4
+    Extension(
+        'pysdsl/_archive',
+        ['pysdsl/_archive.cpp'],
+        include_dirs=[
+            # Path to pybind11 headers
+            get_pybind_include(),
+            get_pybind_include(user=True),
+            "pysdsl/",
+        ],
+        language='c++',
+        libraries=['sdsl', 'zstd', 'lz4'],
+        optional=True,
+    ),
 ]
 
 
@@ -128,8 +178,8 @@ setup(
     url='https://git.qrator.net/podshumok/pysdsl',
     description='Python bindings to Succinct Data Structure Library 2.0',
     ext_modules=EXT_MODULES,
-    packages=['pysdsl'],
-    install_requires=['pybind11>=2.2'],
+    packages=['pysdsl', 'pysdsl.bench'],
+    install_requires=['pybind11>=2.6', 'numpy'],
     cmdclass={'build_ext': BuildExt},
     zip_safe=False,
     classifiers=(
@@ -142,5 +192,6 @@ setup(
         "Operating System :: OS Independent",
         "Programming Language :: C++",
         "Programming Language :: Python",
+        "Programming Language :: Python :: Free Threading :: 2 - Beta",
     )
 )
@@ -0,0 +1,119 @@
+import asyncio
+
+import numpy as np
+import pysdsl
+import pysdsl.aio
+import pytest
+
+
+def run(coroutine):
+    return asyncio.run(coroutine)
+
+
+def test_build_and_query():
+    text = "abracadabra" * 100
+
+    async def main():
+        sa = await pysdsl.SuffixArrayWaveletTree.build_async(text)
+        return sa, await sa.locate_async("abra"), await sa.count_async("cad")
+
+    sa, positions, count = run(main())
+    assert len(sa) == len(text) + 1
+    assert sorted(positions) == sorted(sa.locate("abra"))
+    assert count == sa.count("cad") == 100
+
+
+def test_concurrent_builds():
+    texts = ["{}abracadabra{}".format(k, k * 7) * 20 for k in range(16)]
+
+    async def main():
+        return await asyncio.gather(
+            *(pysdsl.SuffixArrayBitcompressed.build_async(t) for t in texts))
+
+    for text, sa in zip(texts, run(main())):
+        assert len(sa) == len(text) + 1
+        assert sa.count(text[:6]) == text.count(text[:6])
+
+
+def test_rank_many():
+    values = pysdsl.IntVector([3, 1, 3, 2, 3, 1])
+    wt = pysdsl.WaveletTreeInt(values)
+    i = np.array([0, 1, 3, 6, 6], dtype=np.uint64)
+    c = np.array([3, 3, 3, 1, 3], dtype=np.uint64)
+    expected = [wt.rank(int(p), int(v)) for p, v in zip(i, c)]
+
+    async def main():
+        return await wt.rank_many_async(i, c)
+
+    assert list(wt.rank_many(i, c)) == expected
+    assert list(run(main())) == expected
+
+
+def test_errors_are_raised_on_await():
+    wt = pysdsl.WaveletTreeInt(pysdsl.IntVector([1, 2, 3]))
+
+    async def main():
+        await wt.rank_many_async([10], [1])
+
+    with pytest.raises(IndexError):
+        run(main())
+    with pytest.raises(ValueError):
+        wt.rank_many_async([1, 2], [1])
+    with pytest.raises(IndexError):
+        wt.rank_many([10], [1])
+    with pytest.raises(ValueError):
+        wt.rank_many([1, 2], [1])
+
+
+@pytest.mark.parametrize("Type", list(pysdsl.wavelet_tree_huffman.values()))
+def test_rank_many_checks_symbols(Type):
+    wt = Type(pysdsl.BitVector([1, 0, 1, 1]))
+    with pytest.raises(ValueError):
+        wt.rank_many([1], [256])
+    with pytest.raises(ValueError):
+        wt.rank_many_async([1], [256])
+    assert list(wt.rank_many([4, 4], [1, 255])) == [3, 0]
+
+
+def test_many_concurrent_calls():
+    sa = pysdsl.SuffixArrayBitcompressed("mississippi" * 50)
+    patterns = ["ss", "i", "ppi", "miss", "x"] * 100
+
+    async def main():
+        return await asyncio.gather(*(sa.count_async(p) for p in patterns))
+
+    assert run(main()) == [sa.count(p) for p in patterns]
+
+
+def test_pending_calls_are_bounded():
+    sa = pysdsl.SuffixArrayBitcompressed("mississippi" * 50)
+    limit = pysdsl.aio.PENDING_PER_WORKER * pysdsl.aio.workers()
+
+    async def main():
+        calls = [sa.count_async("ss") for _ in range(3 * limit)]
+        # let the calls take their slots
+        await asyncio.sleep(0)
+        queue = pysdsl.aio._queue(asyncio.get_running_loop())
+        assert queue.slots.locked()
+        calls[-1].cancel()
+        return await asyncio.gather(*calls[:-1])
+
+    assert run(main()) == [sa.count("ss")] * (3 * limit - 1)
+
+
+def test_cancelled_calls_are_dropped():
+    sa = pysdsl.SuffixArrayBitcompressed("banana" * 1000)
+
+    async def main():
+        cancelled = sa.locate_async("ana")
+        cancelled.cancel()
+        return await sa.count_async("nan")
+
+    assert run(main()) == sa.count("nan")
+
+
+def test_needs_running_loop():
+    sa = pysdsl.SuffixArrayBitcompressed("banana")
+    with pytest.raises(RuntimeError):
+        sa.count_async("an")
+    assert pysdsl.aio.workers() >= 1
@@ -0,0 +1,76 @@
+import random
+
+import numpy as np
+import pysdsl
+import pytest
+
+
+def filled(values, tail_capacity=64):
+    wm = pysdsl.AppendableWaveletMatrixInt(tail_capacity)
+    for v in values:
+        wm.append(v)
+    return wm
+
+
+def test_append_and_query():
+    rng = random.Random(1)
+    values = [rng.randrange(20) for _ in range(5000)]
+    wm = filled(values)
+
+    assert len(wm) == len(values)
+    assert wm.tail_size == len(values) % 64
+    assert sum(wm.segments) + wm.tail_size == len(values)
+    # log-structured: every segment at least twice the size of the next
+    assert all(a >= 2 * b for a, b in zip(wm.segments, wm.segments[1:]))
+
+    for _ in range(300):
+        i = rng.randrange(len(values) + 1)
+        c = rng.randrange(21)
+        assert wm.rank(i, c) == values[:i].count(c)
+        if i < len(values):
+            assert wm[i] == values[i]
+    positions = [i for i, v in enumerate(values) if v == 7]
+    for k in (1, len(positions) // 2, len(positions)):
+        assert wm.select(k, 7) == positions[k - 1]
+    with pytest.raises(ValueError):
+        wm.select(len(positions) + 1, 7)
+    assert wm[-1] == values[-1]
+
+
+def test_range_search_2d():
+    rng = random.Random(2)
+    values = [rng.randrange(1000) for _ in range(3000)]
+    wm = filled(values, 100)
+
+    lb, rb, vlb, vrb = 150, 2950, 100, 400
+    expected = sorted((i, v) for i, v in enumerate(values)
+                      if lb <= i <= rb and vlb <= v <= vrb)
+    count, indices, found = wm.range_search_2d(lb, rb, vlb, vrb)
+    assert count == len(expected) == wm.range_count_2d(lb, rb, vlb, vrb)
+    assert sorted(zip(indices.tolist(), found.tolist())) == expected
+
+    count, indices, _ = wm.range_search_2d(lb, rb, vlb, vrb, limit=10)
+    assert count == len(expected) and len(indices) == 10
+
+
+def test_extend_compact_and_convert():
+    values = np.arange(10000, dtype=np.uint64) % 37
+    wm = pysdsl.AppendableWaveletMatrixInt(1000)
+    wm.extend(values[:500])
+    assert wm.tail_size == 500
+    wm.extend(values[500:])
+    assert wm.tail_size == 0
+    wm.append(3)
+
+    static = wm.to_wavelet_matrix()
+    assert isinstance(static, pysdsl.WaveletMatrixInt)
+    assert list(static) == values.tolist() + [3]
+
+    wm.compact()
+    assert wm.segments == [10001]
+    assert wm.rank(10001, 3) == static.rank(10001, 3)
+
+    grown = pysdsl.AppendableWaveletMatrixInt(static)
+    grown.append(36)
+    assert len(grown) == 10002
+    assert grown.select(static.rank(10001, 36) + 1, 36) == 10001
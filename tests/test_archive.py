@@ -0,0 +1,93 @@
+import struct
+
+import numpy as np
+import pysdsl
+import pytest
+
+pytest.importorskip("pysdsl._archive")
+
+
+@pytest.mark.parametrize("codec", ["zstd", "lz4"])
+@pytest.mark.parametrize("width", [1, 7, 13, 64])
+def test_archive_roundtrip(tmp_path, codec, width):
+    rng = np.random.default_rng(width)
+    values = rng.integers(0, 1 << min(width, 63), size=5000, dtype=np.uint64)
+    v = pysdsl.IntVector(0, 0, width)
+    v.extend(values)
+    file_name = str(tmp_path / "v.archive")
+    v.store_to_archive(file_name, codec=codec, block_bytes=256, threads=2)
+
+    a = pysdsl.ArchivedIntVector(file_name, cache_blocks=4)
+    assert len(a) == len(v)
+    assert a.width == width
+    assert a.codec == codec
+    assert a.blocks == (v.bit_size + 2047) // 2048
+    for i in (0, 1, 63, 64, 1000, 4999, -1):
+        assert a[i] == v[i]
+    assert list(a.extract(10, 300)) == list(v)[10:300]
+    assert list(a.extract(7, 7)) == []
+    assert list(a.to_int_vector()) == list(v)
+    with pytest.raises(IndexError):
+        a[len(v)]
+    with pytest.raises(IndexError):
+        a.extract(0, len(v) + 1)
+
+
+def test_archive_cache(tmp_path):
+    v = pysdsl.Int64Vector(list(range(1024)))
+    file_name = str(tmp_path / "v.archive")
+    v.store_to_archive(file_name, block_bytes=1024)
+    a = pysdsl.ArchivedIntVector(file_name, cache_blocks=2)
+    assert a.compressed_bytes < 8 * 1024
+    a[0], a[1], a[200], a[0]
+    assert a.cache_stats == {"hits": 2, "misses": 2}
+    # block 0 was evicted by blocks 3 and 7
+    a[400], a[900], a[0]
+    assert a.cache_stats == {"hits": 2, "misses": 5}
+
+
+def test_not_an_archive(tmp_path):
+    file_name = str(tmp_path / "v.sdsl")
+    pysdsl.IntVector([1, 2, 3]).store_to_file(file_name)
+    with pytest.raises(ValueError):
+        pysdsl.ArchivedIntVector(file_name)
+    with pytest.raises(ValueError):
+        pysdsl.IntVector([1]).store_to_archive(file_name, codec="gzip")
+
+
+@pytest.mark.parametrize("offset, value", [(12, 0),    # width
+                                           (12, 65),
+                                           (24, 0),    # block_words
+                                           (40, 1 << 40),   # blocks
+                                           (48, 1),         # offsets[0]
+                                           (56, 1 << 62),   # offsets[1]
+                                           (112, 1 << 40)])  # offsets[8]
+def test_corrupted_header(tmp_path, offset, value):
+    file_name = str(tmp_path / "v.archive")
+    pysdsl.Int64Vector(list(range(1024))).store_to_archive(
+        file_name, block_bytes=1024)
+    with open(file_name, "r+b") as f:
+        f.seek(offset)
+        f.write(struct.pack("<I" if offset == 12 else "<Q", value))
+    with pytest.raises(ValueError):
+        pysdsl.ArchivedIntVector(file_name)
+
+
+@pytest.mark.parametrize("codec", ["zstd", "lz4"])
+def test_block_size_limit(tmp_path, codec):
+    file_name = str(tmp_path / "v.archive")
+    v = pysdsl.Int64Vector(list(range(100)))
+    if codec == "lz4":
+        with pytest.raises(ValueError):
+            v.store_to_archive(file_name, codec=codec, block_bytes=1 << 31)
+    # a single block either way, only the header says it is larger
+    v.store_to_archive(file_name, codec=codec, block_bytes=1024)
+    with open(file_name, "r+b") as f:
+        f.seek(24)
+        f.write(struct.pack("<Q", 1 << 28))
+    if codec == "lz4":
+        with pytest.raises(ValueError):
+            pysdsl.ArchivedIntVector(file_name)
+    else:
+        a = pysdsl.ArchivedIntVector(file_name)
+        assert list(a.to_int_vector()) == list(range(100))
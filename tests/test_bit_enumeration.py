@@ -0,0 +1,59 @@
+import numpy as np
+import pysdsl
+import pytest
+
+
+@pytest.fixture(scope="module")
+def bits():
+    rng = np.random.RandomState(7)
+    dense = rng.randint(0, 2, 3000)
+    sparse = (rng.randint(0, 100, 3000) == 0).astype(int)
+    return {"dense": dense.tolist(), "sparse": sparse.tolist()}
+
+
+def positions(chunks):
+    chunks = list(chunks)
+    for c in chunks:
+        assert c.dtype == np.uint64
+    return np.concatenate(chunks).tolist() if chunks else []
+
+
+@pytest.mark.parametrize("kind", ["dense", "sparse"])
+@pytest.mark.parametrize(
+    "Type", [pysdsl.BitVector] + pysdsl.all_immutable_bitvectors)
+def test_ones_zeros(Type, kind, bits):
+    values = bits[kind]
+    v = pysdsl.BitVector(values)
+    if Type is not pysdsl.BitVector:
+        v = Type(v)
+    ones = [i for i, b in enumerate(values) if b]
+    zeros = [i for i, b in enumerate(values) if not b]
+    assert positions(v.ones()) == ones
+    assert positions(v.zeros()) == zeros
+    assert positions(v.ones(start=70, stop=2901, chunk=64)) == [
+        i for i in ones if 70 <= i < 2901]
+    assert positions(v.zeros(start=3, stop=129)) == [
+        i for i in zeros if 3 <= i < 129]
+    assert positions(v.ones(stop=10 ** 9)) == ones
+    assert positions(v.ones(start=5, stop=5)) == []
+    for begin, end in ((0, 3000), (1, 64), (63, 65), (100, 1900), (7, 7)):
+        assert v.ones_count_in_range(begin, end) == sum(values[begin:end])
+
+
+def test_chunks():
+    v = pysdsl.BitVector(10000, True)
+    chunks = list(v.ones(chunk=1000))
+    assert [len(c) for c in chunks] == [960] * 10 + [400]
+    assert positions(chunks) == list(range(10000))
+
+
+def test_errors():
+    v = pysdsl.BitVector([1, 0, 1])
+    with pytest.raises(ValueError):
+        v.ones(chunk=10)
+    with pytest.raises(ValueError):
+        v.zeros(start=2, stop=1)
+    with pytest.raises(IndexError):
+        v.ones_count_in_range(0, 4)
+    with pytest.raises(ValueError):
+        v.ones_count_in_range(2, 1)
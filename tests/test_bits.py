@@ -0,0 +1,54 @@
+import numpy as np
+import pytest
+
+from pysdsl import bits
+
+
+@pytest.fixture
+def words():
+    rng = np.random.default_rng(44)
+    special = np.array([0, 1, 1 << 63, (1 << 64) - 1, 0x5555555555555555],
+                       dtype=np.uint64)
+    # lengths around the vector widths exercise the kernel tails
+    return np.concatenate([special, rng.integers(
+        0, (1 << 64) - 1, size=1000, dtype=np.uint64, endpoint=True)])
+
+
+@pytest.mark.parametrize("name", ["cnt", "hi", "lo", "rev"])
+@pytest.mark.parametrize("n", [0, 1, 3, 4, 7, 8, 9, 1005])
+def test_array_matches_scalar(words, name, n):
+    f = getattr(bits, name)
+    x = words[:n]
+    result = f(x)
+    assert result.dtype == np.uint64
+    assert result.tolist() == [f(int(w)) for w in x]
+
+
+def test_sel(words):
+    x = words[words != 0]
+    counts = bits.cnt(x)
+    i = (np.arange(len(x), dtype=np.uint64) % counts) + 1
+    assert bits.sel(x, i).tolist() == [
+        bits.sel(int(w), int(k)) for w, k in zip(x, i)]
+    with pytest.raises(IndexError):
+        bits.sel(x[:1], np.array([0], dtype=np.uint64))
+    with pytest.raises(ValueError):
+        bits.sel(x[:2], i[:1])
+
+
+def test_kernels():
+    kernels = bits.kernels()
+    assert set(kernels) == {"cnt", "hi", "lo", "rev", "sel",
+                            "popcount", "ones"}
+    assert bits.cnt([1, 3, 7]).tolist() == [1, 2, 3]
+
+
+def test_sel_reference(words):
+    for w in words[:200].tolist():
+        ones = [p for p in range(64) if w >> p & 1]
+        for k in (1, len(ones) // 2 + 1, len(ones)):
+            if 1 <= k <= len(ones):
+                assert bits.sel(w, k) == ones[k - 1]
+    assert bits.kernels()["sel"] in ("bmi2", "generic")
+    with pytest.raises(IndexError):
+        bits.sel(1, 0)
@@ -0,0 +1,76 @@
+import numpy as np
+import pysdsl
+import pytest
+
+
+def bit_vector(values):
+    v = pysdsl.BitVector()
+    v.extend(values.astype(np.uint64))
+    return v
+
+
+def as_array(v):
+    result = np.zeros(len(v), dtype=bool)
+    for chunk in v.ones():
+        result[chunk] = True
+    return result
+
+
+# the largest spans several threads
+@pytest.fixture(scope="module", params=[1, 64, 1000, 2 ** 23 + 5])
+def vectors(request):
+    rng = np.random.RandomState(request.param % 1000)
+    values = [rng.randint(0, 2, request.param).astype(bool)
+              for _ in range(4)]
+    return values, [bit_vector(v) for v in values]
+
+
+def test_operators(vectors):
+    (x, y, _, _), (a, b, _, _) = vectors
+    assert (as_array(a & b) == (x & y)).all()
+    assert (as_array(a | b) == (x | y)).all()
+    assert (as_array(a ^ b) == (x ^ y)).all()
+    assert (as_array(~a) == ~x).all()
+    assert (as_array(a.andnot(b)) == (x & ~y)).all()
+    assert (~a).cnt_one_bits() == len(x) - x.sum()
+    assert a.and_count(b) == (x & y).sum()
+    assert a.or_count(b) == (x | y).sum()
+
+
+def test_in_place(vectors):
+    (x, y, _, _), (_, b, _, _) = vectors
+    c = bit_vector(x)
+    d = c
+    c &= b
+    assert c is d
+    assert (as_array(c) == (x & y)).all()
+    c |= bit_vector(x)
+    assert (as_array(c) == x).all()
+    c ^= b
+    assert (as_array(c) == (x ^ y)).all()
+    assert c.andnot_update(c) is c
+    assert c.cnt_one_bits() == 0
+
+
+def test_reduce(vectors):
+    values, bit_vectors = vectors
+    assert (as_array(pysdsl.reduce_and(bit_vectors)) ==
+            np.logical_and.reduce(values)).all()
+    assert (as_array(pysdsl.reduce_or(bit_vectors)) ==
+            np.logical_or.reduce(values)).all()
+    assert (as_array(pysdsl.reduce_and(bit_vectors[:1])) == values[0]).all()
+
+
+def test_errors():
+    a = pysdsl.BitVector([1, 0, 1])
+    b = pysdsl.BitVector([1, 0])
+    with pytest.raises(ValueError):
+        a & b
+    with pytest.raises(ValueError):
+        a.and_count(b)
+    with pytest.raises(ValueError):
+        pysdsl.reduce_or([a, b])
+    with pytest.raises(ValueError):
+        pysdsl.reduce_and([])
+    with pytest.raises(TypeError):
+        a & 1
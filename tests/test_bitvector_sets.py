@@ -0,0 +1,90 @@
+import numpy as np
+import pysdsl
+import pytest
+
+
+def random_bits(seed, size, density):
+    rng = np.random.RandomState(seed)
+    return (rng.random_sample(size) < density).astype(int).tolist()
+
+
+def ones(bits):
+    return {i for i, b in enumerate(bits) if b}
+
+
+CLASSES = pysdsl.all_immutable_bitvectors
+
+
+@pytest.mark.parametrize("First", CLASSES)
+@pytest.mark.parametrize("Second", [pysdsl.SDVector,
+                                    pysdsl.RamanRamanRaoVector63,
+                                    pysdsl.HybVector8])
+def test_pairwise(First, Second):
+    x = random_bits(1, 5000, 0.3)
+    y = random_bits(2, 4000, 0.05)
+    a = First(pysdsl.BitVector(x))
+    b = Second(pysdsl.BitVector(y))
+
+    both = a.intersect(b, positions=True)
+    assert both.dtype == np.uint64
+    assert both.tolist() == sorted(ones(x) & ones(y))
+    assert a.union(b, positions=True).tolist() == sorted(ones(x) | ones(y))
+    assert a.difference(b, positions=True).tolist() == sorted(
+        ones(x) - ones(y))
+    assert b.difference(a, positions=True).tolist() == sorted(
+        ones(y) - ones(x))
+
+
+@pytest.mark.parametrize("Sparse", [pysdsl.RamanRamanRaoVector63,
+                                    pysdsl.HybVector8,
+                                    pysdsl.BitVectorInterLeaved64])
+def test_dense_minus_sparse(Sparse):
+    # every set bit of a is looked up in the long zero runs of b
+    n = 1 << 21
+    a = pysdsl.RamanRamanRaoVector63(pysdsl.BitVector(n, 1))
+    y = pysdsl.BitVector(n, 0)
+    for i in (3, n // 2, n - 1):
+        y[i] = 1
+    b = Sparse(y)
+
+    result = a.difference(b, positions=True)
+    assert len(result) == n - 3
+    assert result[:4].tolist() == [0, 1, 2, 4]
+    assert b.difference(a, positions=True).tolist() == []
+    assert len(a.intersect(b, positions=True)) == 3
+
+
+def test_sd_vector_result():
+    x = random_bits(3, 3000, 0.1)
+    y = random_bits(4, 2000, 0.2)
+    a = pysdsl.SDVector(pysdsl.BitVector(x))
+    b = pysdsl.RamanRamanRaoVector15(pysdsl.BitVector(y))
+    for result, expected, size in (
+            (a.intersect(b), ones(x) & ones(y), 3000),
+            (a.union(b), ones(x) | ones(y), 3000),
+            (b.difference(a), ones(y) - ones(x), 2000)):
+        assert isinstance(result, pysdsl.SDVector)
+        assert result.size == size
+        assert [i for i in range(size) if result[i]] == sorted(expected)
+
+
+def test_k_way():
+    bits = [random_bits(seed, 20000, 0.5) for seed in range(5)]
+    vectors = [pysdsl.SDVector(pysdsl.BitVector(bits[0])),
+               pysdsl.BitVectorInterLeaved64(pysdsl.BitVector(bits[1])),
+               pysdsl.SDVector(pysdsl.BitVector(bits[2])),
+               pysdsl.RamanRamanRaoVector63(pysdsl.BitVector(bits[3])),
+               pysdsl.HybVector16(pysdsl.BitVector(bits[4]))]
+    expected = set.intersection(*map(ones, bits))
+    result = vectors[0].intersect(vectors[1:], positions=True)
+    assert result.tolist() == sorted(expected)
+    assert vectors[2].intersect([], positions=True).tolist() == sorted(
+        ones(bits[2]))
+
+
+def test_errors():
+    a = pysdsl.SDVector(pysdsl.BitVector([1, 0, 1]))
+    with pytest.raises(TypeError):
+        a.intersect([1, 2])
+    with pytest.raises(TypeError):
+        a.union(pysdsl.BitVector([1]))
@@ -0,0 +1,85 @@
+import json
+import os
+
+import pysdsl
+import pytest
+
+
+@pytest.fixture
+def stored(tmp_path):
+    path = str(tmp_path / "index")
+    csa = pysdsl.SuffixArrayWaveletTree("abracadabra")
+    docs = pysdsl.BitVector([1, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0])
+    values = pysdsl.IntVector([5, 3, 8])
+    manifest = pysdsl.store_bundle(
+        path, {"csa": csa, "docs": docs, "values": values},
+        supports={"doc_rank": ("docs", "init_rank_1")})
+    return path, manifest
+
+
+def test_manifest(stored):
+    path, manifest = stored
+    with open(os.path.join(path, "manifest.json")) as f:
+        assert json.load(f) == manifest
+    assert manifest["format_version"] == pysdsl.bundle.FORMAT_VERSION
+    csa = manifest["components"]["csa"]
+    assert csa["class"] == "SuffixArrayWaveletTree"
+    assert csa["sdsl_type"] == pysdsl.SuffixArrayWaveletTree.sdsl_type
+    assert csa["bytes"] == os.path.getsize(os.path.join(path, csa["file"]))
+    assert manifest["components"]["doc_rank"] == {
+        "support": "init_rank_1", "of": "docs"}
+
+
+@pytest.mark.parametrize("mmap", [False, True, {"csa"}])
+def test_load(stored, mmap):
+    path, _ = stored
+    bundle = pysdsl.load_bundle(path, mmap=mmap, threads=2)
+    assert isinstance(bundle["csa"], pysdsl.SuffixArrayWaveletTree)
+    assert bundle["csa"].count("abra") == 2
+    assert list(bundle["values"]) == [5, 3, 8]
+    assert bundle["doc_rank"](8) == 3
+    assert bundle.manifest["components"]["values"]["size"] == 3
+
+
+def test_corruption(stored):
+    path, manifest = stored
+    file_name = os.path.join(path, manifest["components"]["values"]["file"])
+    with open(file_name, "r+b") as f:
+        f.seek(-1, os.SEEK_END)
+        last = f.read(1)
+        f.seek(-1, os.SEEK_END)
+        f.write(bytes([last[0] ^ 0xff]))
+    with pytest.raises(ValueError):
+        pysdsl.load_bundle(path)
+    assert pysdsl.load_bundle(path, verify=False)["csa"].count("a") == 5
+
+
+@pytest.mark.parametrize("name, file", [("values", "../values.sdsl"),
+                                        ("values", "/etc/passwd"),
+                                        ("values", "csa.sdsl"),
+                                        ("../values", "../values.sdsl")])
+def test_manifest_paths(stored, name, file):
+    path, manifest = stored
+    entry = manifest["components"].pop("values")
+    entry["file"] = file
+    manifest["components"][name] = entry
+    with open(os.path.join(path, "manifest.json"), "w") as f:
+        json.dump(manifest, f)
+    with pytest.raises(ValueError):
+        pysdsl.load_bundle(path)
+
+
+def test_load_from_buffer():
+    v = pysdsl.IntVector([1, 2, 3])
+    data = v.__getstate__()
+    assert list(pysdsl.IntVector.load_from_buffer(data)) == [1, 2, 3]
+    with pytest.raises(ValueError):
+        pysdsl.IntVector.load_from_buffer(data[:3])
+
+
+def test_unsupported(tmp_path):
+    with pytest.raises(ValueError):
+        pysdsl.store_bundle(str(tmp_path), {"a/b": pysdsl.IntVector(1)})
+    with pytest.raises(ValueError):
+        pysdsl.store_bundle(str(tmp_path), {"a": pysdsl.IntVector(1)},
+                            supports={"r": ("b", "init_rank_1")})
@@ -0,0 +1,100 @@
+import pickle
+import random
+
+import pysdsl
+import pytest
+
+
+def check(v, expected):
+    assert len(v) == len(expected)
+    assert v.ones == sum(expected)
+    assert list(v.to_bit_vector()) == expected
+
+
+def test_small():
+    v = pysdsl.DynamicBitVector([1, 0, 1])
+    v.insert(1, True)
+    assert v.erase(0)
+    v.append(1)
+    check(v, [1, 0, 1, 1])
+    assert v[-1] and not v[1]
+    assert v.rank(3) == 2
+    assert v.rank(3, False) == 1
+    assert v.select(2) == 2
+    assert v.select(1, False) == 1
+
+
+def test_errors():
+    v = pysdsl.DynamicBitVector(10)
+    with pytest.raises(IndexError):
+        v[10]
+    with pytest.raises(IndexError):
+        v.insert(11, True)
+    with pytest.raises(IndexError):
+        v.erase(10)
+    with pytest.raises(IndexError):
+        v.select(1)
+    with pytest.raises(IndexError):
+        v.rank(11)
+
+
+def test_random_updates_across_leaves():
+    rng = random.Random(7)
+    expected = [rng.random() < 0.3 for _ in range(200000)]
+    v = pysdsl.DynamicBitVector(expected)
+    expected = [int(b) for b in expected]
+
+    for _ in range(3000):
+        op = rng.random()
+        if op < 0.4:
+            i = rng.randrange(len(expected) + 1)
+            bit = rng.random() < 0.5
+            v.insert(i, bit)
+            expected.insert(i, int(bit))
+        elif op < 0.8:
+            i = rng.randrange(len(expected))
+            assert v.erase(i) == bool(expected.pop(i))
+        else:
+            i = rng.randrange(len(expected))
+            v[i] = not expected[i]
+            expected[i] = 1 - expected[i]
+    check(v, expected)
+
+    ones = [i for i, b in enumerate(expected) if b]
+    for _ in range(500):
+        i = rng.randrange(len(expected) + 1)
+        assert v.rank(i) == sum(expected[:i])
+        k = rng.randrange(len(ones))
+        assert v.select(k + 1) == ones[k]
+        assert v[i - 1] == bool(expected[i - 1])
+
+
+def test_shrink_and_grow():
+    v = pysdsl.DynamicBitVector(300000, True)
+    for _ in range(299990):
+        v.erase(len(v) // 2)
+    check(v, [1] * 10)
+    for i in range(100000):
+        v.append(i % 2)
+    assert len(v) == 100010
+    assert v.rank(len(v)) == 10 + 50000
+
+
+def test_insert_many():
+    v = pysdsl.DynamicBitVector([0] * 100)
+    v.insert_many(50, [1, 1, 1])
+    check(v, [0] * 50 + [1] * 3 + [0] * 50)
+    v.insert_many(0, pysdsl.BitVector(200000, 1))
+    assert len(v) == 200103
+    assert v.ones == 200003
+    assert v.select(200001) == 200050
+
+
+def test_conversions():
+    bits = pysdsl.BitVector([1, 0, 0, 1, 1, 0, 1])
+    v = pysdsl.DynamicBitVector(bits)
+    assert list(pysdsl.BitVector(v)) == list(bits)
+    sd = pysdsl.SDVector(v)
+    assert list(sd) == list(bits)
+    copy = pickle.loads(pickle.dumps(v))
+    assert list(copy.to_bit_vector()) == list(bits)
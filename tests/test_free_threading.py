@@ -0,0 +1,181 @@
+import os
+import sys
+import sysconfig
+import threading
+import time
+
+import pysdsl
+import pytest
+
+
+FREE_THREADED = bool(sysconfig.get_config_var("Py_GIL_DISABLED"))
+
+
+def gil_enabled():
+    return getattr(sys, "_is_gil_enabled", lambda: True)()
+
+
+def run_threads(count, target, *args):
+    barrier = threading.Barrier(count)
+
+    def worker(i):
+        barrier.wait()
+        target(i, *args)
+
+    threads = [threading.Thread(target=worker, args=(i,))
+               for i in range(count)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+
+@pytest.mark.skipif(not FREE_THREADED, reason="needs free-threaded Python")
+def test_modules_do_not_enable_gil():
+    pysdsl.load_all()
+    import pysdsl.bits  # noqa: F401
+    import pysdsl.memory_monitor  # noqa: F401
+    import pysdsl.stats  # noqa: F401
+    assert not gil_enabled()
+
+
+def test_readers_see_whole_writes():
+    n = 10000
+    v = pysdsl.IntVector(n, 0, 16)
+    errors = []
+
+    def work(i):
+        for k in range(200):
+            if i % 2:
+                v.set_to_value(i * 1000 + k)
+            else:
+                total = v.sum()
+                if total % n:
+                    errors.append(total)
+                v[k]
+
+    run_threads(8, work)
+    assert not errors
+
+
+def test_concurrent_resize_and_access():
+    v = pysdsl.IntVector(1000, 1, 8)
+
+    def work(i):
+        for k in range(500):
+            if i == 0:
+                v.resize(500 + k % 1000)
+            else:
+                try:
+                    v[len(v) - 1]
+                    v[-1]
+                    v[10:-10:3]
+                except IndexError:  # resized between len() and access
+                    pass
+
+    run_threads(4, work)
+    assert 500 <= len(v) < 1500
+
+
+def test_iterate_while_resizing():
+    v = pysdsl.IntVector(5000, 7, 8)
+    errors = []
+
+    def work(i):
+        for k in range(50):
+            if i == 0:
+                v.resize(1000 + (k * 997) % 9000)
+            else:
+                values = list(v)
+                if len(values) > 10000:
+                    errors.append(len(values))
+
+    run_threads(4, work)
+    assert not errors
+
+
+def test_rank_while_writing():
+    v = pysdsl.BitVector(1 << 16, 1)
+    rank = v.init_rank_1()
+    errors = []
+
+    def work(i):
+        for k in range(2000):
+            if i == 0:
+                v[(k * 7919) % len(v)] = k % 2
+            else:
+                p = (k * 104729) % len(v)
+                if rank(p) > p:
+                    errors.append(p)
+
+    run_threads(4, work)
+    assert not errors
+
+
+def test_sorted_int_stack_concurrent_push():
+    stack = pysdsl.SortedIntStack(10 ** 6)
+    pushed = []
+
+    def work(i):
+        for x in range(i, 10 ** 4, 4):
+            try:
+                stack.push(x)
+                pushed.append(x)
+            except ValueError:
+                pass
+
+    run_threads(4, work)
+    assert len(stack) == len(pushed)
+    assert stack.top() == max(pushed)
+
+
+def test_shared_range_search_2d_iterator():
+    data = [(i * 7919) % 1000 for i in range(20000)]
+    wm = pysdsl.WaveletMatrixInt(pysdsl.IntVector(data))
+    chunks = wm.range_search_2d_iter(0, len(data) - 1, 100, 599,
+                                     chunk_size=100)
+    found = [[] for _ in range(4)]
+
+    def work(i):
+        for indices, _ in chunks:
+            found[i].extend(indices.tolist())
+
+    run_threads(4, work)
+    expected = [i for i, x in enumerate(data) if 100 <= x <= 599]
+    assert sorted(sum(found, [])) == expected
+
+
+def throughput(wm, queries, threads, seconds=0.5):
+    counts = [0] * threads
+
+    def work(i):
+        rank = wm.rank
+        count = 0
+        deadline = time.perf_counter() + seconds
+        while time.perf_counter() < deadline:
+            for p, c in queries:
+                rank(p, c)
+            count += len(queries)
+        counts[i] = count
+
+    start = time.perf_counter()
+    run_threads(threads, work)
+    return sum(counts) / (time.perf_counter() - start)
+
+
+@pytest.mark.skipif(not FREE_THREADED or gil_enabled(),
+                    reason="needs free-threaded Python with the GIL off")
+@pytest.mark.skipif((os.cpu_count() or 1) < 4, reason="needs 4+ CPUs")
+def test_wavelet_matrix_query_scaling():
+    n = 1 << 16
+    values = pysdsl.IntVector(n, 0, 8)
+    values.set_random_bits(42)
+    wm = pysdsl.WaveletMatrixInt(values)
+    queries = [((i * 7919) % n, values[(i * 104729) % n])
+               for i in range(1000)]
+
+    threads = min(32, os.cpu_count())
+    single = throughput(wm, queries, 1)
+    parallel = throughput(wm, queries, threads)
+    # near-linear: at least 60% of perfect scaling
+    assert parallel >= 0.6 * threads * single
@@ -1,3 +1,4 @@
+import numpy as np
 import pysdsl
 import pytest
 
@@ -42,3 +43,46 @@ def test_immutable_bitvector(Type):
     assert v.get_int(0, v.size) == 682
     assert v.max() == 1
     assert v.min() == 0
+
+
+def test_append_and_extend():
+    v = pysdsl.IntVector(0, 0, 12)
+    v.append(5)
+    v.extend(np.arange(100, dtype=np.uint64))
+    v.extend([4095, 0, 7])
+    assert list(v) == [5] + list(range(100)) + [4095, 0, 7]
+    with pytest.raises(ValueError):
+        v.extend([4096])
+    with pytest.raises(ValueError):
+        v.append(1 << 12)
+    assert len(v) == 104
+
+    b = pysdsl.BitVector()
+    b.extend([1, 0, 1])
+    b.append(1)
+    assert list(b) == [1, 0, 1, 1]
+
+
+@pytest.mark.parametrize("width", [1, 7, 24, 64])
+def test_builder(width):
+    rng = np.random.default_rng(width)
+    chunks = [rng.integers(0, 1 << 10, size=n, dtype=np.uint64)
+              for n in (0, 1, 63, 64, 1000, 5)]
+    builder = pysdsl.IntVectorBuilder(width)
+    for chunk in chunks:
+        builder.extend(chunk)
+    builder.append(1 << 40)
+    expected = np.concatenate(chunks).tolist() + [1 << 40]
+    assert len(builder) == len(expected)
+    assert builder.capacity >= len(builder)
+    assert builder.width >= 41
+
+    v = builder.finish()
+    assert list(v) == expected
+    assert v.width == 41
+    assert len(builder) == 0
+
+    builder.extend([1, 0, 1])
+    v = builder.finish(bit_compress=False)
+    assert v.width == width
+    assert list(v) == [1, 0, 1]
@@ -0,0 +1,39 @@
+import pickle
+
+import numpy as np
+import pysdsl
+import pytest
+
+
+SRC = np.array([0, 0, 1, 3, 3, 5, 6, 6], dtype=np.uint64)
+DST = np.array([1, 2, 2, 0, 6, 4, 0, 7], dtype=np.uint64)
+
+
+@pytest.mark.parametrize("Type", list(pysdsl.k2_trees.values()))
+@pytest.mark.parametrize("threads", [1, 4])
+def test_k2tree(Type, threads):
+    t = Type(SRC, DST, threads=threads)
+    assert t.nodes == 8
+    assert t.edges == 8
+    assert t.adj(3, 6)
+    assert not t.adj(6, 3)
+    assert sorted(t.neighbors(0)) == [1, 2]
+    assert sorted(t.neighbors(6)) == [0, 7]
+    assert list(t.neighbors(2)) == []
+    assert sorted(t.reverse_neighbors(0)) == [3, 6]
+
+    offsets, targets = t.neighbors_many([0, 2, 3])
+    assert list(offsets) == [0, 2, 2, 4]
+    assert sorted(targets[2:4]) == [0, 6]
+
+    rows, cols = t.range(0, 3, 0, 2)
+    assert sorted(zip(rows, cols)) == [(0, 1), (0, 2), (1, 2), (3, 0)]
+
+    assert pickle.loads(pickle.dumps(t)).adj(5, 4)
+
+
+def test_k2tree_errors():
+    with pytest.raises(ValueError):
+        pysdsl.K2Tree(SRC, DST[:-1])
+    with pytest.raises(IndexError):
+        pysdsl.K2Tree(SRC, DST, nodes=4)
@@ -0,0 +1,87 @@
+import pickle
+
+import pysdsl
+import pytest
+
+
+TEXTS = ["abracadabra", "cadabra", "", "barbara"]
+
+
+@pytest.fixture
+def files(tmp_path):
+    return [str(tmp_path / "shard{}.sdsl".format(k))
+            for k in range(len(TEXTS))]
+
+
+@pytest.mark.parametrize("Type", [pysdsl.ShardedSuffixArrayWaveletTree,
+                                  pysdsl.ShardedSuffixArraySadakane,
+                                  pysdsl.ShardedSuffixArrayBitcompressed])
+def test_queries(Type, files):
+    sharded = Type.build(TEXTS, files, threads=2)
+    text = "".join(TEXTS)
+    assert sharded.shards == len(TEXTS)
+    assert sharded.lengths == [len(t) for t in TEXTS]
+    assert len(sharded) == len(text)
+
+    assert sharded.count("abra") == 3
+    assert sharded.count("bar") == 1
+    # within shards only
+    assert sharded.count("raba") == 0
+    assert list(sharded.locate("abra")) == [0, 7, 14]
+    assert list(sharded.locate("ra")) == [
+        i for i in range(len(text)) if text.startswith("ra", i)]
+
+    assert sharded.extract(3, 5) == text[3:6]
+    assert sharded.extract(8, 20) == text[8:21]
+    # single characters, across shard borders too
+    assert [sharded.extract(i, i) for i in range(len(text))] == list(text)
+    with pytest.raises(ValueError):
+        sharded.extract(5, 4)
+
+
+def test_lazy_loading(files):
+    Type = pysdsl.ShardedSuffixArrayWaveletTree
+    lengths = Type.build(TEXTS, files).lengths
+
+    sharded = Type(files, lengths)
+    assert not any(sharded.loaded(k) for k in range(sharded.shards))
+    assert len(sharded) == sum(lengths)
+    assert sharded.extract(0, 3) == "abra"
+    assert sharded.loaded(0)
+    assert not sharded.loaded(1)
+    assert sharded.shard(1).count("cad") == 1
+    assert sharded.loaded(1)
+
+    # without lengths every shard is loaded for global positions
+    unmeasured = Type(files)
+    assert unmeasured.count("a") == 11
+    assert list(unmeasured.locate("cad")) == [4, 11]
+    assert all(unmeasured.loaded(k) for k in range(unmeasured.shards))
+
+    copy = pickle.loads(pickle.dumps(sharded))
+    assert copy.files == files
+    assert copy.count("abra") == 3
+
+    with pytest.raises(ValueError):
+        Type(files, lengths[:-1])
+    with pytest.raises(IndexError):
+        sharded.shard(len(files))
+
+
+def test_wrong_lengths(files):
+    Type = pysdsl.ShardedSuffixArrayWaveletTree
+    lengths = Type.build(TEXTS, files).lengths
+    lengths[0] += 1
+
+    sharded = Type(files, lengths)
+    with pytest.raises(ValueError):
+        sharded.extract(0, 3)
+    assert not sharded.loaded(0)
+    with pytest.raises(ValueError):
+        sharded.locate("abra")
+    # the other shards are fine
+    assert sharded.shard(1).count("cad") == 1
+
+    copy = pickle.loads(pickle.dumps(sharded))
+    with pytest.raises(ValueError):
+        copy.count("abra")
@@ -1,4 +1,7 @@
 import random
+
+import numpy as np
+import pysdsl
 import pytest
 
 from pysdsl import SortedIntStack
@@ -64,3 +67,78 @@ def test_errors():
     with pytest.raises(ValueError, match="elements have to be pushed in strictly increasing order"):
         s.push(1)
         s.push(0)
+
+
+def test_bulk():
+    values = np.unique(np.random.RandomState(0).randint(0, 10 ** 6, 5000))
+    s = SortedIntStack(max_value=10 ** 6)
+    s.push_many(values[:1000])
+    s.push_many(values[1000:])
+    assert len(s) == len(values)
+    assert s.to_numpy().tolist() == values.tolist()
+    assert len(s) == len(values)
+
+    b = pysdsl.BitVector(s)
+    assert len(b) == values[-1] + 1
+    assert b.cnt_one_bits() == len(values)
+    assert all(b[int(x)] for x in values[:100])
+    sd = pysdsl.SDVector(s, size=10 ** 6 + 1)
+    assert sd.size == 10 ** 6 + 1
+    assert sd.intersect(sd, positions=True).tolist() == values.tolist()
+
+    top = s.pop_many(3)
+    assert top.tolist() == values[-3:][::-1].tolist()
+    assert s.top() == values[-4]
+    with pytest.raises(IndexError):
+        s.pop_many(len(values))
+    with pytest.raises(ValueError):
+        s.push_many([values[-4]])
+    with pytest.raises(ValueError):
+        s.push_many([10 ** 6 - 1, 10 ** 6 - 1])
+    with pytest.raises(ValueError):
+        s.push_many([10 ** 6 - 1, 10 ** 6, 10 ** 6 + 1])
+    assert s.top() == values[-4]
+    s.push_many([10 ** 6])
+    assert s.top() == 10 ** 6
+    with pytest.raises(ValueError):
+        pysdsl.SDVector(s, size=3)
+
+
+def test_conversion_after_pops():
+    # gaps of more than a block leave pointers between the elements
+    values = [0, 62, 63, 200, 1000, 1001, 5000, 5063]
+    s = SortedIntStack(max_value=10 ** 4)
+    s.push_many(values)
+    s.pop_many(2)
+    s.push_many([4000, 9999])
+    expected = values[:-2] + [4000, 9999]
+    assert s.to_numpy().tolist() == expected
+    b = pysdsl.BitVector(s)
+    assert [i for i in range(len(b)) if b[i]] == expected
+    sd = pysdsl.SDVector(s)
+    assert sd.intersect(sd, positions=True).tolist() == expected
+    assert SortedIntStack(max_value=10).to_numpy().tolist() == []
+
+
+def test_unexpected_layout():
+    s = SortedIntStack(max_value=1000)
+    s.push_many([3, 70, 500])
+    state = s.__getstate__()
+
+    def patched(word, value):
+        begin = 8 * word
+        return SortedIntStack.load_from_buffer(
+            state[:begin] + value.to_bytes(8, "little") + state[begin + 8:])
+
+    # max_value beyond the blocks stored
+    wrong_max = patched(0, 10 ** 6)
+    with pytest.raises(RuntimeError):
+        wrong_max.to_numpy()
+    with pytest.raises(RuntimeError):
+        wrong_max.push_many([2000])
+    # a size that is not the number of elements in the blocks
+    wrong_size = patched(2, 4)
+    with pytest.raises(RuntimeError):
+        wrong_size.to_numpy()
+    with pytest.raises(RuntimeError):
+        pysdsl.BitVector(wrong_size)
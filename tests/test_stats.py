@@ -0,0 +1,114 @@
+import threading
+
+import pysdsl
+import pysdsl.stats
+import pytest
+
+
+@pytest.fixture
+def stats():
+    pysdsl.stats.reset()
+    pysdsl.stats.enable()
+    yield pysdsl.stats
+    pysdsl.stats.disable()
+    pysdsl.stats.reset()
+
+
+def test_disabled_by_default():
+    assert not pysdsl.stats.is_enabled()
+    pysdsl.stats.reset()
+    v = pysdsl.IntVector([1, 2, 3])
+    v[0]
+    v.sum()
+    assert "IntVector.__getitem__" not in pysdsl.stats.snapshot()
+
+
+def test_calls_and_elements(stats):
+    v = pysdsl.IntVector([5, 1, 4, 2])
+    for i in range(len(v)):
+        v[i]
+    v[-1]
+    v[1:3]
+    v.sum()
+    v.max()
+
+    snapshot = stats.snapshot()
+    access = snapshot["IntVector.__getitem__"]
+    assert access["calls"] == 6
+    assert access["elements"] == 4 + 1 + 2
+    assert snapshot["IntVector.sum"]["calls"] == 1
+    assert snapshot["IntVector.sum"]["elements"] == 4
+    assert snapshot["IntVector.max"]["calls"] == 1
+
+
+def test_histogram(stats):
+    v = pysdsl.IntVector(range(100))
+    for i in range(100):
+        v[i]
+    access = stats.snapshot()["IntVector.__getitem__"]
+    assert sum(access["histogram"].values()) == 100
+    assert access["p50_ns"] <= access["p99_ns"] <= access["max_ns"]
+    assert access["mean_ns"] == access["total_ns"] / 100
+    assert min(access["histogram"]) <= access["p50_ns"]
+
+
+def test_failed_calls_are_counted(stats):
+    v = pysdsl.IntVector([1, 2, 3])
+    with pytest.raises(IndexError):
+        v[10]
+    assert stats.snapshot()["IntVector.__getitem__"]["calls"] >= 1
+
+
+def test_supports_wavelet_and_csa(stats):
+    bv = pysdsl.BitVector([1, 0, 1, 1, 0])
+    rank = bv.init_rank_1()
+    rank.rank(3)
+    rank(4)
+
+    wt = pysdsl.WaveletTreeInt(pysdsl.IntVector([3, 1, 3, 2]))
+    wt.rank(4, 3)
+    wt.select(1, 3)
+
+    sa = pysdsl.SuffixArrayBitcompressed("abracadabra")
+    sa.count("abra")
+    sa.locate("bra")
+
+    snapshot = stats.snapshot()
+    assert snapshot[type(rank).__name__ + ".rank"]["calls"] == 2
+    assert snapshot["WaveletTreeInt.rank"]["calls"] == 1
+    assert snapshot["WaveletTreeInt.select"]["calls"] == 1
+    assert snapshot["SuffixArrayBitcompressed.count"]["elements"] == 4
+    assert snapshot["SuffixArrayBitcompressed.locate"]["elements"] == 3
+
+
+def test_threads_are_summed(stats):
+    v = pysdsl.IntVector(range(1000))
+
+    def worker():
+        for i in range(1000):
+            v[i]
+
+    threads = [threading.Thread(target=worker) for _ in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert stats.snapshot()["IntVector.__getitem__"]["calls"] == 4000
+
+
+def test_reset_and_collecting():
+    v = pysdsl.IntVector([1, 2, 3])
+    with pysdsl.stats.collecting():
+        v.sum()
+    assert not pysdsl.stats.is_enabled()
+    assert pysdsl.stats.snapshot()["IntVector.sum"]["calls"] == 1
+    pysdsl.stats.reset()
+    assert "IntVector.sum" not in pysdsl.stats.snapshot()
+
+
+def test_percentile():
+    histogram = [(10, 50), (20, 49), (40, 1)]
+    assert pysdsl.stats.percentile(histogram, 50) == 10
+    assert pysdsl.stats.percentile(histogram, 99) == 20
+    assert pysdsl.stats.percentile(histogram, 99.9) == 40
+    assert pysdsl.stats.percentile([], 50) == 0
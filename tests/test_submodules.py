@@ -0,0 +1,82 @@
+import pickle
+import subprocess
+import sys
+
+import pysdsl
+import pytest
+
+
+def loaded_families(code):
+    """Families imported after running `code` in a fresh interpreter"""
+    script = (
+        "import sys, pysdsl\n" + code + "\n"
+        "print(' '.join(f for f in pysdsl.FAMILIES "
+        "if 'pysdsl.' + f in sys.modules))")
+    out = subprocess.check_output([sys.executable, "-c", script],
+                                  universal_newlines=True)
+    return set(out.split())
+
+
+def test_import_loads_nothing():
+    assert loaded_families("") == set()
+
+
+def test_lazy_loading():
+    assert loaded_families("pysdsl.IntVector") == {"_vectors"}
+    assert loaded_families("pysdsl.EncVectorEliasDelta") == {
+        "_vectors", "_encoded"}
+    assert loaded_families("pysdsl.WaveletTreeInt") == {
+        "_vectors", "_bitvectors", "_encoded", "_wavelet"}
+
+
+@pytest.mark.parametrize("name", ["IntVector", "BitVector", "SDVector",
+                                  "EncVectorEliasDelta", "WaveletMatrixInt",
+                                  "SuffixArrayBitcompressed",
+                                  "SuffixArrayWaveletTree", "BPTree",
+                                  "K2Tree", "all_wavelet_trees"])
+def test_family_of(name):
+    family = pysdsl.family_of(name)
+    assert family in pysdsl.FAMILIES
+    assert getattr(pysdsl.load(family), name) is getattr(pysdsl, name)
+
+
+def test_import_star():
+    required = set(pysdsl.FAMILIES) - set(pysdsl.OPTIONAL_FAMILIES)
+    assert loaded_families("from pysdsl import *") >= required
+    names = {}
+    exec("from pysdsl import *", names)
+    for name in ("IntVector", "SDVector", "WaveletTreeInt",
+                 "SuffixArrayWaveletTree", "BPTree", "load_bundle",
+                 "family_of"):
+        assert names[name] is getattr(pysdsl, name)
+    assert not any(name.startswith("_") for name in pysdsl.__all__)
+    assert "re" not in names and "importlib" not in names
+
+
+def test_missing_attribute():
+    with pytest.raises(AttributeError):
+        pysdsl.NoSuchVector
+
+
+def test_cross_family_constructors():
+    v = pysdsl.IntVector([3, 2, 1, 0, 2, 1, 3, 4])
+    enc = pysdsl.EncVectorEliasDelta(v)
+    assert list(pysdsl.IntVector(enc)) == list(v)
+    wt = pysdsl.WaveletTreeInt(v)
+    assert list(pysdsl.IntVector(wt)) == list(v)
+    bv = pysdsl.BitVector([1, 0, 1, 1])
+    assert list(pysdsl.BitVector(pysdsl.SDVector(bv))) == list(bv)
+
+
+def test_pickle_by_submodule():
+    v = pysdsl.IntVector([3, 2, 1])
+    assert type(v).__module__ == "pysdsl._vectors"
+    assert list(pickle.loads(pickle.dumps(v))) == [3, 2, 1]
+
+
+def test_import_of_submodule_loads_no_family():
+    assert loaded_families("from pysdsl import bits") == set()
+
+
+def test_submodule_attribute_loads_no_family():
+    assert loaded_families("pysdsl.stats.is_enabled()") == set()
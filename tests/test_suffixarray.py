@@ -30,3 +30,64 @@ def test_char_suffixarray(Type):
     assert a.count("aba") == 0
     assert chr(a.text[5]) == "a"
     assert a.sigma == 6
+
+
+@pytest.mark.parametrize("Type", [pysdsl.SuffixArrayWaveletTree,
+                                  pysdsl.SuffixArraySadakane,
+                                  pysdsl.SuffixArrayBitcompressed])
+def test_char_suffixarray_from_int_vector(Type):
+    codes = [ord(c) for c in "abracadabra"]
+    expected = Type.construct_im("abracadabra")
+    for a in (Type("abracadabra"), Type(pysdsl.IntVector(codes)),
+              Type(pysdsl.Int8Vector(codes))):
+        assert list(a) == list(expected)
+        assert list(a.bwt) == list(expected.bwt)
+    with pytest.raises(ValueError):
+        Type(pysdsl.IntVector([97, 256]))
+
+
+@pytest.mark.parametrize("Type", [pysdsl.SuffixArraySadakaneInt,
+                                  pysdsl.SuffixArrayWaveletTreeInt])
+def test_int_suffixarray_from_int_vector(Type):
+    data = [3, 2, 1, 5, 2, 1, 3, 4, 1, 1, 1, 3, 2, 1]
+    a = Type(pysdsl.IntVector(data))
+    assert list(a) == list(Type(data))
+    assert list(Type(pysdsl.Int8Vector(data))) == list(a)
+    assert a.count([3, 2, 1]) == 2
+    assert a.count([1, 1]) == 2
+    with pytest.raises(ValueError):
+        Type(pysdsl.IntVector([1, 0, 2]))
+
+
+@pytest.mark.parametrize("Type", [pysdsl.SuffixArrayWaveletTree,
+                                  pysdsl.SuffixArraySadakane,
+                                  pysdsl.SuffixArrayBitcompressed])
+@pytest.mark.parametrize("left,right", [("abracadabra", "cadabra"),
+                                        ("mississippi", "ssi"),
+                                        ("", "banana"),
+                                        ("banana", "")])
+def test_merge(Type, left, right):
+    merged = Type.merge(Type(left), Type(right), threads=2)
+    direct = Type(left + "\x01" + right)
+    assert len(merged) == len(direct)
+    assert list(merged) == list(direct)
+    assert list(merged.bwt) == list(direct.bwt)
+    for pattern in ("a", "ab", "ss", "issi", "na"):
+        assert merged.count(pattern) == direct.count(pattern)
+
+
+def test_merge_tmp_dir(tmp_path):
+    a = pysdsl.SuffixArrayWaveletTree("abracadabra")
+    b = pysdsl.SuffixArrayWaveletTree("cadabra")
+    on_disk = pysdsl.SuffixArrayWaveletTree.merge(a, b,
+                                                  tmp_dir=str(tmp_path))
+    in_memory = pysdsl.SuffixArrayWaveletTree.merge(a, b, tmp_dir="@")
+    assert list(on_disk) == list(in_memory)
+    assert list(tmp_path.iterdir()) == []
+
+
+def test_merge_separator():
+    a = pysdsl.SuffixArrayWaveletTree("ab\x01c")
+    b = pysdsl.SuffixArrayWaveletTree("abc")
+    with pytest.raises(ValueError):
+        pysdsl.SuffixArrayWaveletTree.merge(a, b)
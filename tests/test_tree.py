@@ -0,0 +1,89 @@
+import numpy as np
+import pysdsl
+import pytest
+
+
+#          0 1 2 3 4 5 6 7 8 9
+#          ( ( ( ) ( ) ) ( ) )
+BP = [1, 1, 1, 0, 1, 0, 0, 1, 0, 0]
+
+
+@pytest.mark.parametrize("Type", [pysdsl.BPTreeSada,
+                                  pysdsl.BPTreeG,
+                                  pysdsl.BPTreeGG])
+def test_bp_tree(Type):
+    t = Type(pysdsl.BitVector(BP))
+    assert t.nodes == 5
+    assert t.find_close(1) == 6
+    assert t.find_open(6) == 1
+    assert t.enclose(2) == 1
+    assert t.parent(4) == 1
+    assert t.parent(0) == t.size
+    assert t.first_child(1) == 2
+    assert t.first_child(2) == t.size
+    assert t.next_sibling(1) == 7
+    assert t.next_sibling(7) == t.size
+    assert t.subtree_size(0) == 5
+    assert t.subtree_size(1) == 3
+    assert t.lca(2, 4) == 1
+    assert t.lca(4, 7) == 0
+    assert t.lca(1, 4) == 1
+    assert t.level_ancestor(4, 2) == 0
+    assert t.depth(4) == 2
+    assert list(t.subtree_size_many(np.array([0, 1, 7]))) == [5, 3, 1]
+    assert list(t.lca_many([2, 4], [4, 7])) == [1, 0]
+
+
+
+@pytest.mark.parametrize("Type", [pysdsl.BPTreeSada,
+                                  pysdsl.BPTreeG,
+                                  pysdsl.BPTreeGG])
+def test_level_ancestor(Type):
+    rng = np.random.RandomState(5)
+    bp, depth = [1], 1
+    for _ in range(3000):
+        if depth > 1 and rng.random_sample() < 0.45:
+            bp.append(0)
+            depth -= 1
+        else:
+            bp.append(1)
+            depth += 1
+    bp += [0] * depth
+    t = Type(pysdsl.BitVector(bp))
+
+    for v in [i for i, b in enumerate(bp) if b][::7]:
+        ancestor = v
+        for d in range(t.depth(v) + 1):
+            assert t.level_ancestor(v, d) == ancestor
+            ancestor = t.parent(ancestor)
+
+
+def test_bp_tree_unbalanced():
+    with pytest.raises(ValueError):
+        pysdsl.BPTree(pysdsl.BitVector([1, 0, 0, 1]))
+
+
+@pytest.mark.parametrize("Type", [pysdsl.BPTreeSada,
+                                  pysdsl.BPTreeG,
+                                  pysdsl.BPTreeGG])
+def test_bp_tree_forest(Type):
+    with pytest.raises(ValueError):
+        Type(pysdsl.BitVector([1, 0, 1, 0]))
+
+
+def test_louds_tree():
+    # root with children a, b; a has two children
+    t = pysdsl.LoudsTree(pysdsl.BitVector([1, 0, 1, 1, 0, 1, 1, 0, 0, 0, 0]))
+    assert t.nodes == 5
+    assert t.degree(0) == 2
+    assert t.first_child(0) == 2
+    assert t.next_sibling(2) == 3
+    assert t.next_sibling(3) == t.size
+    assert t.first_child(2) == 5
+    assert t.child(2, 2) == 6
+    assert t.is_leaf(3)
+    assert t.parent(6) == 2
+    assert t.parent(2) == 0
+    assert t.id(6) == 4
+    assert t.node(4) == 6
+    assert list(t.parent_many([2, 3, 5])) == [0, 0, 2]
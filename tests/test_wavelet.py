@@ -1,3 +1,6 @@
+import random
+
+import numpy as np
 import pysdsl
 import pytest
 
@@ -23,3 +26,92 @@ def test_wavelet(Type):
 def test_huffman_wavelet(Type):
     a = Type(pysdsl.BitVector([1, 0, 1, 0, 1, 0, 1, 0, 1, 0]))
     assert a.select(1, 0) == 2
+
+
+@pytest.mark.parametrize("Type", list(pysdsl.wavelet_tree_int.values())
+                         + list(pysdsl.wavelet_matrix_int.values()))
+def test_range_search_2d(Type):
+    a = Type([3, 2, 1, 0, 2, 1, 3, 4, 1, 1, 1, 3, 2, 3])
+    count, indices, values = a.range_search_2d(0, 6, 2, 3)
+    assert count == 4
+    assert sorted(zip(indices, values)) == [(0, 3), (1, 2), (4, 2), (6, 3)]
+
+    count, indices, values = a.range_search_2d(0, 6, 2, 3, limit=2)
+    assert count == 4
+    assert len(indices) == len(values) == 2
+
+    count, indices, _ = a.range_search_2d(0, 6, 2, 3, report=False)
+    assert count == 4 and len(indices) == 0
+
+    chunks = list(a.range_search_2d_iter(0, 13, 3, 4, chunk_size=4))
+    assert sorted(i for ind, _ in chunks for i in ind) == [0, 6, 7, 11, 13]
+
+    assert list(a.range_count_2d_many([[0, 6, 2, 3], [0, 13, 0, 0]])) == [4, 1]
+
+
+@pytest.mark.parametrize("Type", list(pysdsl.wavelet_tree_int.values())
+                         + list(pysdsl.wavelet_matrix_int.values()))
+@pytest.mark.parametrize("threads", [1, 3])
+def test_parallel_build(Type, threads):
+    random.seed(42)
+    data = [random.randrange(1000) for _ in range(5000)]
+    v = pysdsl.IntVector(data)
+    # built by sdsl itself, through its RAM file system
+    expected = Type.construct_im(v)
+    a = Type(v, threads=threads)
+    assert list(a) == data
+    assert a.sigma == expected.sigma
+    for c in (0, 17, 999):
+        assert a.rank(len(data), c) == expected.rank(len(data), c)
+    assert a.select(1, data[10]) == expected.select(1, data[10])
+    assert list(Type(np.array(data), threads=threads)) == data
+
+    state = expected.__getstate__()
+    assert a.__getstate__() == state
+    assert Type(np.array(data), threads=threads).__getstate__() == state
+    assert Type(v).__getstate__() == state
+    assert Type(data).__getstate__() == state
+
+
+@pytest.mark.parametrize("Type", list(pysdsl.wavelet_tree_int.values())
+                         + list(pysdsl.wavelet_tree_balanced_int.values())
+                         + list(pysdsl.wavelet_tree_hu_tucker_int.values()))
+@pytest.mark.parametrize("threads", [1, 3])
+def test_range_statistics_many(Type, threads):
+    random.seed(7)
+    data = [random.randrange(50) for _ in range(2000)]
+    a = Type(data)
+    lb = np.array([random.randrange(len(data)) for _ in range(300)])
+    rb = np.array([random.randrange(l, len(data)) for l in lb])
+    q = np.array([random.randrange(r - l + 1) for l, r in zip(lb, rb)])
+
+    values, freqs = a.quantile_many(lb, rb, q, threads=threads)
+    for l, r, k, v, f in zip(lb, rb, q, values, freqs):
+        window = sorted(data[l:r + 1])
+        assert v == window[k] and f == window.count(v)
+
+    medians = a.range_median_many(lb, rb, threads=threads)
+    for l, r, m in zip(lb, rb, medians):
+        assert m == sorted(data[l:r + 1])[(r - l) // 2]
+
+    c = np.array([random.randrange(50) for _ in lb])
+    ranks, smaller, greater = a.lex_count_many(lb, rb + 1, c,
+                                               threads=threads)
+    for l, r, x, rk, s, g in zip(lb, rb, c, ranks, smaller, greater):
+        window = data[l:r + 1]
+        assert rk == data[:l].count(x)
+        assert s == sum(y < x for y in window)
+        assert g == sum(y > x for y in window)
+
+    vlb = np.array([random.randrange(60) for _ in lb])
+    vrb = vlb + np.array([random.randrange(20) for _ in lb])
+    counts = a.range_count_many(lb, rb, vlb, vrb, threads=threads)
+    for l, r, vl, vr, n in zip(lb, rb, vlb, vrb, counts):
+        assert n == sum(vl <= y <= vr for y in data[l:r + 1])
+
+    with pytest.raises(IndexError):
+        a.quantile_many([0], [len(data)], [0])
+    with pytest.raises(ValueError):
+        a.range_median_many([5], [4])
+    with pytest.raises(ValueError):
+        a.range_count_many([0, 1], [3], [0], [1])